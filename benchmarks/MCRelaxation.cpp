@@ -0,0 +1,159 @@
+//===- MCRelaxation.cpp - Benchmark assembler relaxation ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Assembles a large synthetic x86-64 file in which many branches are just in
+// or out of range of their short forms, so that relaxing one branch pushes
+// others out of range in turn. Each benchmark is run with and without
+// -mc-incremental-relaxation, and fails if the two objects differ.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/MC/MCAsmBackend.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCCodeEmitter.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCObjectWriter.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetOptions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+static const char *const TripleName = "x86_64-unknown-linux-gnu";
+
+/// Generate blocks which each branch forward and backward over a few of their
+/// neighbours, with filler sized so that the short branches only just fit.
+static std::string generateAssembly(unsigned NumBlocks) {
+  std::string Asm;
+  raw_string_ostream OS(Asm);
+  OS << "\t.text\n";
+  for (unsigned I = 0; I != NumBlocks; ++I) {
+    if (I % 64 == 0)
+      OS << "\t.p2align 4\n";
+    OS << ".Lb" << I << ":\n";
+    if (I + 8 < NumBlocks)
+      OS << "\tjne .Lb" << I + 8 << "\n";
+    if (I >= 8)
+      OS << "\tjmp .Lb" << I - 8 << "\n";
+    OS << "\t.fill " << 11 + I % 3 << ", 1, 0x90\n";
+  }
+  OS << "\tretq\n";
+  return OS.str();
+}
+
+static bool assemble(const Target &TheTarget, const std::string &Source,
+                     SmallVectorImpl<char> &Object) {
+  SourceMgr SrcMgr;
+  SrcMgr.AddNewSourceBuffer(MemoryBuffer::getMemBuffer(Source), SMLoc());
+
+  Triple TheTriple(TripleName);
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget.createMCRegInfo(TripleName));
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget.createMCAsmInfo(*MRI, TripleName));
+  std::unique_ptr<MCInstrInfo> MCII(TheTarget.createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget.createMCSubtargetInfo(TripleName, "", ""));
+  MCTargetOptions MCOptions;
+
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+  MOFI.InitMCObjectFileInfo(TheTriple, /*PIC*/ false, Ctx);
+
+  raw_svector_ostream OS(Object);
+  MCCodeEmitter *CE = TheTarget.createMCCodeEmitter(*MCII, *MRI, Ctx);
+  MCAsmBackend *MAB = TheTarget.createMCAsmBackend(*STI, *MRI, MCOptions);
+  std::unique_ptr<MCStreamer> Str(TheTarget.createMCObjectStreamer(
+      TheTriple, Ctx, std::unique_ptr<MCAsmBackend>(MAB),
+      MAB->createObjectWriter(OS), std::unique_ptr<MCCodeEmitter>(CE), *STI,
+      /*RelaxAll*/ false, /*IncrementalLinkerCompatible*/ false,
+      /*DWARFMustBeAtTheEnd*/ false));
+
+  std::unique_ptr<MCAsmParser> Parser(
+      createMCAsmParser(SrcMgr, Ctx, *Str, *MAI));
+  std::unique_ptr<MCTargetAsmParser> TAP(
+      TheTarget.createMCAsmParser(*STI, *Parser, *MCII, MCOptions));
+  if (!TAP)
+    return false;
+  Parser->setTargetParser(*TAP);
+  return !Parser->Run(/*NoInitialTextSection*/ false);
+}
+
+static void setIncrementalRelaxation(bool Enable) {
+  auto &Options = cl::getRegisteredOptions();
+  auto *Opt = static_cast<cl::opt<bool> *>(
+      Options.lookup("mc-incremental-relaxation"));
+  if (Opt)
+    *Opt = Enable;
+}
+
+static void BM_MCRelaxation(benchmark::State &State) {
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget(TripleName, Error);
+  if (!TheTarget) {
+    State.SkipWithError("the X86 target is not built");
+    return;
+  }
+
+  std::string Source = generateAssembly(State.range(0));
+  bool Incremental = State.range(1);
+
+  // Check that both relaxation engines produce the same object.
+  SmallString<0> Expected, Actual;
+  setIncrementalRelaxation(!Incremental);
+  if (!assemble(*TheTarget, Source, Expected)) {
+    State.SkipWithError("failed to assemble the input");
+    return;
+  }
+  setIncrementalRelaxation(Incremental);
+  assemble(*TheTarget, Source, Actual);
+  if (Actual != Expected) {
+    State.SkipWithError("incremental relaxation changed the output");
+    return;
+  }
+
+  for (auto _ : State) {
+    Actual.clear();
+    assemble(*TheTarget, Source, Actual);
+    benchmark::DoNotOptimize(Actual.data());
+  }
+  State.SetBytesProcessed(State.iterations() * Source.size());
+}
+
+static void relaxationArgs(benchmark::internal::Benchmark *B) {
+  for (int Blocks : {1 << 10, 1 << 13, 1 << 16})
+    for (int Incremental : {0, 1})
+      B->Args({Blocks, Incremental});
+}
+BENCHMARK(BM_MCRelaxation)
+    ->ArgNames({"blocks", "incremental"})
+    ->Apply(relaxationArgs)
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv) {
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllAsmParsers();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,109 @@
+//===- StringTableBuilder.cpp - Benchmark string table building -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Builds string tables from a synthetic set of 5 million mangled-looking
+// names, many of which share suffixes, as found in the symbol tables of large
+// LTO objects.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/CachedHashString.h"
+#include "llvm/MC/StringTableBuilder.h"
+#include "llvm/Support/CommandLine.h"
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static const std::vector<std::string> &getStrings() {
+  static const std::vector<std::string> Strings = [] {
+    static const char *const Parts[] = {"llvm", "detail", "impl", "Builder",
+                                        "Table", "String", "Map",  "Vector",
+                                        "get",  "set",    "add",  "finalize"};
+    std::vector<std::string> Strings;
+    uint32_t Seed = 1;
+    for (unsigned I = 0; I != 5000000; ++I) {
+      std::string S = "_ZN";
+      for (unsigned N = 2 + I % 4; N; --N) {
+        Seed = Seed * 1103515245 + 12345;
+        const char *Part = Parts[(Seed >> 16) % 12];
+        S += std::to_string(strlen(Part) + 1) + Part + char('a' + I % 26);
+      }
+      S += "E" + std::to_string(I) + (I % 3 ? "Ev" : "Ei");
+      Strings.push_back(std::move(S));
+    }
+    return Strings;
+  }();
+  return Strings;
+}
+
+// Builds the table, sorting it either on one thread or in parallel. The sort
+// runs on worker threads, so only the wall time is meaningful.
+static void BM_StringTableFinalize(benchmark::State &State) {
+  const std::vector<std::string> &Strings = getStrings();
+  auto &Threshold = *static_cast<cl::opt<unsigned> *>(
+      cl::getRegisteredOptions()["string-table-parallel-sort-threshold"]);
+  unsigned SavedThreshold = Threshold;
+  if (!State.range(0))
+    Threshold = std::numeric_limits<unsigned>::max();
+
+  for (auto _ : State) {
+    StringTableBuilder B(StringTableBuilder::ELF);
+    for (const std::string &S : Strings)
+      B.add(S);
+    B.finalize();
+    benchmark::DoNotOptimize(B.getSize());
+  }
+  State.SetItemsProcessed(State.iterations() * Strings.size());
+  Threshold = SavedThreshold;
+}
+BENCHMARK(BM_StringTableFinalize)
+    ->ArgName("parallel")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Looks up the offset of every string, either hashing each string again or
+// reusing the hash computed when it was added.
+static void BM_StringTableLookup(benchmark::State &State) {
+  const std::vector<std::string> &Strings = getStrings();
+  bool Interned = State.range(0);
+
+  StringTableBuilder B(StringTableBuilder::ELF);
+  std::vector<CachedHashStringRef> Hashed;
+  Hashed.reserve(Strings.size());
+  for (const std::string &S : Strings) {
+    Hashed.emplace_back(S);
+    B.add(Hashed.back());
+  }
+  B.finalize();
+
+  for (auto _ : State) {
+    size_t Sum = 0;
+    if (Interned)
+      for (CachedHashStringRef S : Hashed)
+        Sum += B.getOffset(S);
+    else
+      for (const std::string &S : Strings)
+        Sum += B.getOffset(S);
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Strings.size());
+}
+BENCHMARK(BM_StringTableLookup)
+    ->ArgName("interned")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
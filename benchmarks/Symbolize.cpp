@@ -0,0 +1,142 @@
+//===- Symbolize.cpp - Benchmark batch symbolization ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Symbolizes a batch of code addresses spread over the text of a binary with
+// debug info and a build ID, as a fresh run of llvm-symbolizer would, both
+// from the debug info and from an index written by a previous run. The binary
+// is given with -binary, and defaults to this benchmark itself.
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/DebugInfo/Symbolize/Symbolize.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace symbolize;
+
+static cl::opt<std::string> BinaryPath("binary",
+                                       cl::desc("Binary to symbolize"));
+
+static std::vector<uint64_t> Addresses;
+static SmallString<128> IndexDirectory;
+
+/// Pick addresses uniformly from the text sections, with a fixed seed.
+static bool collectAddresses(unsigned NumAddresses) {
+  auto BinOrErr = object::ObjectFile::createObjectFile(BinaryPath);
+  if (!BinOrErr) {
+    consumeError(BinOrErr.takeError());
+    return false;
+  }
+  std::vector<std::pair<uint64_t, uint64_t>> Text;
+  uint64_t TextSize = 0;
+  for (const object::SectionRef &Section : BinOrErr->getBinary()->sections()) {
+    if (!Section.isText() || !Section.getSize())
+      continue;
+    Text.emplace_back(Section.getAddress(), Section.getSize());
+    TextSize += Section.getSize();
+  }
+  if (!TextSize)
+    return false;
+
+  uint64_t State = 0x9E3779B97F4A7C15ULL;
+  for (unsigned I = 0; I != NumAddresses; ++I) {
+    State = State * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t Offset = (State >> 16) % TextSize;
+    for (const auto &Section : Text) {
+      if (Offset < Section.second) {
+        Addresses.push_back(Section.first + Offset);
+        break;
+      }
+      Offset -= Section.second;
+    }
+  }
+  return true;
+}
+
+static LLVMSymbolizer::Options getOptions(bool Indexed) {
+  LLVMSymbolizer::Options Opts;
+  if (Indexed)
+    Opts.IndexDirectory = IndexDirectory.str();
+  return Opts;
+}
+
+static void symbolizeAll(bool Indexed, std::string *Output = nullptr) {
+  LLVMSymbolizer Symbolizer(getOptions(Indexed));
+  for (uint64_t Address : Addresses) {
+    auto ResOrErr = Symbolizer.symbolizeInlinedCode(BinaryPath, Address);
+    if (!ResOrErr) {
+      consumeError(ResOrErr.takeError());
+      continue;
+    }
+    if (!Output) {
+      benchmark::DoNotOptimize(ResOrErr->getNumberOfFrames());
+      continue;
+    }
+    raw_string_ostream OS(*Output);
+    for (uint32_t I = 0, E = ResOrErr->getNumberOfFrames(); I != E; ++I) {
+      const DILineInfo &Frame = ResOrErr->getFrame(I);
+      OS << Frame.FunctionName << ' ' << Frame.FileName << ':' << Frame.Line
+         << ':' << Frame.Column << '\n';
+    }
+  }
+}
+
+static void BM_Symbolize(benchmark::State &State) {
+  bool Indexed = State.range(0);
+  for (auto _ : State)
+    symbolizeAll(Indexed);
+  State.SetItemsProcessed(State.iterations() * Addresses.size());
+}
+BENCHMARK(BM_Symbolize)
+    ->ArgName("indexed")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char **argv) {
+  benchmark::Initialize(&argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "symbolizer benchmark\n");
+  if (BinaryPath.empty())
+    BinaryPath = argv[0];
+
+  if (!collectAddresses(100000)) {
+    errs() << "error: no text to symbolize in " << BinaryPath << "\n";
+    return 1;
+  }
+  if (std::error_code EC = sys::fs::createUniqueDirectory("symbolize-index",
+                                                          IndexDirectory)) {
+    errs() << "error: " << EC.message() << "\n";
+    return 1;
+  }
+
+  // Write the index, and check that it gives the same answers.
+  std::string Expected, Actual;
+  symbolizeAll(/*Indexed=*/false, &Expected);
+  symbolizeAll(/*Indexed=*/true);
+  std::error_code EC;
+  if (sys::fs::directory_iterator(IndexDirectory, EC) ==
+      sys::fs::directory_iterator()) {
+    errs() << "error: no index was written for " << BinaryPath
+           << ", which needs debug info and a build ID\n";
+    return 1;
+  }
+  symbolizeAll(/*Indexed=*/true, &Actual);
+  if (Actual != Expected) {
+    errs() << "error: the index changed the results\n";
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  sys::fs::remove_directories(IndexDirectory);
+}
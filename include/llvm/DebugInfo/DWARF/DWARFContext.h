@@ -11,6 +11,7 @@
 #define LLVM_DEBUGINFO_DWARF_DWARFCONTEXT_H
 
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
@@ -41,6 +42,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace llvm {
 
@@ -73,6 +75,10 @@ class DWARFContext : public DIContext {
   std::unique_ptr<AppleAcceleratorTable> AppleTypes;
   std::unique_ptr<AppleAcceleratorTable> AppleNamespaces;
   std::unique_ptr<AppleAcceleratorTable> AppleObjC;
+  /// Guard the location and line tables, which may be parsed while units are
+  /// walked or verified on several threads.
+  std::mutex LocMutex;
+  std::mutex LineMutex;
 
   DWARFUnitVector DWOUnits;
   std::unique_ptr<DWARFDebugAbbrev> AbbrevDWO;
@@ -88,6 +94,7 @@ class DWARFContext : public DIContext {
   StringMap<std::weak_ptr<DWOFile>> DWOFiles;
   std::weak_ptr<DWOFile> DWP;
   bool CheckedForDWP = false;
+  bool WalkingUnitsInParallel = false;
   std::string DWPName;
 
   std::unique_ptr<MCRegisterInfo> RegInfo;
@@ -132,6 +139,10 @@ public:
 
   bool verify(raw_ostream &OS, DIDumpOptions DumpOpts = {}) override;
 
+  /// Verify the debug info, checking the contents of the units on up to
+  /// \p Threads threads. The output does not depend on the number of threads.
+  bool verify(raw_ostream &OS, DIDumpOptions DumpOpts, unsigned Threads);
+
   using unit_iterator_range = DWARFUnitVector::iterator_range;
 
   /// Get units from .debug_info in this context.
@@ -223,6 +234,24 @@ public:
     return DWOUnits[index].get();
   }
 
+  /// Call \p Fn on every normal unit from at most \p Threads threads, using
+  /// llvm::parallel. The units are split into runs of consecutive units of
+  /// about the same size, each visited in order by one thread, and Fn is
+  /// passed the index of the run, below \p Threads, so it can keep state per
+  /// run without locking. DIEs are extracted on first use, a whole unit at a
+  /// time, so Fn may follow references into the units of other runs, but must
+  /// not otherwise touch state shared between units.
+  void forEachNormalUnitInParallel(
+      unsigned Threads, function_ref<void(unsigned Run, DWARFUnit &U)> Fn);
+
+  /// Extract the DIEs of every normal unit from at most \p Threads threads.
+  void extractNormalUnitDIEs(unsigned Threads);
+
+  /// Return true while forEachNormalUnitInParallel() is running. Units then
+  /// extract all of their DIEs whenever any are asked for, as DieArray must
+  /// not be reallocated under a DIE which another thread holds.
+  bool isWalkingUnitsInParallel() const { return WalkingUnitsInParallel; }
+
   DWARFCompileUnit *getDWOCompileUnitForHash(uint64_t Hash);
 
   /// Return the compile unit that includes an offset (relative to .debug_info).
@@ -25,12 +25,15 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
 #include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/RWMutex.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -106,11 +109,17 @@ const DWARFUnitIndex &getDWARFUnitIndex(DWARFContext &Context,
 
 /// Describe a collection of units. Intended to hold all units either from
 /// .debug_info and .debug_types, or from .debug_info.dwo and .debug_types.dwo.
+///
+/// Once the units are read, getUnitForOffset() and getUnitForIndexEntry() may
+/// be called from several threads at once, even though the latter may add a
+/// lazily parsed unit.
 class DWARFUnitVector final : public SmallVector<std::unique_ptr<DWARFUnit>, 1> {
   std::function<std::unique_ptr<DWARFUnit>(uint32_t, DWARFSectionKind,
                                            const DWARFSection *)>
       Parser;
   unsigned NumInfoUnits = 0;
+  /// Guards lookups against lazy insertion by getUnitForIndexEntry().
+  mutable sys::RWMutex Mutex;
 
 public:
   using UnitVector = SmallVectorImpl<std::unique_ptr<DWARFUnit>>;
@@ -212,6 +221,12 @@ class DWARFUnit {
   llvm::Optional<BaseAddress> BaseAddr;
   /// The compile unit debug information entry items.
   std::vector<DWARFDebugInfoEntry> DieArray;
+  /// Serializes extraction of DieArray. Once AllDIEsExtracted is set, the
+  /// array does not change until the DIEs are cleared, so readers need not
+  /// take the lock.
+  std::mutex ExtractMutex;
+  std::atomic<bool> UnitDIEExtracted{false};
+  std::atomic<bool> AllDIEsExtracted{false};
 
   /// Map from range's start address to end address and corresponding DIE.
   /// IntervalMap does not support range removal, as a result, we use the
@@ -483,6 +498,13 @@ private:
 
   /// extractDIEsIfNeeded - Parses a compile unit and indexes its DIEs if it
   /// hasn't already been done. Returns the number of DIEs parsed at this call.
+  ///
+  /// This may be called from several threads at once provided the
+  /// abbreviations of the unit have been read beforehand. Extracting the
+  /// remaining DIEs of a unit which only has its unit DIE reallocates
+  /// DieArray, invalidating any DWARFDie already returned, so while
+  /// DWARFContext::forEachNormalUnitInParallel() runs every DIE is extracted
+  /// at once.
   size_t extractDIEsIfNeeded(bool CUDieOnly);
 
   /// extractDIEsToVector - Appends all parsed DIEs to a vector.
@@ -160,10 +160,11 @@ private:
   ///
   /// \param S           The DWARF Section to verify.
   /// \param SectionKind The object-file section kind that S comes from.
+  /// \param Threads     The number of threads to verify unit contents on.
   ///
   /// \returns The number of errors that occurred during verification.
   unsigned verifyUnitSection(const DWARFSection &S,
-                             DWARFSectionKind SectionKind);
+                             DWARFSectionKind SectionKind, unsigned Threads);
 
   /// Verify that all Die ranges are valid.
   ///
@@ -294,10 +295,11 @@ public:
   /// Verify the information in the .debug_info and .debug_types sections.
   ///
   /// Any errors are reported to the stream that this object was
-  /// constructed with.
+  /// constructed with. The contents of the units are verified on up to
+  /// \p Threads threads, which does not change the output.
   ///
   /// \returns true if all sections verify successfully, false otherwise.
-  bool handleDebugInfo();
+  bool handleDebugInfo(unsigned Threads = 1);
 
   /// Verify the information in the .debug_line section.
   ///
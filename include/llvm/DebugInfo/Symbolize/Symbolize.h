@@ -42,6 +42,10 @@ public:
     bool RelativeAddresses : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    /// If not empty, the directory in which an index of the debug info of
+    /// each module with a build ID is kept, so that it need not be parsed
+    /// again on later runs.
+    std::string IndexDirectory;
 
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
@@ -83,6 +87,12 @@ private:
   Expected<SymbolizableModule *>
   getOrCreateModuleInfo(const std::string &ModuleName, StringRef DWPName = "");
 
+  /// Returns a module which symbolizes code from the index of the debug info
+  /// in Options::IndexDirectory, writing the index if it is missing or out of
+  /// date. Returns nullptr if no index can be used for the objects.
+  std::unique_ptr<SymbolizableModule>
+  createIndexedModuleInfo(const ObjectPair &Objects, StringRef DWPName);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
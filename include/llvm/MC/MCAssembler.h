@@ -188,6 +188,14 @@ private:
   /// if any offsets were adjusted.
   bool layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec);
 
+  /// Relax the fragments of the given section until none of them change,
+  /// only re-examining the fragments whose fixups depend on the size of a
+  /// fragment which changed. Return true if any offsets were adjusted.
+  bool relaxSectionIncrementally(MCAsmLayout &Layout, MCSection &Sec);
+
+  /// Relax the given fragment if needed and return true if it changed.
+  bool relaxFragment(MCAsmLayout &Layout, MCFragment &F);
+
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
   bool relaxPaddingFragment(MCAsmLayout &Layout, MCPaddingFragment &PF);
@@ -295,6 +295,8 @@ public:
     VK_AMDGPU_REL32_HI,      // symbol@rel32@hi
     VK_AMDGPU_REL64,         // symbol@rel64
 
+    VK_AAP_GPREL, // symbol@gprel (relative to the global pointer)
+
     VK_TPREL,
     VK_DTPREL
   };
@@ -33,6 +33,17 @@ bool isAvailable();
 Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                int Level = DefaultCompression);
 
+/// Compress \p InputBuffer into a single zlib stream, in which each chunk of
+/// \p ChunkSize bytes is compressed separately on one of up to \p Threads
+/// threads. Each chunk is primed with the end of the one before it, so the
+/// result is close in size to that of compress(). The result does not depend
+/// on the number of threads, and an input of at most one chunk is compressed
+/// exactly as by compress().
+Error compressParallel(StringRef InputBuffer,
+                       SmallVectorImpl<char> &CompressedBuffer,
+                       unsigned Threads, size_t ChunkSize = 256 * 1024,
+                       int Level = DefaultCompression);
+
 Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                  size_t &UncompressedSize);
 
@@ -43,6 +43,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/WithColor.h"
@@ -607,12 +608,17 @@ DWARFDie DWARFContext::getDIEForOffset(uint32_t Offset) {
 }
 
 bool DWARFContext::verify(raw_ostream &OS, DIDumpOptions DumpOpts) {
+  return verify(OS, DumpOpts, 1);
+}
+
+bool DWARFContext::verify(raw_ostream &OS, DIDumpOptions DumpOpts,
+                          unsigned Threads) {
   bool Success = true;
   DWARFVerifier verifier(OS, *this, DumpOpts);
 
   Success &= verifier.handleDebugAbbrev();
   if (DumpOpts.DumpType & DIDT_DebugInfo)
-    Success &= verifier.handleDebugInfo();
+    Success &= verifier.handleDebugInfo(Threads);
   if (DumpOpts.DumpType & DIDT_DebugLine)
     Success &= verifier.handleDebugLine();
   Success &= verifier.handleAccelTables();
@@ -673,6 +679,7 @@ const DWARFDebugAbbrev *DWARFContext::getDebugAbbrevDWO() {
 }
 
 const DWARFDebugLoc *DWARFContext::getDebugLoc() {
+  std::lock_guard<std::mutex> Lock(LocMutex);
   if (Loc)
     return Loc.get();
 
@@ -803,6 +810,7 @@ DWARFContext::getLineTableForUnit(DWARFUnit *U) {
 
 Expected<const DWARFDebugLine::LineTable *> DWARFContext::getLineTableForUnit(
     DWARFUnit *U, std::function<void(Error)> RecoverableErrorCallback) {
+  std::lock_guard<std::mutex> Lock(LineMutex);
   if (!Line)
     Line.reset(new DWARFDebugLine);
 
@@ -851,6 +859,58 @@ void DWARFContext::parseDWOUnits(bool Lazy) {
   });
 }
 
+// Split Units into at most Threads runs of consecutive units of about the same
+// number of bytes. RunBegin is set to the index of the first unit of each run,
+// followed by the number of units.
+static void splitUnitsIntoRuns(const DWARFUnitVector &Units, unsigned Threads,
+                               SmallVectorImpl<unsigned> &RunBegin) {
+  unsigned NumUnits = Units.size();
+  unsigned NumRuns = std::max(1u, std::min(Threads, NumUnits));
+  uint64_t TotalSize = 0;
+  for (const auto &U : Units)
+    TotalSize += U->getNextUnitOffset() - U->getOffset();
+
+  uint64_t Size = 0;
+  for (unsigned I = 0; I != NumUnits && RunBegin.size() != NumRuns; ++I) {
+    if (Size >= RunBegin.size() * TotalSize / NumRuns)
+      RunBegin.push_back(I);
+    Size += Units[I]->getNextUnitOffset() - Units[I]->getOffset();
+  }
+  RunBegin.push_back(NumUnits);
+}
+
+void DWARFContext::forEachNormalUnitInParallel(
+    unsigned Threads, function_ref<void(unsigned Run, DWARFUnit &U)> Fn) {
+  parseNormalUnits();
+  if (Threads <= 1 || NormalUnits.size() <= 1) {
+    for (const auto &U : NormalUnits)
+      Fn(0, *U);
+    return;
+  }
+
+  // Extraction of the DIEs reads the abbreviations of the unit, which are
+  // cached on first use by both the unit and the shared DWARFDebugAbbrev.
+  for (const auto &U : NormalUnits)
+    U->getAbbreviations();
+
+  // The DIEs of a unit are extracted when it is first used, by its own run or
+  // by one which follows a reference into it.
+  SmallVector<unsigned, 16> RunBegin;
+  splitUnitsIntoRuns(NormalUnits, Threads, RunBegin);
+  unsigned NumRuns = RunBegin.size() - 1;
+  WalkingUnitsInParallel = true;
+  parallel::for_each_n(parallel::par, 0u, NumRuns, [&](unsigned Run) {
+    for (unsigned I = RunBegin[Run], E = RunBegin[Run + 1]; I != E; ++I)
+      Fn(Run, *NormalUnits[I]);
+  });
+  WalkingUnitsInParallel = false;
+}
+
+void DWARFContext::extractNormalUnitDIEs(unsigned Threads) {
+  forEachNormalUnitInParallel(
+      Threads, [](unsigned, DWARFUnit &U) { U.getUnitDIE(false); });
+}
+
 DWARFCompileUnit *DWARFContext::getCompileUnitForOffset(uint32_t Offset) {
   parseNormalUnits();
   return dyn_cast_or_null<DWARFCompileUnit>(
@@ -113,6 +113,7 @@ void DWARFUnitVector::addUnitsImpl(
 }
 
 DWARFUnit *DWARFUnitVector::getUnitForOffset(uint32_t Offset) const {
+  sys::ScopedReader Lock(Mutex);
   auto *CU = std::upper_bound(
     this->begin(), this->end(), Offset,
     [](uint32_t LHS, const std::unique_ptr<DWARFUnit> &RHS) {
@@ -131,6 +132,14 @@ DWARFUnitVector::getUnitForIndexEntry(const DWARFUnitIndex::Entry &E) {
 
   auto Offset = CUOff->Offset;
 
+  if (DWARFUnit *U = getUnitForOffset(Offset))
+    return U;
+
+  if (!Parser)
+    return nullptr;
+
+  // Look again once no other thread can be adding the same unit.
+  sys::ScopedWriter Lock(Mutex);
   auto *CU = std::upper_bound(
     this->begin(), this->end(), CUOff->Offset,
     [](uint32_t LHS, const std::unique_ptr<DWARFUnit> &RHS) {
@@ -139,9 +148,6 @@ DWARFUnitVector::getUnitForIndexEntry(const DWARFUnitIndex::Entry &E) {
   if (CU != this->end() && (*CU)->getOffset() <= Offset)
     return CU->get();
 
-  if (!Parser)
-    return nullptr;
-
   auto U = Parser(Offset, DW_SECT_INFO, nullptr);
   if (!U)
     U = nullptr;
@@ -359,10 +365,16 @@ void DWARFUnit::extractDIEsToVector(
 }
 
 size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
-  if ((CUDieOnly && !DieArray.empty()) ||
-      DieArray.size() > 1)
+  if (Context.isWalkingUnitsInParallel())
+    CUDieOnly = false;
+  if (AllDIEsExtracted.load(std::memory_order_acquire) ||
+      (CUDieOnly && UnitDIEExtracted.load(std::memory_order_acquire)))
     return 0; // Already parsed.
 
+  std::lock_guard<std::mutex> Lock(ExtractMutex);
+  if (AllDIEsExtracted || (CUDieOnly && UnitDIEExtracted))
+    return 0; // Parsed by another thread.
+
   bool HasCUDie = !DieArray.empty();
   extractDIEsToVector(!HasCUDie, !CUDieOnly, DieArray);
 
@@ -371,7 +383,7 @@ size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
 
   // If CU DIE was just parsed, copy several attribute values from it.
   if (!HasCUDie) {
-    DWARFDie UnitDie = getUnitDIE();
+    DWARFDie UnitDie(this, &DieArray[0]);
     if (Optional<uint64_t> DWOId = toUnsigned(UnitDie.find(DW_AT_GNU_dwo_id)))
       Header.setDWOId(*DWOId);
     if (!isDWO) {
@@ -438,6 +450,12 @@ size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
     // skeleton CU DIE, so that DWARF users not aware of it are not broken.
   }
 
+  // Publish the DIEs only now that the unit attributes above are set, as
+  // later callers skip the lock. Marking units without children as fully
+  // extracted also stops them from being walked again on every call.
+  UnitDIEExtracted.store(true, std::memory_order_release);
+  if (!CUDieOnly)
+    AllDIEsExtracted.store(true, std::memory_order_release);
   return DieArray.size();
 }
 
@@ -493,6 +511,9 @@ bool DWARFUnit::parseDWO() {
 }
 
 void DWARFUnit::clearDIEs(bool KeepCUDie) {
+  std::lock_guard<std::mutex> Lock(ExtractMutex);
+  AllDIEsExtracted = false;
+  UnitDIEExtracted = KeepCUDie && !DieArray.empty();
   if (DieArray.size() > (unsigned)KeepCUDie) {
     DieArray.resize((unsigned)KeepCUDie);
     DieArray.shrink_to_fit();
@@ -555,7 +576,10 @@ void DWARFUnit::collectAddressRanges(DWARFAddressRangesVector &CURanges) {
   // all compile units to stay loaded when they weren't needed. So we can end
   // up parsing the DWARF and then throwing them all away to keep memory usage
   // down.
-  const bool ClearDIEs = extractDIEsIfNeeded(false) > 1;
+  // Other threads may hold DIEs of this unit while units are walked in
+  // parallel.
+  const bool ClearDIEs = extractDIEsIfNeeded(false) > 1 &&
+                         !Context.isWalkingUnitsInParallel();
   getUnitDIE().collectChildrenAddressRanges(CURanges);
 
   // Collect address ranges from DIEs in .dwo if necessary.
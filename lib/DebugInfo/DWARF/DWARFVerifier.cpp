@@ -18,6 +18,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -252,8 +253,40 @@ bool DWARFVerifier::handleDebugAbbrev() {
   return NumErrors == 0;
 }
 
+// Create the unit with the given header and type, which has been verified.
+static std::unique_ptr<DWARFUnit> createUnit(DWARFContext &DCtx,
+                                             const DWARFSection &S,
+                                             const DWARFUnitHeader &Header,
+                                             uint8_t UnitType,
+                                             DWARFUnitVector &UnitVector) {
+  const DWARFObject &DObj = DCtx.getDWARFObj();
+  switch (UnitType) {
+  case dwarf::DW_UT_type:
+  case dwarf::DW_UT_split_type:
+    return llvm::make_unique<DWARFTypeUnit>(
+        DCtx, S, Header, DCtx.getDebugAbbrev(), &DObj.getRangeSection(),
+        DObj.getStringSection(), DObj.getStringOffsetSection(),
+        &DObj.getAppleObjCSection(), DObj.getLineSection(),
+        DCtx.isLittleEndian(), false, UnitVector);
+  case dwarf::DW_UT_skeleton:
+  case dwarf::DW_UT_split_compile:
+  case dwarf::DW_UT_compile:
+  case dwarf::DW_UT_partial:
+  // UnitType = 0 means that we are
+  // verifying a compile unit in DWARF v4.
+  case 0:
+    return llvm::make_unique<DWARFCompileUnit>(
+        DCtx, S, Header, DCtx.getDebugAbbrev(), &DObj.getRangeSection(),
+        DObj.getStringSection(), DObj.getStringOffsetSection(),
+        &DObj.getAppleObjCSection(), DObj.getLineSection(),
+        DCtx.isLittleEndian(), false, UnitVector);
+  default: { llvm_unreachable("Invalid UnitType."); }
+  }
+}
+
 unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
-                                          DWARFSectionKind SectionKind) {
+                                          DWARFSectionKind SectionKind,
+                                          unsigned Threads) {
   const DWARFObject &DObj = DCtx.getDWARFObj();
   DWARFDataExtractor DebugInfoData(DObj, S, DCtx.isLittleEndian(), 0);
   unsigned NumDebugInfoErrors = 0;
@@ -263,48 +296,86 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool isHeaderChainValid = true;
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector UnitVector{};
+
+  // With several threads, the contents of the units are verified once the
+  // header chain has been walked. The messages about each unit are kept
+  // until then, and printed in order.
+  struct UnitReport {
+    std::string Output;
+    std::unique_ptr<DWARFUnit> Unit;
+    uint8_t UnitType = 0;
+    unsigned NumErrors = 0;
+    std::map<uint64_t, std::set<uint32_t>> References;
+  };
+  std::vector<UnitReport> Reports;
+
   while (hasDIE) {
     OffsetStart = Offset;
-    if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
-                          isUnitDWARF64)) {
+    UnitReport *Report = nullptr;
+    Optional<raw_string_ostream> ReportOS;
+    Optional<DWARFVerifier> ReportVerifier;
+    if (Threads > 1) {
+      Reports.emplace_back();
+      Report = &Reports.back();
+      ReportOS.emplace(Report->Output);
+      ReportVerifier.emplace(*ReportOS, DCtx, DumpOpts);
+    }
+    DWARFVerifier &HeaderVerifier = Report ? *ReportVerifier : *this;
+    if (!HeaderVerifier.verifyUnitHeader(DebugInfoData, &Offset, UnitIdx,
+                                         UnitType, isUnitDWARF64)) {
       isHeaderChainValid = false;
       if (isUnitDWARF64)
         break;
     } else {
       DWARFUnitHeader Header;
       Header.extract(DCtx, DebugInfoData, &OffsetStart, SectionKind);
-      std::unique_ptr<DWARFUnit> Unit;
-      switch (UnitType) {
-      case dwarf::DW_UT_type:
-      case dwarf::DW_UT_split_type: {
-        Unit.reset(new DWARFTypeUnit(
-            DCtx, S, Header, DCtx.getDebugAbbrev(), &DObj.getRangeSection(),
-            DObj.getStringSection(), DObj.getStringOffsetSection(),
-            &DObj.getAppleObjCSection(), DObj.getLineSection(),
-            DCtx.isLittleEndian(), false, UnitVector));
-        break;
-      }
-      case dwarf::DW_UT_skeleton:
-      case dwarf::DW_UT_split_compile:
-      case dwarf::DW_UT_compile:
-      case dwarf::DW_UT_partial:
-      // UnitType = 0 means that we are
-      // verifying a compile unit in DWARF v4.
-      case 0: {
-        Unit.reset(new DWARFCompileUnit(
-            DCtx, S, Header, DCtx.getDebugAbbrev(), &DObj.getRangeSection(),
-            DObj.getStringSection(), DObj.getStringOffsetSection(),
-            &DObj.getAppleObjCSection(), DObj.getLineSection(),
-            DCtx.isLittleEndian(), false, UnitVector));
-        break;
-      }
-      default: { llvm_unreachable("Invalid UnitType."); }
+      std::unique_ptr<DWARFUnit> Unit =
+          createUnit(DCtx, S, Header, UnitType, UnitVector);
+      if (Report) {
+        Report->Unit = std::move(Unit);
+        Report->UnitType = UnitType;
+      } else {
+        NumDebugInfoErrors += verifyUnitContents(*Unit, UnitType);
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit, UnitType);
     }
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
   }
+
+  if (!Reports.empty()) {
+    // Extraction of the DIEs reads the abbreviations of the unit, which are
+    // cached on first use by both the unit and the shared DWARFDebugAbbrev.
+    for (UnitReport &Report : Reports)
+      if (Report.Unit)
+        Report.Unit->getAbbreviations();
+
+    unsigned NumRuns = std::min<size_t>(Threads, Reports.size());
+    parallel::for_each_n(parallel::par, 0u, NumRuns, [&](unsigned Run) {
+      for (size_t I = Run * Reports.size() / NumRuns,
+                  E = (Run + 1) * Reports.size() / NumRuns;
+           I != E; ++I) {
+        UnitReport &Report = Reports[I];
+        if (!Report.Unit)
+          continue;
+        raw_string_ostream ReportOS(Report.Output);
+        DWARFVerifier ReportVerifier(ReportOS, DCtx, DumpOpts);
+        Report.NumErrors =
+            ReportVerifier.verifyUnitContents(*Report.Unit, Report.UnitType);
+        Report.References = std::move(ReportVerifier.ReferenceToDIEOffsets);
+        // Free the DIEs of the unit as the sequential walk does.
+        Report.Unit.reset();
+      }
+    });
+
+    for (UnitReport &Report : Reports) {
+      OS << Report.Output;
+      NumDebugInfoErrors += Report.NumErrors;
+      for (const auto &Ref : Report.References)
+        ReferenceToDIEOffsets[Ref.first].insert(Ref.second.begin(),
+                                                Ref.second.end());
+    }
+  }
+
   if (UnitIdx == 0 && !hasDIE) {
     warn() << "Section is empty.\n";
     isHeaderChainValid = true;
@@ -315,15 +386,16 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   return NumDebugInfoErrors;
 }
 
-bool DWARFVerifier::handleDebugInfo() {
+bool DWARFVerifier::handleDebugInfo(unsigned Threads) {
   const DWARFObject &DObj = DCtx.getDWARFObj();
 
   OS << "Verifying .debug_info Unit Header Chain...\n";
-  unsigned result = verifyUnitSection(DObj.getInfoSection(), DW_SECT_INFO);
+  unsigned result =
+      verifyUnitSection(DObj.getInfoSection(), DW_SECT_INFO, Threads);
 
   OS << "Verifying .debug_types Unit Header Chain...\n";
   DObj.forEachTypesSections([&](const DWARFSection &S) {
-    result += verifyUnitSection(S, DW_SECT_TYPES);
+    result += verifyUnitSection(S, DW_SECT_TYPES, Threads);
   });
   return result == 0;
 }
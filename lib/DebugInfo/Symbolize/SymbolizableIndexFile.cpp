@@ -0,0 +1,372 @@
+//===- SymbolizableIndexFile.cpp ------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of SymbolizableIndexFile class.
+//
+// An index file starts with a header and the build ID of the module, padded
+// to a multiple of eight bytes. The header holds a CRC of everything after
+// it. It is followed by:
+//
+//  * the ranges, sorted by start address, each with the frame returned by
+//    symbolizeCode and the list of frames returned by symbolizeInlinedCode
+//    for every address from its start up to the start of the next range;
+//  * the frames, each a line info with its strings as string table offsets;
+//  * the frame lists of the ranges, as frame indices;
+//  * the string table, of null terminated strings.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SymbolizableIndexFile.h"
+#include "SymbolizableObjectFile.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JamCRC.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Path.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace llvm;
+using namespace symbolize;
+
+static const char IndexMagic[8] = {'L', 'L', 'V', 'M', 'S', 'Y', 'M', 'X'};
+static const uint32_t IndexVersion = 2;
+
+struct SymbolizableIndexFile::Header {
+  char Magic[8];
+  support::ulittle32_t Version;
+  support::ulittle32_t FNKind;
+  support::ulittle32_t UseSymbolTable;
+  support::ulittle32_t BuildIDSize;
+  support::ulittle32_t NumRanges;
+  support::ulittle32_t NumFrames;
+  support::ulittle32_t NumFrameRefs;
+  support::ulittle32_t StringsSize;
+  support::ulittle32_t Checksum;
+  support::ulittle32_t Reserved;
+};
+
+struct SymbolizableIndexFile::Range {
+  support::ulittle64_t Start;
+  support::ulittle32_t CodeFrame;
+  support::ulittle32_t FirstFrameRef;
+  support::ulittle32_t NumFrameRefs;
+  support::ulittle32_t Reserved;
+};
+
+struct SymbolizableIndexFile::Frame {
+  support::ulittle32_t FileName;
+  support::ulittle32_t FunctionName;
+  support::ulittle32_t Line;
+  support::ulittle32_t Column;
+  support::ulittle32_t StartLine;
+  support::ulittle32_t Discriminator;
+};
+
+static uint64_t getBuildIDSize(uint64_t BuildIDSize) {
+  return alignTo(BuildIDSize, 8);
+}
+
+static uint32_t getChecksum(StringRef Data) {
+  JamCRC CRC;
+  CRC.update(makeArrayRef(Data.data(), Data.size()));
+  return CRC.getCRC();
+}
+
+Error SymbolizableIndexFile::write(StringRef Path,
+                                   const SymbolizableObjectFile &Module,
+                                   ArrayRef<uint8_t> BuildID,
+                                   FunctionNameKind FNKind,
+                                   bool UseSymbolTable) {
+  std::vector<uint64_t> Boundaries;
+  if (!Module.getAddressBoundaries(Boundaries))
+    return make_error<StringError>(
+        "the address ranges of the debug info are not known",
+        inconvertibleErrorCode());
+
+  std::string Strings;
+  StringMap<uint32_t> StringOffsets;
+  auto AddString = [&](StringRef S) {
+    auto Inserted = StringOffsets.insert({S, Strings.size()});
+    if (Inserted.second) {
+      Strings += S;
+      Strings += '\0';
+    }
+    return Inserted.first->second;
+  };
+
+  std::vector<Frame> Frames;
+  std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t,
+                      uint32_t>,
+           uint32_t>
+      FrameIndices;
+  auto AddFrame = [&](const DILineInfo &Info) {
+    auto Key = std::make_tuple(AddString(Info.FileName),
+                               AddString(Info.FunctionName), Info.Line,
+                               Info.Column, Info.StartLine, Info.Discriminator);
+    auto Inserted = FrameIndices.insert({Key, Frames.size()});
+    if (Inserted.second) {
+      Frame F;
+      F.FileName = std::get<0>(Key);
+      F.FunctionName = std::get<1>(Key);
+      F.Line = Info.Line;
+      F.Column = Info.Column;
+      F.StartLine = Info.StartLine;
+      F.Discriminator = Info.Discriminator;
+      Frames.push_back(F);
+    }
+    return Inserted.first->second;
+  };
+
+  // The answers are the same for every address from one boundary up to the
+  // next, so only the boundaries need to be symbolized. Ranges with the same
+  // answers as the one before are merged into it.
+  std::vector<Range> Ranges;
+  std::vector<support::ulittle32_t> FrameRefs;
+  SmallVector<uint32_t, 4> InlinedFrames;
+  for (uint64_t Address : Boundaries) {
+    uint32_t CodeFrame =
+        AddFrame(Module.symbolizeCode(Address, FNKind, UseSymbolTable));
+    DIInliningInfo Inlined =
+        Module.symbolizeInlinedCode(Address, FNKind, UseSymbolTable);
+    InlinedFrames.clear();
+    for (uint32_t I = 0, E = Inlined.getNumberOfFrames(); I != E; ++I)
+      InlinedFrames.push_back(AddFrame(Inlined.getFrame(I)));
+
+    if (!Ranges.empty() && Ranges.back().CodeFrame == CodeFrame &&
+        Ranges.back().NumFrameRefs == InlinedFrames.size() &&
+        std::equal(InlinedFrames.begin(), InlinedFrames.end(),
+                   FrameRefs.end() - InlinedFrames.size()))
+      continue;
+
+    Range R;
+    R.Start = Address;
+    R.CodeFrame = CodeFrame;
+    R.FirstFrameRef = FrameRefs.size();
+    R.NumFrameRefs = InlinedFrames.size();
+    R.Reserved = 0;
+    Ranges.push_back(R);
+    FrameRefs.insert(FrameRefs.end(), InlinedFrames.begin(),
+                     InlinedFrames.end());
+  }
+
+  Header H;
+  memcpy(H.Magic, IndexMagic, sizeof(IndexMagic));
+  H.Version = IndexVersion;
+  H.FNKind = static_cast<uint32_t>(FNKind);
+  H.UseSymbolTable = UseSymbolTable;
+  H.BuildIDSize = BuildID.size();
+  H.NumRanges = Ranges.size();
+  H.NumFrames = Frames.size();
+  H.NumFrameRefs = FrameRefs.size();
+  H.StringsSize = Strings.size();
+  H.Reserved = 0;
+
+  uint64_t Size = sizeof(Header) + getBuildIDSize(BuildID.size()) +
+                  Ranges.size() * sizeof(Range) +
+                  Frames.size() * sizeof(Frame) +
+                  FrameRefs.size() * sizeof(support::ulittle32_t) +
+                  Strings.size();
+
+  if (std::error_code EC =
+          sys::fs::create_directories(sys::path::parent_path(Path)))
+    return errorCodeToError(EC);
+
+  // The buffer is written to a temporary file which is renamed on commit, so
+  // that concurrent runs never see a partial index.
+  Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+      FileOutputBuffer::create(Path, Size);
+  if (!BufferOrErr)
+    return BufferOrErr.takeError();
+  std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+
+  uint8_t *Out = Buffer->getBufferStart();
+  auto Write = [&](const void *Data, size_t Size) {
+    if (Size)
+      memcpy(Out, Data, Size);
+    Out += Size;
+  };
+  Header *OutHeader = reinterpret_cast<Header *>(Out);
+  Write(&H, sizeof(Header));
+  Write(BuildID.data(), BuildID.size());
+  std::fill(Out, Out + getBuildIDSize(BuildID.size()) - BuildID.size(), 0);
+  Out += getBuildIDSize(BuildID.size()) - BuildID.size();
+  Write(Ranges.data(), Ranges.size() * sizeof(Range));
+  Write(Frames.data(), Frames.size() * sizeof(Frame));
+  Write(FrameRefs.data(), FrameRefs.size() * sizeof(support::ulittle32_t));
+  Write(Strings.data(), Strings.size());
+  assert(Out == Buffer->getBufferEnd() && "index size mismatch");
+  OutHeader->Checksum = getChecksum(
+      StringRef(reinterpret_cast<const char *>(OutHeader + 1),
+                Size - sizeof(Header)));
+  return Buffer->commit();
+}
+
+Expected<std::unique_ptr<SymbolizableIndexFile>>
+SymbolizableIndexFile::open(StringRef Path, ArrayRef<uint8_t> BuildID,
+                            FunctionNameKind FNKind, bool UseSymbolTable,
+                            ModuleFactory CreateModule) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr = MemoryBuffer::getFile(
+      Path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!BufferOrErr)
+    return errorCodeToError(BufferOrErr.getError());
+
+  auto Invalid = [&](const Twine &Reason) {
+    return make_error<StringError>(Path + ": " + Reason,
+                                   make_error_code(errc::invalid_argument));
+  };
+
+  StringRef Data = (*BufferOrErr)->getBuffer();
+  if (Data.size() < sizeof(Header))
+    return Invalid("truncated index");
+  const Header *H = reinterpret_cast<const Header *>(Data.data());
+  if (memcmp(H->Magic, IndexMagic, sizeof(IndexMagic)) ||
+      H->Version != IndexVersion)
+    return Invalid("not a symbolizer index");
+  if (H->FNKind != static_cast<uint32_t>(FNKind) ||
+      H->UseSymbolTable != UseSymbolTable)
+    return Invalid("index was written with different options");
+
+  uint64_t Offset = sizeof(Header);
+  uint64_t Size = Offset + getBuildIDSize(H->BuildIDSize) +
+                  uint64_t(H->NumRanges) * sizeof(Range) +
+                  uint64_t(H->NumFrames) * sizeof(Frame) +
+                  uint64_t(H->NumFrameRefs) * sizeof(support::ulittle32_t) +
+                  H->StringsSize;
+  if (Data.size() != Size)
+    return Invalid("truncated index");
+  if (getChecksum(Data.drop_front(Offset)) != H->Checksum)
+    return Invalid("index checksum mismatch");
+  if (Data.substr(Offset, H->BuildIDSize) !=
+      StringRef(reinterpret_cast<const char *>(BuildID.data()),
+                BuildID.size()))
+    return Invalid("index is for a different build ID");
+  Offset += getBuildIDSize(H->BuildIDSize);
+
+  std::unique_ptr<SymbolizableIndexFile> Index(new SymbolizableIndexFile(
+      std::move(*BufferOrErr), FNKind, UseSymbolTable, std::move(CreateModule)));
+  const char *Base = Data.data();
+  Index->Ranges = makeArrayRef(
+      reinterpret_cast<const Range *>(Base + Offset), H->NumRanges);
+  Offset += H->NumRanges * sizeof(Range);
+  Index->Frames = makeArrayRef(
+      reinterpret_cast<const Frame *>(Base + Offset), H->NumFrames);
+  Offset += H->NumFrames * sizeof(Frame);
+  Index->FrameRefs = makeArrayRef(
+      reinterpret_cast<const support::ulittle32_t *>(Base + Offset),
+      H->NumFrameRefs);
+  Offset += H->NumFrameRefs * sizeof(support::ulittle32_t);
+  Index->Strings = Data.substr(Offset);
+  if (!Index->isValid())
+    return Invalid("malformed index");
+  return std::move(Index);
+}
+
+// Checks that the ranges are sorted and that every frame, frame list and
+// string they refer to is in bounds.
+bool SymbolizableIndexFile::isValid() const {
+  for (size_t I = 1, E = Ranges.size(); I < E; ++I)
+    if (Ranges[I - 1].Start >= Ranges[I].Start)
+      return false;
+  for (const Range &R : Ranges)
+    if (R.CodeFrame >= Frames.size() ||
+        uint64_t(R.FirstFrameRef) + R.NumFrameRefs > FrameRefs.size())
+      return false;
+  for (uint32_t Ref : FrameRefs)
+    if (Ref >= Frames.size())
+      return false;
+  // The string table ends with a null, so every string in it does too.
+  if (!Strings.empty() && Strings.back() != '\0')
+    return false;
+  for (const Frame &F : Frames)
+    if (F.FileName >= Strings.size() || F.FunctionName >= Strings.size())
+      return false;
+  return true;
+}
+
+const SymbolizableModule *SymbolizableIndexFile::getModule() const {
+  if (!CreatedModule) {
+    Module = CreateModule();
+    CreatedModule = true;
+  }
+  return Module.get();
+}
+
+const SymbolizableIndexFile::Range *
+SymbolizableIndexFile::findRange(uint64_t ModuleOffset) const {
+  auto It = std::upper_bound(Ranges.begin(), Ranges.end(), ModuleOffset,
+                             [](uint64_t Address, const Range &R) {
+                               return Address < R.Start;
+                             });
+  if (It == Ranges.begin())
+    return nullptr;
+  return &*std::prev(It);
+}
+
+// The frame and its strings are in bounds, as checked by isValid.
+DILineInfo SymbolizableIndexFile::getFrame(uint32_t Index) const {
+  const Frame &F = Frames[Index];
+  auto GetString = [&](uint32_t Offset) {
+    return Strings.slice(Offset, Strings.find('\0', Offset)).str();
+  };
+  DILineInfo Info;
+  Info.FileName = GetString(F.FileName);
+  Info.FunctionName = GetString(F.FunctionName);
+  Info.Line = F.Line;
+  Info.Column = F.Column;
+  Info.StartLine = F.StartLine;
+  Info.Discriminator = F.Discriminator;
+  return Info;
+}
+
+DILineInfo SymbolizableIndexFile::symbolizeCode(uint64_t ModuleOffset,
+                                                FunctionNameKind FNKind,
+                                                bool UseSymbolTable) const {
+  if (FNKind != this->FNKind || UseSymbolTable != this->UseSymbolTable) {
+    if (const SymbolizableModule *M = getModule())
+      return M->symbolizeCode(ModuleOffset, FNKind, UseSymbolTable);
+    return DILineInfo();
+  }
+
+  if (const Range *R = findRange(ModuleOffset))
+    return getFrame(R->CodeFrame);
+  return DILineInfo();
+}
+
+DIInliningInfo SymbolizableIndexFile::symbolizeInlinedCode(
+    uint64_t ModuleOffset, FunctionNameKind FNKind, bool UseSymbolTable) const {
+  if (FNKind != this->FNKind || UseSymbolTable != this->UseSymbolTable) {
+    if (const SymbolizableModule *M = getModule())
+      return M->symbolizeInlinedCode(ModuleOffset, FNKind, UseSymbolTable);
+    return DIInliningInfo();
+  }
+
+  DIInliningInfo InlinedContext;
+  if (const Range *R = findRange(ModuleOffset))
+    for (uint32_t Ref : FrameRefs.slice(R->FirstFrameRef, R->NumFrameRefs))
+      InlinedContext.addFrame(getFrame(Ref));
+  // Make sure there is at least one frame in context.
+  if (InlinedContext.getNumberOfFrames() == 0)
+    InlinedContext.addFrame(DILineInfo());
+  return InlinedContext;
+}
+
+DIGlobal SymbolizableIndexFile::symbolizeData(uint64_t ModuleOffset) const {
+  if (const SymbolizableModule *M = getModule())
+    return M->symbolizeData(ModuleOffset);
+  return DIGlobal();
+}
@@ -0,0 +1,103 @@
+//===- SymbolizableIndexFile.h ----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the SymbolizableIndexFile class, which symbolizes code
+// addresses using a precomputed index of a module's debug info.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEINDEXFILE_H
+#define LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEINDEXFILE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace llvm {
+namespace symbolize {
+
+class SymbolizableObjectFile;
+
+/// A module whose code addresses are symbolized from an index file, which
+/// maps each range of addresses with the same answer to the frames that
+/// SymbolizableObjectFile would return for it. The file is mapped into
+/// memory and searched in place, so no debug info is parsed.
+///
+/// An index is only valid for the build ID of the module it was written for,
+/// and for the function name kind and symbol table use it was written with.
+/// Other queries, including all data queries, are answered by a module which
+/// is created on first use.
+class SymbolizableIndexFile : public SymbolizableModule {
+public:
+  using ModuleFactory = std::function<std::unique_ptr<SymbolizableModule>()>;
+
+  /// Writes an index of the code addresses of \p Module to \p Path. Fails if
+  /// the ranges over which the answers of the module are constant cannot be
+  /// determined.
+  static Error write(StringRef Path, const SymbolizableObjectFile &Module,
+                     ArrayRef<uint8_t> BuildID, FunctionNameKind FNKind,
+                     bool UseSymbolTable);
+
+  /// Opens the index at \p Path. Fails if there is no index, if it was
+  /// written for a different build ID or different options, or if its
+  /// checksum or structure is wrong.
+  static Expected<std::unique_ptr<SymbolizableIndexFile>>
+  open(StringRef Path, ArrayRef<uint8_t> BuildID, FunctionNameKind FNKind,
+       bool UseSymbolTable, ModuleFactory CreateModule);
+
+  DILineInfo symbolizeCode(uint64_t ModuleOffset, FunctionNameKind FNKind,
+                           bool UseSymbolTable) const override;
+  DIInliningInfo symbolizeInlinedCode(uint64_t ModuleOffset,
+                                      FunctionNameKind FNKind,
+                                      bool UseSymbolTable) const override;
+  DIGlobal symbolizeData(uint64_t ModuleOffset) const override;
+
+  // Indexes are not written for COFF modules.
+  bool isWin32Module() const override { return false; }
+  uint64_t getModulePreferredBase() const override { return 0; }
+
+private:
+  struct Header;
+  struct Range;
+  struct Frame;
+
+  std::unique_ptr<MemoryBuffer> Buffer;
+  FunctionNameKind FNKind;
+  bool UseSymbolTable;
+
+  ArrayRef<Range> Ranges;
+  ArrayRef<Frame> Frames;
+  ArrayRef<support::ulittle32_t> FrameRefs;
+  StringRef Strings;
+
+  ModuleFactory CreateModule;
+  mutable std::unique_ptr<SymbolizableModule> Module;
+  mutable bool CreatedModule = false;
+
+  SymbolizableIndexFile(std::unique_ptr<MemoryBuffer> Buffer,
+                        FunctionNameKind FNKind, bool UseSymbolTable,
+                        ModuleFactory CreateModule)
+      : Buffer(std::move(Buffer)), FNKind(FNKind),
+        UseSymbolTable(UseSymbolTable), CreateModule(std::move(CreateModule)) {}
+
+  bool isValid() const;
+  const SymbolizableModule *getModule() const;
+  const Range *findRange(uint64_t ModuleOffset) const;
+  DILineInfo getFrame(uint32_t Index) const;
+};
+
+} // end namespace symbolize
+} // end namespace llvm
+
+#endif // LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEINDEXFILE_H
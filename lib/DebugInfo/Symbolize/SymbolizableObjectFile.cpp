@@ -186,6 +186,68 @@ uint64_t SymbolizableObjectFile::getModulePreferredBase() const {
   return 0;
 }
 
+bool SymbolizableObjectFile::getAddressBoundaries(
+    std::vector<uint64_t> &Boundaries) const {
+  Boundaries.push_back(0);
+  for (const auto &Function : Functions) {
+    Boundaries.push_back(Function.first.Addr);
+    if (Function.first.Size)
+      Boundaries.push_back(Function.first.Addr + Function.first.Size);
+  }
+
+  if (DebugInfoContext) {
+    auto *DICtx = dyn_cast<DWARFContext>(DebugInfoContext.get());
+    if (!DICtx)
+      return false;
+    for (const auto &CU : DICtx->compile_units()) {
+      // The subprograms of a split unit are in its .dwo file.
+      if (CU->getUnitDIE().find({dwarf::DW_AT_dwo_name, dwarf::DW_AT_GNU_dwo_name}))
+        return false;
+
+      // Line table lookups change at each row and at the end of each
+      // sequence.
+      if (const DWARFDebugLine::LineTable *LineTable =
+              DICtx->getLineTableForUnit(CU.get())) {
+        for (const DWARFDebugLine::Row &Row : LineTable->Rows)
+          Boundaries.push_back(Row.Address);
+        for (const DWARFDebugLine::Sequence &Seq : LineTable->Sequences) {
+          Boundaries.push_back(Seq.LowPC);
+          Boundaries.push_back(Seq.HighPC);
+        }
+      }
+
+      // Units are found from their address ranges, and the inlining chain
+      // from those of the subroutines.
+      for (const DWARFDebugInfoEntry &Entry : CU->dies()) {
+        DWARFDie Die(CU.get(), &Entry);
+        if (Die.getTag() != dwarf::DW_TAG_compile_unit &&
+            !Die.isSubroutineDIE())
+          continue;
+        Expected<DWARFAddressRangesVector> Ranges = Die.getAddressRanges();
+        if (!Ranges) {
+          consumeError(Ranges.takeError());
+          return false;
+        }
+        for (const DWARFAddressRange &R : *Ranges) {
+          Boundaries.push_back(R.LowPC);
+          Boundaries.push_back(R.HighPC);
+        }
+      }
+    }
+  }
+
+  // The answer at a boundary may differ from the one for the addresses after
+  // it, e.g. where several line table rows have the same address.
+  for (size_t I = 0, E = Boundaries.size(); I != E; ++I)
+    if (Boundaries[I] != UINT64_MAX)
+      Boundaries.push_back(Boundaries[I] + 1);
+
+  llvm::sort(Boundaries.begin(), Boundaries.end());
+  Boundaries.erase(std::unique(Boundaries.begin(), Boundaries.end()),
+                   Boundaries.end());
+  return true;
+}
+
 bool SymbolizableObjectFile::getNameFromSymbolTable(SymbolRef::Type Type,
                                                     uint64_t Address,
                                                     std::string &Name,
@@ -22,6 +22,7 @@
 #include <memory>
 #include <string>
 #include <system_error>
+#include <vector>
 
 namespace llvm {
 
@@ -48,6 +49,11 @@ public:
   // it in memory assuming there were no conflicts.
   uint64_t getModulePreferredBase() const override;
 
+  // Collect the sorted addresses at which the answers of symbolizeCode and
+  // symbolizeInlinedCode may change, including zero. Returns false if they
+  // are not known, e.g. for debug info in split DWARF or PDB files.
+  bool getAddressBoundaries(std::vector<uint64_t> &Boundaries) const;
+
 private:
   bool shouldOverrideWithSymbolTable(FunctionNameKind FNKind,
                                      bool UseSymbolTable) const;
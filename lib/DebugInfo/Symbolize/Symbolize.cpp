@@ -13,9 +13,11 @@
 
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
 
+#include "SymbolizableIndexFile.h"
 #include "SymbolizableObjectFile.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/Config/config.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -23,6 +25,7 @@
 #include "llvm/DebugInfo/PDB/PDBContext.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Object/COFF.h"
+#include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/MachO.h"
 #include "llvm/Object/MachOUniversal.h"
 #include "llvm/Support/Casting.h"
@@ -236,6 +239,48 @@ bool getGNUDebuglinkContents(const ObjectFile *Obj, std::string &DebugName,
   return false;
 }
 
+template <class ELFT>
+ArrayRef<uint8_t> getBuildID(const ELFFile<ELFT> *Obj) {
+  auto Sections = Obj->sections();
+  if (!Sections) {
+    consumeError(Sections.takeError());
+    return {};
+  }
+  for (const auto &Shdr : *Sections) {
+    if (Shdr.sh_type != ELF::SHT_NOTE)
+      continue;
+    ArrayRef<uint8_t> BuildID;
+    Error Err = Error::success();
+    for (const auto &Note : Obj->notes(Shdr, Err)) {
+      if (Note.getType() == ELF::NT_GNU_BUILD_ID && Note.getName() == "GNU") {
+        auto Desc = Note.getDesc();
+        BuildID = makeArrayRef(reinterpret_cast<const uint8_t *>(Desc.data()),
+                               Desc.size());
+        break;
+      }
+    }
+    consumeError(std::move(Err));
+    if (!BuildID.empty())
+      return BuildID;
+  }
+  return {};
+}
+
+// Returns the GNU build ID of an ELF file, or the UUID of a Mach-O file.
+ArrayRef<uint8_t> getBuildID(const ObjectFile *Obj) {
+  if (auto *O = dyn_cast<ELF32LEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<ELF32BEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<ELF64LEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<ELF64BEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<MachOObjectFile>(Obj))
+    return O->getUuid();
+  return {};
+}
+
 bool darwinDsymMatchesBinary(const MachOObjectFile *DbgObj,
                              const MachOObjectFile *Obj) {
   ArrayRef<uint8_t> dbg_uuid = DbgObj->getUuid();
@@ -396,6 +441,15 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
   }
   ObjectPair Objects = ObjectsOrErr.get();
 
+  if (!Opts.IndexDirectory.empty()) {
+    if (auto SymMod = createIndexedModuleInfo(Objects, DWPName)) {
+      auto InsertResult =
+          Modules.insert(std::make_pair(ModuleName, std::move(SymMod)));
+      assert(InsertResult.second);
+      return InsertResult.first->second.get();
+    }
+  }
+
   std::unique_ptr<DIContext> Context;
   // If this is a COFF object containing PDB info, use a PDBContext to
   // symbolize. Otherwise, use DWARF.
@@ -433,6 +487,49 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
   return InsertResult.first->second.get();
 }
 
+std::unique_ptr<SymbolizableModule>
+LLVMSymbolizer::createIndexedModuleInfo(const ObjectPair &Objects,
+                                        StringRef DWPName) {
+  if (isa<COFFObjectFile>(Objects.first))
+    return nullptr;
+  ArrayRef<uint8_t> BuildID = getBuildID(Objects.first);
+  if (BuildID.empty())
+    return nullptr;
+
+  SmallString<128> IndexPath(Opts.IndexDirectory);
+  sys::path::append(IndexPath, StringRef(toHex(BuildID)).lower() + ".symidx");
+
+  std::string DWP = DWPName;
+  auto CreateModule = [Objects, DWP]() {
+    std::unique_ptr<SymbolizableObjectFile> SymMod;
+    auto InfoOrErr = SymbolizableObjectFile::create(
+        Objects.first,
+        DWARFContext::create(*Objects.second, nullptr,
+                             DWARFContext::defaultErrorHandler, DWP));
+    if (InfoOrErr)
+      SymMod = std::move(InfoOrErr.get());
+    return SymMod;
+  };
+
+  auto IndexOrErr =
+      SymbolizableIndexFile::open(IndexPath, BuildID, Opts.PrintFunctions,
+                                  Opts.UseSymbolTable, CreateModule);
+  if (IndexOrErr)
+    return std::move(IndexOrErr.get());
+  consumeError(IndexOrErr.takeError());
+
+  // Index the debug info for the next run, and use it directly for this one.
+  // Errors are reported as usual by the caller if the module cannot be
+  // created, and an index which cannot be written is not an error.
+  std::unique_ptr<SymbolizableObjectFile> SymMod = CreateModule();
+  if (!SymMod)
+    return nullptr;
+  consumeError(SymbolizableIndexFile::write(IndexPath, *SymMod, BuildID,
+                                            Opts.PrintFunctions,
+                                            Opts.UseSymbolTable));
+  return std::move(SymMod);
+}
+
 namespace {
 
 // Undo these various manglings for Win32 extern "C" functions:
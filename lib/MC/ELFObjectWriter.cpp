@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/CachedHashString.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
@@ -38,6 +39,7 @@
 #include "llvm/MC/StringTableBuilder.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
@@ -48,6 +50,7 @@
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/SwapByteOrder.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -61,6 +64,12 @@
 
 using namespace llvm;
 
+static cl::opt<unsigned> CompressDebugSectionsThreads(
+    "compress-debug-sections-threads",
+    cl::desc("Number of threads used to compress debug sections "
+             "(default = 1, 0 = number of hardware threads)"),
+    cl::init(1));
+
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
@@ -116,7 +125,9 @@ struct ELFWriter {
   struct ELFSymbolData {
     const MCSymbolELF *Symbol;
     uint32_t SectionIndex;
-    StringRef Name;
+    // The name is hashed once, when it is added to the string table, and
+    // the hash is reused to look up its offset.
+    CachedHashStringRef Name = CachedHashStringRef(StringRef(), 0);
 
     // Support lexicographic sorting.
     bool operator<(const ELFSymbolData &RHS) const {
@@ -128,7 +139,7 @@ struct ELFWriter {
         return true;
       if (LHSType == ELF::STT_SECTION && RHSType == ELF::STT_SECTION)
         return SectionIndex < RHS.SectionIndex;
-      return Name < RHS.Name;
+      return Name.val() < RHS.Name.val();
     }
   };
 
@@ -680,8 +691,8 @@ void ELFWriter::computeSymbolTable(
 
     // Sections have their own string table
     if (Symbol.getType() != ELF::STT_SECTION) {
-      MSD.Name = Name;
-      StrTabBuilder.add(Name);
+      MSD.Name = CachedHashStringRef(Name);
+      StrTabBuilder.add(MSD.Name);
     }
 
     if (Local)
@@ -851,10 +862,15 @@ void ELFWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
   raw_svector_ostream VecOS(UncompressedData);
   Asm.writeSectionData(VecOS, &Section, Layout);
 
+  // Large sections are compressed in chunks, on several threads if asked. The
+  // result only depends on the chunk size, not on the number of threads.
+  unsigned Threads = CompressDebugSectionsThreads;
+  if (Threads == 0)
+    Threads = hardware_concurrency();
   SmallVector<char, 128> CompressedContents;
-  if (Error E = zlib::compress(
+  if (Error E = zlib::compressParallel(
           StringRef(UncompressedData.data(), UncompressedData.size()),
-          CompressedContents)) {
+          CompressedContents, Threads)) {
     consumeError(std::move(E));
     W.OS << UncompressedData;
     return;
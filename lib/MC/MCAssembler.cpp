@@ -9,6 +9,7 @@
 
 #include "llvm/MC/MCAssembler.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
@@ -32,16 +33,19 @@
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MCValue.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 using namespace llvm;
 
@@ -68,6 +72,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(RelaxationChecks,
+          "Number of fragments examined for relaxation incrementally");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
@@ -76,6 +82,11 @@ STATISTIC(PaddingFragmentsBytes,
 } // end namespace stats
 } // end anonymous namespace
 
+static cl::opt<bool> IncrementalRelaxation(
+    "mc-incremental-relaxation", cl::Hidden, cl::init(true),
+    cl::desc("Only re-examine the fragments whose fixups may have changed "
+             "when relaxing a section"));
+
 // FIXME FIXME FIXME: There are number of places in this file where we convert
 // what is a 64-bit assembler value used for computation into a value in the
 // object file, which may truncate it. We should detect that truncation where
@@ -774,6 +785,16 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
       Frag.setLayoutOrder(FragmentIndex++);
   }
 
+  // Relax each section on its own first, so that layoutOnce normally only
+  // has to check that nothing more needs relaxing.
+  if (IncrementalRelaxation) {
+    for (MCSection &Sec : *this) {
+      relaxSectionIncrementally(Layout, Sec);
+      if (getContext().hadError())
+        return;
+    }
+  }
+
   // Layout until everything fits.
   while (layoutOnce(Layout))
     if (getContext().hadError())
@@ -1023,6 +1044,31 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
   return OldSize != F.getContents().size();
 }
 
+bool MCAssembler::relaxFragment(MCAsmLayout &Layout, MCFragment &F) {
+  switch(F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Relaxable:
+    assert(!getRelaxAll() &&
+           "Did not expect a MCRelaxableFragment in RelaxAll mode");
+    return relaxInstruction(Layout, cast<MCRelaxableFragment>(F));
+  case MCFragment::FT_Dwarf:
+    return relaxDwarfLineAddr(Layout, cast<MCDwarfLineAddrFragment>(F));
+  case MCFragment::FT_DwarfFrame:
+    return relaxDwarfCallFrameFragment(Layout,
+                                       cast<MCDwarfCallFrameFragment>(F));
+  case MCFragment::FT_LEB:
+    return relaxLEB(Layout, cast<MCLEBFragment>(F));
+  case MCFragment::FT_Padding:
+    return relaxPaddingFragment(Layout, cast<MCPaddingFragment>(F));
+  case MCFragment::FT_CVInlineLines:
+    return relaxCVInlineLineTable(Layout,
+                                  cast<MCCVInlineLineTableFragment>(F));
+  case MCFragment::FT_CVDefRange:
+    return relaxCVDefRange(Layout, cast<MCCVDefRangeFragment>(F));
+  }
+}
+
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
@@ -1031,48 +1077,195 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   MCFragment *FirstRelaxedFragment = nullptr;
 
   // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
-    // Check if this is a fragment that needs relaxation.
-    bool RelaxedFrag = false;
-    switch(I->getKind()) {
+  for (MCFragment &F : Sec)
+    if (relaxFragment(Layout, F) && !FirstRelaxedFragment)
+      FirstRelaxedFragment = &F;
+
+  if (FirstRelaxedFragment) {
+    Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
+    return true;
+  }
+  return false;
+}
+
+namespace {
+
+/// Records, for each fragment of a section which may be relaxed, the range of
+/// fragments whose sizes its relaxation depends on, and finds the fragments
+/// which depend on a given fragment.
+///
+/// The ranges are stored in a segment tree over the layout order of the
+/// fragments, so that finding the dependents of a fragment takes time
+/// proportional to their number rather than to the size of the section.
+class RelaxationDependencies {
+  unsigned Size;
+  std::vector<std::pair<unsigned, unsigned>> Pending;
+  std::vector<unsigned> NodeBegin;
+  std::vector<unsigned> Dependents;
+
+public:
+  explicit RelaxationDependencies(unsigned NumFragments)
+      : Size(PowerOf2Ceil(std::max(NumFragments, 1u))) {}
+
+  /// Record that fragment \p Dependent depends on the sizes of the fragments
+  /// in [\p Begin, \p End).
+  void add(unsigned Dependent, unsigned Begin, unsigned End) {
+    for (unsigned L = Begin + Size, R = End + Size; L < R; L >>= 1, R >>= 1) {
+      if (L & 1)
+        Pending.push_back({L++, Dependent});
+      if (R & 1)
+        Pending.push_back({--R, Dependent});
+    }
+  }
+
+  /// Build the tree once all the dependencies have been added.
+  void finalize() {
+    NodeBegin.assign(2 * Size + 1, 0);
+    for (const auto &P : Pending)
+      ++NodeBegin[P.first + 1];
+    for (unsigned N = 1, E = NodeBegin.size(); N != E; ++N)
+      NodeBegin[N] += NodeBegin[N - 1];
+    Dependents.resize(Pending.size());
+    std::vector<unsigned> Next(NodeBegin.begin(), NodeBegin.end() - 1);
+    for (const auto &P : Pending)
+      Dependents[Next[P.first]++] = P.second;
+    Pending.clear();
+    Pending.shrink_to_fit();
+  }
+
+  /// Call \p Fn with each fragment which depends on fragment \p Changed.
+  template <typename Callable>
+  void forEachDependent(unsigned Changed, Callable Fn) const {
+    for (unsigned N = Changed + Size; N != 0; N >>= 1)
+      for (unsigned I = NodeBegin[N], E = NodeBegin[N + 1]; I != E; ++I)
+        Fn(Dependents[I]);
+  }
+};
+
+} // end anonymous namespace
+
+/// Return true if the size of \p F depends on its offset.
+static bool hasOffsetDependentSize(const MCFragment &F) {
+  switch (F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Align:
+  case MCFragment::FT_Org:
+    return true;
+  case MCFragment::FT_Fill: {
+    int64_t NumValues;
+    return !cast<MCFillFragment>(F).getNumValues().evaluateAsAbsolute(
+        NumValues);
+  }
+  }
+}
+
+/// Find the range of fragments [\p Begin, \p End) whose sizes the fixups of
+/// \p F depend on. Return false if they may depend on anything outside the
+/// section, such as an undefined symbol.
+static bool getFixupDependencies(const MCRelaxableFragment &F,
+                                 unsigned &Begin, unsigned &End) {
+  Begin = F.getLayoutOrder();
+  End = Begin + 1;
+  for (const MCFixup &Fixup : F.getFixups()) {
+    MCValue Target;
+    if (!Fixup.getValue()->evaluateAsRelocatable(Target, nullptr, &Fixup))
+      return false;
+    for (const MCSymbolRefExpr *Ref : {Target.getSymA(), Target.getSymB()}) {
+      if (!Ref)
+        continue;
+      const MCSymbol &Sym = Ref->getSymbol();
+      if (Sym.isVariable() || !Sym.isInSection() ||
+          Sym.getFragment()->getParent() != F.getParent())
+        return false;
+      unsigned Order = Sym.getFragment()->getLayoutOrder();
+      Begin = std::min(Begin, Order);
+      End = std::max(End, Order + 1);
+    }
+  }
+  return true;
+}
+
+bool MCAssembler::relaxSectionIncrementally(MCAsmLayout &Layout,
+                                            MCSection &Sec) {
+  std::vector<MCFragment *> Fragments;
+  for (MCFragment &F : Sec)
+    Fragments.push_back(&F);
+  unsigned NumFragments = Fragments.size();
+
+  // The distance between two fragments changes when a fragment between them
+  // changes size, or when an alignment between them does as a result of a
+  // change anywhere before it.
+  std::vector<unsigned> NumOffsetDependentBefore(NumFragments + 1);
+  for (unsigned I = 0; I != NumFragments; ++I)
+    NumOffsetDependentBefore[I + 1] =
+        NumOffsetDependentBefore[I] + hasOffsetDependentSize(*Fragments[I]);
+
+  // Every fragment which may be relaxed is examined once. Instructions depend
+  // on the fragments between themselves and their fixup targets, and anything
+  // else conservatively depends on the whole section.
+  RelaxationDependencies Deps(NumFragments);
+  std::vector<unsigned> Worklist;
+  for (unsigned I = 0; I != NumFragments; ++I) {
+    MCFragment &F = *Fragments[I];
+    unsigned Begin = 0, End = NumFragments;
+    switch (F.getKind()) {
     default:
-      break;
+      continue;
     case MCFragment::FT_Relaxable:
-      assert(!getRelaxAll() &&
-             "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
+      if (!getFixupDependencies(cast<MCRelaxableFragment>(F), Begin, End)) {
+        Begin = 0;
+        End = NumFragments;
+      }
       break;
     case MCFragment::FT_Dwarf:
-      RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
-      break;
     case MCFragment::FT_DwarfFrame:
-      RelaxedFrag =
-        relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
-      break;
     case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
-      break;
     case MCFragment::FT_Padding:
-      RelaxedFrag = relaxPaddingFragment(Layout, *cast<MCPaddingFragment>(I));
-      break;
     case MCFragment::FT_CVInlineLines:
-      RelaxedFrag =
-          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(I));
-      break;
     case MCFragment::FT_CVDefRange:
-      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
       break;
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+    if (NumOffsetDependentBefore[End] != NumOffsetDependentBefore[Begin])
+      Begin = 0;
+    Deps.add(I, Begin, End);
+    Worklist.push_back(I);
   }
-  if (FirstRelaxedFragment) {
+  Deps.finalize();
+
+  // Examine the fragments in layout order in rounds, as layoutSectionOnce
+  // does, but only those which depend on a fragment changed in the previous
+  // round.
+  bool WasRelaxed = false;
+  BitVector Queued(NumFragments);
+  std::vector<unsigned> Next;
+  while (!Worklist.empty()) {
+    MCFragment *FirstRelaxedFragment = nullptr;
+    for (unsigned I : Worklist) {
+      ++stats::RelaxationChecks;
+      if (!relaxFragment(Layout, *Fragments[I]))
+        continue;
+      if (!FirstRelaxedFragment)
+        FirstRelaxedFragment = Fragments[I];
+      Deps.forEachDependent(I, [&](unsigned D) {
+        if (!Queued.test(D)) {
+          Queued.set(D);
+          Next.push_back(D);
+        }
+      });
+    }
+    if (!FirstRelaxedFragment || getContext().hadError())
+      break;
+
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
-    return true;
+    WasRelaxed = true;
+
+    llvm::sort(Next.begin(), Next.end());
+    Queued.reset();
+    Worklist.swap(Next);
+    Next.clear();
   }
-  return false;
+  return WasRelaxed;
 }
 
 bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
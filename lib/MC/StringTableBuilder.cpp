@@ -12,8 +12,10 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/COFF.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <cstddef>
@@ -116,6 +118,49 @@ tailcall:
   }
 }
 
+// The number of strings below which sorting them is not worth spreading over
+// several threads.
+static cl::opt<unsigned> ParallelSortThreshold(
+    "string-table-parallel-sort-threshold", cl::Hidden, cl::init(1 << 16),
+    cl::desc("Sort string tables of at least this many strings in parallel"));
+
+// Returns a key for the last two characters of a string, which orders strings
+// as multikeySort does by those characters.
+static unsigned tailKey(StringPair *P) {
+  return (charTailAt(P, 0) + 1) * 257 + (charTailAt(P, 1) + 1);
+}
+
+// Sorts strings into the same order as multikeySort(Vec, 0). Large tables are
+// first split into shards by their last two characters, which are then sorted
+// in parallel. As the strings are unique the order does not depend on how the
+// work is split.
+static void parallelMultikeySort(MutableArrayRef<StringPair *> Vec) {
+  if (Vec.size() < ParallelSortThreshold) {
+    multikeySort(Vec, 0);
+    return;
+  }
+
+  // Shards are laid out in descending order of key, as multikeySort puts
+  // greater characters first.
+  const unsigned NumShards = 257 * 257;
+  std::vector<size_t> ShardBegin(NumShards + 1);
+  for (StringPair *P : Vec)
+    ++ShardBegin[NumShards - tailKey(P)];
+  for (unsigned I = 0; I != NumShards; ++I)
+    ShardBegin[I + 1] += ShardBegin[I];
+
+  std::vector<StringPair *> Sharded(Vec.size());
+  std::vector<size_t> Next(ShardBegin.begin(), ShardBegin.end() - 1);
+  for (StringPair *P : Vec)
+    Sharded[Next[NumShards - 1 - tailKey(P)]++] = P;
+  std::copy(Sharded.begin(), Sharded.end(), Vec.begin());
+
+  parallel::for_each_n(parallel::par, 0u, NumShards, [&](unsigned I) {
+    multikeySort(Vec.slice(ShardBegin[I], ShardBegin[I + 1] - ShardBegin[I]),
+                 2);
+  });
+}
+
 void StringTableBuilder::finalize() {
   assert(K != DWARF);
   finalizeStringTable(/*Optimize=*/true);
@@ -134,7 +179,7 @@ void StringTableBuilder::finalizeStringTable(bool Optimize) {
     for (StringPair &P : StringIndexMap)
       Strings.push_back(&P);
 
-    multikeySort(Strings, 0);
+    parallelMultikeySort(Strings);
     initSize();
 
     StringRef Previous;
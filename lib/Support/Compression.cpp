@@ -18,6 +18,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -61,6 +62,112 @@ Error zlib::compress(StringRef InputBuffer,
   return Res ? createError(convertZlibCodeToString(Res)) : Error::success();
 }
 
+namespace {
+/// A chunk of the input to compressParallel and its compressed form, which is
+/// a raw deflate stream ending on a byte boundary.
+struct CompressedChunk {
+  StringRef Input;
+  StringRef Dictionary;
+  bool Last;
+  SmallVector<char, 0> Output;
+  uLong Adler;
+  int Res = Z_OK;
+};
+} // end anonymous namespace
+
+static void compressChunk(CompressedChunk &C, int Level) {
+  C.Adler = ::adler32(::adler32(0, nullptr, 0), (const Bytef *)C.Input.data(),
+                      C.Input.size());
+
+  z_stream S = {};
+  C.Res = ::deflateInit2(&S, Level, Z_DEFLATED, /*windowBits*/ -MAX_WBITS,
+                         /*memLevel*/ 8, Z_DEFAULT_STRATEGY);
+  if (C.Res != Z_OK)
+    return;
+  if (!C.Dictionary.empty())
+    C.Res = ::deflateSetDictionary(&S, (const Bytef *)C.Dictionary.data(),
+                                   C.Dictionary.size());
+
+  // A sync flush ends the chunk on a byte boundary with an empty stored
+  // block, so that the next chunk's blocks can follow it directly. Only the
+  // last chunk marks the end of the stream.
+  int Flush = C.Last ? Z_FINISH : Z_SYNC_FLUSH;
+  C.Output.resize(::deflateBound(&S, C.Input.size()) + 16);
+  S.next_in = (Bytef *)C.Input.data();
+  S.avail_in = C.Input.size();
+  S.next_out = (Bytef *)C.Output.data();
+  S.avail_out = C.Output.size();
+  while (C.Res == Z_OK) {
+    C.Res = ::deflate(&S, Flush);
+    if (C.Res == Z_STREAM_ERROR)
+      break;
+    if (C.Last ? C.Res == Z_STREAM_END : S.avail_out != 0) {
+      C.Res = Z_OK;
+      break;
+    }
+    // Out of space for the output.
+    size_t Used = C.Output.size() - S.avail_out;
+    C.Output.resize(C.Output.size() * 2);
+    S.next_out = (Bytef *)C.Output.data() + Used;
+    S.avail_out = C.Output.size() - Used;
+    C.Res = Z_OK;
+  }
+  C.Output.resize(C.Output.size() - S.avail_out);
+  ::deflateEnd(&S);
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  __msan_unpoison(C.Output.data(), C.Output.size());
+}
+
+Error zlib::compressParallel(StringRef InputBuffer,
+                             SmallVectorImpl<char> &CompressedBuffer,
+                             unsigned Threads, size_t ChunkSize, int Level) {
+  if (InputBuffer.size() <= ChunkSize)
+    return compress(InputBuffer, CompressedBuffer, Level);
+
+  // Deflate can refer back up to 32KiB, so that is all of the previous chunk
+  // that is worth priming the next one with.
+  const size_t WindowSize = 1 << MAX_WBITS;
+  std::vector<CompressedChunk> Chunks((InputBuffer.size() + ChunkSize - 1) /
+                                      ChunkSize);
+  for (size_t I = 0, E = Chunks.size(); I != E; ++I) {
+    size_t Begin = I * ChunkSize;
+    Chunks[I].Input = InputBuffer.substr(Begin, ChunkSize);
+    Chunks[I].Dictionary = InputBuffer.slice(
+        Begin - std::min(Begin, WindowSize), Begin);
+    Chunks[I].Last = I + 1 == E;
+  }
+
+  if (Threads > 1) {
+    ThreadPool Pool(std::min<size_t>(Threads, Chunks.size()));
+    for (CompressedChunk &C : Chunks)
+      Pool.async([&C, Level] { compressChunk(C, Level); });
+    Pool.wait();
+  } else {
+    for (CompressedChunk &C : Chunks)
+      compressChunk(C, Level);
+  }
+
+  // The zlib header holds the compression method and level, and the trailer
+  // the Adler-32 checksum of the whole input.
+  unsigned char CMF = 0x78;
+  unsigned char FLG = (Level < 2 ? 0 : Level < 6 ? 1 : Level == 6 ? 2 : 3)
+                      << 6;
+  FLG += 31 - (CMF * 256 + FLG) % 31;
+  CompressedBuffer.clear();
+  CompressedBuffer.push_back(CMF);
+  CompressedBuffer.push_back(FLG);
+  uLong Adler = ::adler32(0, nullptr, 0);
+  for (CompressedChunk &C : Chunks) {
+    if (C.Res != Z_OK)
+      return createError(convertZlibCodeToString(C.Res));
+    CompressedBuffer.append(C.Output.begin(), C.Output.end());
+    Adler = ::adler32_combine(Adler, C.Adler, C.Input.size());
+  }
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back((Adler >> Shift) & 0xff);
+  return Error::success();
+}
+
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   int Res =
@@ -92,6 +199,11 @@ Error zlib::compress(StringRef InputBuffer,
                      SmallVectorImpl<char> &CompressedBuffer, int Level) {
   llvm_unreachable("zlib::compress is unavailable");
 }
+Error zlib::compressParallel(StringRef InputBuffer,
+                             SmallVectorImpl<char> &CompressedBuffer,
+                             unsigned Threads, size_t ChunkSize, int Level) {
+  llvm_unreachable("zlib::compressParallel is unavailable");
+}
 Error zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                        size_t &UncompressedSize) {
   llvm_unreachable("zlib::uncompress is unavailable");
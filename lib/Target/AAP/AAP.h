@@ -18,9 +18,22 @@
 #include "MCTargetDesc/AAPMCTargetDesc.h"
 
 namespace llvm {
+namespace AAPII {
+// Target operand flags for symbolic operands
+enum TOF {
+  MO_NO_FLAG,
+
+  // The offset of a small data symbol from the global pointer, sym@gprel
+  MO_GPREL
+};
+} // end namespace AAPII
+
+class AAPRegisterBankInfo;
+class AAPSubtarget;
 class AAPTargetMachine;
 class AsmPrinter;
 class FunctionPass;
+class InstructionSelector;
 class MachineInstr;
 class MachineOperand;
 class MCInst;
@@ -34,7 +47,14 @@ void LowerAAPMachineInstrToMCInst(const MachineInstr *MI, MCInst &OutMI,
 
 FunctionPass *createAAPISelDag(AAPTargetMachine &TM);
 
+FunctionPass *createAAPBranchPlacementPass();
+
 FunctionPass *createAAPShortInstrPeepholePass(AAPTargetMachine &TM);
+FunctionPass *createAAPShortRegHintsPass();
+
+InstructionSelector *createAAPInstructionSelector(const AAPTargetMachine &TM,
+                                                  AAPSubtarget &Subtarget,
+                                                  AAPRegisterBankInfo &RBI);
 }
 
 #endif
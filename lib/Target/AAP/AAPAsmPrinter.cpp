@@ -15,8 +15,10 @@
 #include "AAP.h"
 #include "InstPrinter/AAPInstPrinter.h"
 #include "llvm/CodeGen/AsmPrinter.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Target/TargetMachine.h"
 
 #define DEBUG_TYPE "asm-printer"
 
@@ -47,9 +49,22 @@ public:
                                    const MachineInstr *MI);
 
   void EmitInstruction(const MachineInstr *MI) override;
+
+  // Emit the short form of the instruction if it has one which fits.
+  void EmitToStreamer(MCStreamer &S, const MCInst &Inst);
 };
 } // end of anonymous namespace
 
+#define GEN_COMPRESS_INSTR
+#include "AAPGenCompressInstEmitter.inc"
+
+void AAPAsmPrinter::EmitToStreamer(MCStreamer &S, const MCInst &Inst) {
+  MCInst CompressedInst;
+  bool Compressed = compressInst(CompressedInst, Inst,
+                                 *TM.getMCSubtargetInfo(), S.getContext());
+  AsmPrinter::EmitToStreamer(S, Compressed ? CompressedInst : Inst);
+}
+
 bool AAPAsmPrinter::PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
                                     unsigned AsmVariant, const char *ExtraCode,
                                     raw_ostream &O) {
@@ -0,0 +1,165 @@
+//===--- AAPBranchPlacement.cpp - Move cold blocks out of branch range ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The short forms of BRA and the conditional branches have much smaller
+// displacements than the long forms, see ShortInstrPeephole::shortenBranches.
+// Block placement does not take this into account, and may leave rarely
+// executed blocks between a frequently taken branch and its target. This pass
+// runs after placement and moves such cold blocks to the end of the function,
+// so that the hot branches over them are more likely to be in short range.
+//
+// Only blocks which are not fallen into from a block which stays in place are
+// moved, so that no branches are added to the hot path. A cold block which
+// falls through gains a branch to its layout successor, unless the function is
+// optimized for size.
+//
+// The pass is off by default. Over test/CodeGen/AAP it removed as many short
+// branches as it enabled, because the conditional branches have so little
+// range that moving a block seldom brings them in range. Enable it with
+// -aap-branch-placement.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AAP.h"
+#include "AAPInstrInfo.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/Support/BranchProbability.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "aap-branch-placement"
+
+using namespace llvm;
+
+STATISTIC(NumMoved, "Number of cold blocks moved to the end of a function");
+
+static cl::opt<bool> EnableBranchPlacement(
+    "aap-branch-placement", cl::Hidden, cl::init(false),
+    cl::desc("Move cold blocks out of the range of short branches"));
+
+static cl::opt<unsigned> ColdBlockRatio(
+    "aap-cold-block-ratio", cl::Hidden, cl::init(16),
+    cl::desc("Blocks executed less often than the entry block by this factor "
+             "are moved to the end of the function"));
+
+namespace {
+class AAPBranchPlacement : public MachineFunctionPass {
+public:
+  static char ID;
+
+  AAPBranchPlacement() : MachineFunctionPass(ID) {}
+
+  StringRef getPassName() const override {
+    return "AAP Short Branch Block Placement";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+private:
+  const TargetInstrInfo *TII;
+
+  bool canMoveBlock(MachineBasicBlock &MBB, bool PrevMoved,
+                    bool OptSize) const;
+  void updateTerminator(MachineBasicBlock &MBB) const;
+};
+
+char AAPBranchPlacement::ID = 0;
+} // namespace
+
+bool AAPBranchPlacement::canMoveBlock(MachineBasicBlock &MBB, bool PrevMoved,
+                                      bool OptSize) const {
+  if (MBB.isEHPad() || MBB.hasAddressTaken())
+    return false;
+
+  // Moving a block which its layout predecessor falls into would need a
+  // branch to be added to the predecessor, unless the predecessor is moved
+  // along with it.
+  if (!PrevMoved && MBB.getPrevNode()->canFallThrough())
+    return false;
+
+  if (!MBB.canFallThrough())
+    return true;
+
+  // The terminators of a block which falls through are rewritten once it has
+  // moved, which is only possible if they can be analyzed.
+  MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+  SmallVector<MachineOperand, 4> Cond;
+  return !OptSize && !TII->analyzeBranch(MBB, TBB, FBB, Cond);
+}
+
+// Update the terminators of a block after the blocks around it have moved.
+// Blocks with terminators which cannot be analyzed never fall through, so
+// need no update.
+void AAPBranchPlacement::updateTerminator(MachineBasicBlock &MBB) const {
+  MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+  SmallVector<MachineOperand, 4> Cond;
+  if (!TII->analyzeBranch(MBB, TBB, FBB, Cond))
+    MBB.updateTerminator();
+}
+
+bool AAPBranchPlacement::runOnMachineFunction(MachineFunction &MF) {
+  if (!EnableBranchPlacement || skipFunction(MF.getFunction()) ||
+      MF.size() < 3)
+    return false;
+
+  TII = MF.getSubtarget().getInstrInfo();
+  const MachineBlockFrequencyInfo &MBFI =
+      getAnalysis<MachineBlockFrequencyInfo>();
+  bool OptSize = MF.getFunction().optForSize();
+
+  BlockFrequency Threshold =
+      MBFI.getBlockFreq(&MF.front()) * BranchProbability(1, ColdBlockRatio);
+  auto IsCold = [&](const MachineBasicBlock &MBB) {
+    return &MBB != &MF.front() && MBFI.getBlockFreq(&MBB) < Threshold;
+  };
+
+  // Cold blocks after the last hot block are already out of the way.
+  MachineBasicBlock *LastHot = &MF.front();
+  for (MachineBasicBlock &MBB : MF)
+    if (!IsCold(MBB))
+      LastHot = &MBB;
+
+  SmallVector<MachineBasicBlock *, 8> ToMove;
+  for (MachineBasicBlock &MBB : MF) {
+    if (&MBB == LastHot)
+      break;
+    bool PrevMoved = !ToMove.empty() && ToMove.back() == MBB.getPrevNode();
+    if (IsCold(MBB) && canMoveBlock(MBB, PrevMoved, OptSize))
+      ToMove.push_back(&MBB);
+  }
+
+  // Move the blocks in their original order, so that cold blocks which fall
+  // through into one another end up together again. The branch added when a
+  // block is moved is removed once its layout successor has followed it, and
+  // a branch over the block from its old layout predecessor is removed once
+  // the target is the new layout successor.
+  for (MachineBasicBlock *MBB : ToMove) {
+    LLVM_DEBUG(dbgs() << "Moving cold block " << printMBBReference(*MBB)
+                      << " to the end of " << MF.getName() << "\n");
+    MachineBasicBlock *OldPrev = MBB->getPrevNode();
+    MBB->moveAfter(&MF.back());
+    updateTerminator(*MBB);
+    updateTerminator(*OldPrev);
+    updateTerminator(*MBB->getPrevNode());
+    ++NumMoved;
+  }
+
+  return !ToMove.empty();
+}
+
+FunctionPass *llvm::createAAPBranchPlacementPass() {
+  return new AAPBranchPlacement();
+}
@@ -0,0 +1,354 @@
+//===-- AAPCallLowering.cpp - Call lowering for GlobalISel ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This file implements the lowering of LLVM calls to machine code calls for
+/// GlobalISel. Only arguments and return values which fit in a single register
+/// are handled, anything else is left to SelectionDAG through the GlobalISel
+/// fallback path.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AAPCallLowering.h"
+#include "AAP.h"
+#include "AAPISelLowering.h"
+#include "AAPRegisterInfo.h"
+#include "AAPSubtarget.h"
+#include "llvm/CodeGen/Analysis.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+
+using namespace llvm;
+
+#include "AAPGenCallingConv.inc"
+
+AAPCallLowering::AAPCallLowering(const AAPTargetLowering &TLI)
+    : CallLowering(&TLI) {}
+
+namespace {
+/// Common handling of values crossing an ABI boundary.
+struct AAPValueHandler : public CallLowering::ValueHandler {
+  AAPValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                  CCAssignFn *AssignFn)
+      : ValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  // SelectionDAG promotes values narrower than a register before the calling
+  // convention sees them, do the same here so that both assign identical
+  // locations.
+  bool assignArg(unsigned ValNo, MVT ValVT, MVT LocVT,
+                 CCValAssign::LocInfo LocInfo,
+                 const CallLowering::ArgInfo &Info, CCState &State) override {
+    if (ValVT.getSizeInBits() < 16) {
+      LocVT = MVT::i16;
+      if (Info.Flags.isSExt())
+        LocInfo = CCValAssign::SExt;
+      else if (Info.Flags.isZExt())
+        LocInfo = CCValAssign::ZExt;
+      else
+        LocInfo = CCValAssign::AExt;
+    }
+    if (AssignFn(ValNo, ValVT, LocVT, LocInfo, Info.Flags, State))
+      return true;
+
+    StackSize = State.getNextStackOffset();
+    return false;
+  }
+
+  unsigned StackSize = 0;
+};
+
+/// Handler for values leaving the function, either as call arguments or as
+/// return values.
+struct OutgoingValueHandler : public AAPValueHandler {
+  OutgoingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       MachineInstrBuilder &MIB, CCAssignFn *AssignFn)
+      : AAPValueHandler(MIRBuilder, MRI, AssignFn), MIB(MIB) {}
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    // Outgoing arguments are stored relative to the stack pointer, space for
+    // them is reserved in the caller's frame.
+    LLT p0 = LLT::pointer(0, 16);
+    LLT s16 = LLT::scalar(16);
+    unsigned SPReg = MRI.createGenericVirtualRegister(p0);
+    MIRBuilder.buildCopy(SPReg, AAPRegisterInfo::getStackPtrRegister());
+
+    unsigned OffsetReg = MRI.createGenericVirtualRegister(s16);
+    MIRBuilder.buildConstant(OffsetReg, Offset);
+
+    unsigned AddrReg = MRI.createGenericVirtualRegister(p0);
+    MIRBuilder.buildGEP(AddrReg, SPReg, OffsetReg);
+
+    MPO = MachinePointerInfo::getStack(MIRBuilder.getMF(), Offset);
+    return AddrReg;
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    unsigned ExtReg = extendRegister(ValVReg, VA);
+    MIRBuilder.buildCopy(PhysReg, ExtReg);
+    MIB.addUse(PhysReg, RegState::Implicit);
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    unsigned ExtReg = extendRegister(ValVReg, VA);
+    MachineMemOperand *MMO = MIRBuilder.getMF().getMachineMemOperand(
+        MPO, MachineMemOperand::MOStore, VA.getLocVT().getStoreSize(),
+        /* Alignment */ 2);
+    MIRBuilder.buildStore(ExtReg, Addr, *MMO);
+  }
+
+  MachineInstrBuilder &MIB;
+};
+
+/// Handler for values entering the function, either as formal arguments or
+/// as the results of a call.
+struct IncomingValueHandler : public AAPValueHandler {
+  IncomingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       CCAssignFn *AssignFn)
+      : AAPValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    // Every stack argument occupies a whole 2-byte slot.
+    MachineFrameInfo &MFI = MIRBuilder.getMF().getFrameInfo();
+    int FI = MFI.CreateFixedObject(alignTo(Size, 2), Offset, true);
+    MPO = MachinePointerInfo::getFixedStack(MIRBuilder.getMF(), FI);
+
+    unsigned AddrReg =
+        MRI.createGenericVirtualRegister(LLT::pointer(MPO.getAddrSpace(), 16));
+    MIRBuilder.buildFrameIndex(AddrReg, FI);
+    return AddrReg;
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    markPhysRegUsed(PhysReg);
+    if (VA.getLocInfo() == CCValAssign::Full) {
+      MIRBuilder.buildCopy(ValVReg, PhysReg);
+      return;
+    }
+
+    // Promoted values are copied out at full width and then truncated.
+    unsigned CopyReg = MRI.createGenericVirtualRegister(LLT::scalar(16));
+    MIRBuilder.buildCopy(CopyReg, PhysReg);
+    MIRBuilder.buildTrunc(ValVReg, CopyReg);
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    // Incoming argument slots are immutable
+    MachineFunction &MF = MIRBuilder.getMF();
+    auto Flags = MachineMemOperand::MOLoad | MachineMemOperand::MOInvariant;
+    if (VA.getLocInfo() == CCValAssign::Full) {
+      MachineMemOperand *MMO =
+          MF.getMachineMemOperand(MPO, Flags, Size, /* Alignment */ 2);
+      MIRBuilder.buildLoad(ValVReg, Addr, *MMO);
+      return;
+    }
+
+    // Promoted values occupy the whole slot, load all of it and truncate.
+    MachineMemOperand *MMO =
+        MF.getMachineMemOperand(MPO, Flags, 2, /* Alignment */ 2);
+    unsigned LoadReg = MRI.createGenericVirtualRegister(LLT::scalar(16));
+    MIRBuilder.buildLoad(LoadReg, Addr, *MMO);
+    MIRBuilder.buildTrunc(ValVReg, LoadReg);
+  }
+
+  /// Incoming registers are live into the entry block for formal arguments,
+  /// and are implicitly defined by the call for call results.
+  virtual void markPhysRegUsed(unsigned PhysReg) = 0;
+};
+
+struct FormalArgHandler : public IncomingValueHandler {
+  FormalArgHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                   CCAssignFn *AssignFn)
+      : IncomingValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIRBuilder.getMRI()->addLiveIn(PhysReg);
+    MIRBuilder.getMBB().addLiveIn(PhysReg);
+  }
+};
+
+struct CallReturnHandler : public IncomingValueHandler {
+  CallReturnHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                    MachineInstrBuilder &MIB, CCAssignFn *AssignFn)
+      : IncomingValueHandler(MIRBuilder, MRI, AssignFn), MIB(MIB) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIB.addDef(PhysReg, RegState::Implicit);
+  }
+
+  MachineInstrBuilder &MIB;
+};
+} // end anonymous namespace
+
+bool AAPCallLowering::getValueTypeArg(const ArgInfo &OrigArg, ArgInfo &Arg,
+                                      const DataLayout &DL) const {
+  const AAPTargetLowering &TLI = *getTLI<AAPTargetLowering>();
+
+  SmallVector<EVT, 4> SplitVTs;
+  ComputeValueVTs(TLI, DL, OrigArg.Ty, SplitVTs);
+  if (SplitVTs.size() != 1 || !SplitVTs[0].isSimple() ||
+      !SplitVTs[0].isScalarInteger() || SplitVTs[0].getSizeInBits() > 16)
+    return false;
+
+  // Pointers are assigned locations as i16.
+  Arg = OrigArg;
+  Arg.Ty = SplitVTs[0].getTypeForEVT(OrigArg.Ty->getContext());
+  return true;
+}
+
+static bool isSupportedCallingConv(CallingConv::ID CC) {
+  return CC == CallingConv::C || CC == CallingConv::Fast ||
+         CC == CallingConv::Cold;
+}
+
+bool AAPCallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                  const Value *Val,
+                                  ArrayRef<unsigned> VRegs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = MF.getFunction();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  // Returns are a jump through the link register.
+  auto Ret = MIRBuilder.buildInstrNoInsert(AAP::PseudoRET);
+
+  if (Val) {
+    if (VRegs.size() != 1)
+      return false;
+
+    const DataLayout &DL = MF.getDataLayout();
+    ArgInfo OrigArg(VRegs[0], Val->getType());
+    setArgFlags(OrigArg, AttributeList::ReturnIndex, DL, F);
+
+    ArgInfo RetInfo(0, nullptr);
+    if (!getValueTypeArg(OrigArg, RetInfo, DL))
+      return false;
+
+    OutgoingValueHandler RetHandler(MIRBuilder, MRI, Ret, RetCC_AAP);
+    if (!handleAssignments(MIRBuilder, RetInfo, RetHandler))
+      return false;
+
+    // The return registers must not be restored by the epilogue, see
+    // AAPTargetLowering::LowerReturn.
+    for (const MachineOperand &MO : Ret->implicit_operands())
+      if (MO.isReg())
+        MRI.disableCalleeSavedRegister(MO.getReg());
+  }
+
+  MIRBuilder.insertInstr(Ret);
+  return true;
+}
+
+bool AAPCallLowering::lowerFormalArguments(MachineIRBuilder &MIRBuilder,
+                                           const Function &F,
+                                           ArrayRef<unsigned> VRegs) const {
+  if (F.arg_empty())
+    return true;
+
+  // Variadic functions need the frame index of the first variadic argument
+  // recorded for va_start, leave them to SelectionDAG.
+  if (F.isVarArg() || !isSupportedCallingConv(F.getCallingConv()))
+    return false;
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  const DataLayout &DL = MF.getDataLayout();
+
+  SmallVector<ArgInfo, 8> ArgInfos;
+  unsigned Idx = 0;
+  for (const Argument &Arg : F.args()) {
+    if (Arg.hasByValOrInAllocaAttr())
+      return false;
+
+    ArgInfo OrigArg(VRegs[Idx], Arg.getType());
+    setArgFlags(OrigArg, Idx + AttributeList::FirstArgIndex, DL, F);
+
+    ArgInfo AInfo(0, nullptr);
+    if (!getValueTypeArg(OrigArg, AInfo, DL))
+      return false;
+    ArgInfos.push_back(AInfo);
+    ++Idx;
+  }
+
+  FormalArgHandler ArgHandler(MIRBuilder, MF.getRegInfo(), CC_AAP);
+  return handleAssignments(MIRBuilder, ArgInfos, ArgHandler);
+}
+
+bool AAPCallLowering::lowerCall(MachineIRBuilder &MIRBuilder,
+                                CallingConv::ID CallConv,
+                                const MachineOperand &Callee,
+                                const ArgInfo &OrigRet,
+                                ArrayRef<ArgInfo> OrigArgs) const {
+  if (!isSupportedCallingConv(CallConv))
+    return false;
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  const DataLayout &DL = MF.getDataLayout();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const AAPSubtarget &STI = MF.getSubtarget<AAPSubtarget>();
+  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+
+  // Variadic arguments are all passed on the stack, which the calling
+  // convention can only tell from the callee's CCState. Byval arguments need
+  // a copy of the object in the outgoing argument area.
+  SmallVector<ArgInfo, 8> ArgInfos;
+  for (const ArgInfo &OrigArg : OrigArgs) {
+    if (!OrigArg.IsFixed || OrigArg.Flags.isByVal())
+      return false;
+
+    ArgInfo AInfo(0, nullptr);
+    if (!getValueTypeArg(OrigArg, AInfo, DL))
+      return false;
+    ArgInfos.push_back(AInfo);
+  }
+
+  ArgInfo RetInfo(0, nullptr);
+  if (!OrigRet.Ty->isVoidTy() && !getValueTypeArg(OrigRet, RetInfo, DL))
+    return false;
+
+  auto CallSeqStart = MIRBuilder.buildInstr(AAP::ADJCALLSTACKDOWN);
+
+  // Direct calls branch and link to the callee's address, indirect calls
+  // jump and link through a register. Either way the return address is
+  // written to the link register.
+  MachineInstrBuilder MIB;
+  if (Callee.isReg()) {
+    MIB = MIRBuilder.buildInstrNoInsert(AAP::JAL).add(Callee);
+    MIB->getOperand(0).setReg(constrainOperandRegClass(
+        MF, *TRI, MRI, *STI.getInstrInfo(), *STI.getRegBankInfo(),
+        *MIB.getInstr(), MIB->getDesc(), MIB->getOperand(0), 0));
+  } else {
+    MIB = MIRBuilder.buildInstrNoInsert(AAP::BAL).add(Callee);
+  }
+  MIB.addUse(AAPRegisterInfo::getLinkRegister());
+  MIB.addRegMask(TRI->getCallPreservedMask(MF, CallConv));
+
+  OutgoingValueHandler ArgHandler(MIRBuilder, MRI, MIB, CC_AAP);
+  if (!handleAssignments(MIRBuilder, ArgInfos, ArgHandler))
+    return false;
+
+  MIRBuilder.insertInstr(MIB);
+
+  if (!OrigRet.Ty->isVoidTy()) {
+    CallReturnHandler RetHandler(MIRBuilder, MRI, MIB, RetCC_AAP);
+    if (!handleAssignments(MIRBuilder, RetInfo, RetHandler))
+      return false;
+  }
+
+  CallSeqStart.addImm(ArgHandler.StackSize).addImm(0);
+  MIRBuilder.buildInstr(AAP::ADJCALLSTACKUP)
+      .addImm(ArgHandler.StackSize)
+      .addImm(0);
+  return true;
+}
@@ -0,0 +1,48 @@
+//===-- AAPCallLowering.h - Call lowering for GlobalISel --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This file describes how to lower LLVM calls to machine code calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_AAP_AAPCALLLOWERING_H
+#define LLVM_LIB_TARGET_AAP_AAPCALLLOWERING_H
+
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+
+namespace llvm {
+
+class AAPTargetLowering;
+
+class AAPCallLowering : public CallLowering {
+public:
+  AAPCallLowering(const AAPTargetLowering &TLI);
+
+  bool lowerReturn(MachineIRBuilder &MIRBuilder, const Value *Val,
+                   ArrayRef<unsigned> VRegs) const override;
+
+  bool lowerFormalArguments(MachineIRBuilder &MIRBuilder, const Function &F,
+                            ArrayRef<unsigned> VRegs) const override;
+
+  bool lowerCall(MachineIRBuilder &MIRBuilder, CallingConv::ID CallConv,
+                 const MachineOperand &Callee, const ArgInfo &OrigRet,
+                 ArrayRef<ArgInfo> OrigArgs) const override;
+
+private:
+  /// Replace the type of an argument with the integer type the calling
+  /// convention assigns locations for. Returns false if the argument does not
+  /// fit in a single register, such values are left to SelectionDAG.
+  bool getValueTypeArg(const ArgInfo &OrigArg, ArgInfo &Arg,
+                       const DataLayout &DL) const;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_AAP_AAPCALLLOWERING_H
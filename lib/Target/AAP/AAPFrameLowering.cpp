@@ -14,10 +14,16 @@
 #include "AAPFrameLowering.h"
 #include "AAPInstrInfo.h"
 #include "AAPMachineFunctionInfo.h"
+#include "AAPSubtarget.h"
 #include "MCTargetDesc/AAPMCTargetDesc.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
+#include "llvm/CodeGen/MachineDominators.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/RegisterScavenging.h"
 #include "llvm/Target/TargetMachine.h"
@@ -28,7 +34,8 @@ bool AAPFrameLowering::hasFP(const MachineFunction &MF) const {
   const MachineFrameInfo &MFI = MF.getFrameInfo();
   return MF.getTarget().Options.DisableFramePointerElim(MF) ||
          MF.getSubtarget().getRegisterInfo()->needsStackRealignment(MF) ||
-         MFI.hasVarSizedObjects() || MFI.isFrameAddressTaken();
+         MFI.hasVarSizedObjects() || MFI.isFrameAddressTaken() ||
+         MF.getInfo<AAPMachineFunctionInfo>()->isLargeFrame();
 }
 
 void AAPFrameLowering::determineCalleeSaves(MachineFunction &MF,
@@ -38,6 +45,11 @@ void AAPFrameLowering::determineCalleeSaves(MachineFunction &MF,
 
   MachineFrameInfo &MFI = MF.getFrameInfo();
 
+  // Calls overwrite the link register, so it must be saved even when IPRA
+  // allows the function to clobber its callee saved registers.
+  if (MF.getRegInfo().isPhysRegModified(AAP::R0))
+    SavedRegs.set(AAP::R0);
+
   // Unconditionally spill RA and FP only if the function uses a frame
   // pointer.
   if (hasFP(MF)) {
@@ -48,8 +60,10 @@ void AAPFrameLowering::determineCalleeSaves(MachineFunction &MF,
   // Reserve emergency stack spill slots for RegScavenger if the stack frame
   // might require virtual registers for addressing. If the stack frame has
   // variable sized objects, we don't know in advance whether emergency spill
-  // slots are needed so assume that they are.
-  if (!isInt<9>(MFI.estimateStackSize(MF)) || MFI.hasVarSizedObjects()) {
+  // slots are needed so assume that they are. The RegUsageInfoCollector used
+  // by IPRA calls this without a scavenger, and must not create the slots.
+  if (RS &&
+      (!isInt<9>(MFI.estimateStackSize(MF)) || MFI.hasVarSizedObjects())) {
     const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
     const TargetRegisterClass &RC = AAP::GR64RegClass;
     unsigned Size = TRI->getSpillSize(RC);
@@ -59,22 +73,212 @@ void AAPFrameLowering::determineCalleeSaves(MachineFunction &MF,
   }
 }
 
-const TargetFrameLowering::SpillSlot *
-AAPFrameLowering::getCalleeSavedSpillSlots(unsigned &NumEntries) const {
-  // Ensure that the frame pointer is stored at a constant stack offset.
-  NumEntries = 2;
-  static const SpillSlot Offsets[] = {
-      {AAP::R0, -2}, {AAPRegisterInfo::getFramePtrRegister(), -4}};
-  return Offsets;
+// The callee saved registers which the shared save and restore routines
+// handle, in the order in which they are pushed. __aap_save_N pushes the first
+// N of these and __aap_restore_N pops them again, each returning through R10.
+// The return value registers come last, as they are the least likely to need
+// saving in a function which returns a value. This order is part of the
+// runtime ABI, see FeatureSaveRestore.
+static const MCPhysReg SaveRestoreRegs[] = {
+    AAP::R0, AAP::R8,  AAP::R7,  AAP::R6,  AAP::R5,  AAP::R4, AAP::R3,
+    AAP::R2, AAP::R9, AAP::R11, AAP::R12, AAP::R14, AAP::R15};
+
+static const char *const SaveLibCalls[] = {
+    nullptr,         nullptr,         nullptr,          "__aap_save_3",
+    "__aap_save_4",  "__aap_save_5",  "__aap_save_6",   "__aap_save_7",
+    "__aap_save_8",  "__aap_save_9",  "__aap_save_10",  "__aap_save_11",
+    "__aap_save_12", "__aap_save_13"};
+
+static const char *const RestoreLibCalls[] = {
+    nullptr,            nullptr,            nullptr,
+    "__aap_restore_3",  "__aap_restore_4",  "__aap_restore_5",
+    "__aap_restore_6",  "__aap_restore_7",  "__aap_restore_8",
+    "__aap_restore_9",  "__aap_restore_10", "__aap_restore_11",
+    "__aap_restore_12", "__aap_restore_13"};
+
+// Return the number of registers to save and restore with calls to the shared
+// routines, or zero if the registers in CSI should be pushed and popped
+// inline. A call is no smaller than a pair of short pushes, so at least three
+// registers must be saved.
+static unsigned getSaveRestoreLibCallCount(const MachineFunction &MF,
+                                           ArrayRef<CalleeSavedInfo> CSI) {
+  if (!MF.getSubtarget<AAPSubtarget>().enableSaveRestore() ||
+      !MF.getFunction().optForSize())
+    return 0;
+
+  unsigned Num = 0;
+  for (const CalleeSavedInfo &CS : CSI) {
+    const MCPhysReg *I = std::find(std::begin(SaveRestoreRegs),
+                                   std::end(SaveRestoreRegs), CS.getReg());
+    if (I == std::end(SaveRestoreRegs))
+      return 0;
+    Num = std::max<unsigned>(Num, I - std::begin(SaveRestoreRegs) + 1);
+  }
+  if (Num < 3)
+    return 0;
+
+  // The routines also save and restore any registers in the prefix which are
+  // not otherwise saved. This is only safe if those are callee saved here, and
+  // so not holding a return value.
+  const MCPhysReg *CSRegs = MF.getRegInfo().getCalleeSavedRegs();
+  for (unsigned i = 0; i != Num; ++i) {
+    const MCPhysReg *R = CSRegs;
+    while (*R && *R != SaveRestoreRegs[i])
+      ++R;
+    if (!*R)
+      return 0;
+  }
+  return Num;
+}
+
+// Callee saved registers are pushed at the top of the frame, in the order of
+// CSI, so each is given a fixed slot below the previous one. The link register
+// and frame pointer are pushed first, so that they are always found at the
+// same offsets from the frame pointer.
+bool AAPFrameLowering::assignCalleeSavedSpillSlots(
+    MachineFunction &MF, const TargetRegisterInfo *TRI,
+    std::vector<CalleeSavedInfo> &CSI) const {
+  MachineFrameInfo &MFI = MF.getFrameInfo();
+  AAPMachineFunctionInfo *AFI = MF.getInfo<AAPMachineFunctionInfo>();
+  unsigned FP = AAPRegisterInfo::getFramePtrRegister();
+
+  std::stable_sort(CSI.begin(), CSI.end(),
+                   [FP](const CalleeSavedInfo &A, const CalleeSavedInfo &B) {
+                     auto Rank = [FP](unsigned Reg) {
+                       return Reg == AAP::R0 ? 0 : Reg == FP ? 1 : 2;
+                     };
+                     return Rank(A.getReg()) < Rank(B.getReg());
+                   });
+
+  unsigned NumLibCallRegs = getSaveRestoreLibCallCount(MF, CSI);
+  if (NumLibCallRegs) {
+    CSI.clear();
+    for (unsigned i = 0; i != NumLibCallRegs; ++i)
+      CSI.push_back(CalleeSavedInfo(SaveRestoreRegs[i]));
+  }
+  AFI->setSaveRestoreLibCalls(NumLibCallRegs);
+
+  int Offset = 0;
+  for (CalleeSavedInfo &CS : CSI) {
+    unsigned Size = TRI->getSpillSize(AAP::GR64RegClass);
+    Offset -= Size;
+    CS.setFrameIdx(MFI.CreateFixedSpillStackObject(Size, Offset));
+  }
+  AFI->setCalleeSavedFrameSize(-Offset);
+  return true;
+}
+
+bool AAPFrameLowering::spillCalleeSavedRegisters(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
+    const std::vector<CalleeSavedInfo> &CSI,
+    const TargetRegisterInfo *TRI) const {
+  if (CSI.empty())
+    return true;
+
+  MachineFunction &MF = *MBB.getParent();
+  const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  unsigned NumLibCallRegs =
+      MF.getInfo<AAPMachineFunctionInfo>()->getSaveRestoreLibCalls();
+  unsigned SP = AAPRegisterInfo::getStackPtrRegister();
+  DebugLoc DL = MI != MBB.end() ? MI->getDebugLoc() : DebugLoc();
+
+  // The return address must remain available to llvm.returnaddress, and
+  // arguments are passed in callee saved registers, so the spill must not
+  // kill a register which is live into the function.
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  auto IsKill = [&](unsigned Reg) {
+    return !(Reg == AAP::R0 && MFI.isReturnAddressTaken()) &&
+           !MRI.isLiveIn(Reg);
+  };
+
+  // The shared routine is called through R10, which may be live into a save
+  // point chosen by shrink-wrapping, in which case the registers are pushed
+  // inline instead. Both store the registers to the same slots.
+  if (NumLibCallRegs && !MBB.isLiveIn(AAP::R10)) {
+    MachineInstrBuilder MIB =
+        BuildMI(MBB, MI, DL, TII.get(AAP::PseudoSAVE_CSR))
+            .addExternalSymbol(SaveLibCalls[NumLibCallRegs])
+            .setMIFlag(MachineInstr::FrameSetup);
+    for (const CalleeSavedInfo &CS : CSI)
+      MIB.addReg(CS.getReg(), RegState::Implicit |
+                                  getKillRegState(IsKill(CS.getReg())));
+    return true;
+  }
+
+  for (const CalleeSavedInfo &CS : CSI) {
+    unsigned Reg = CS.getReg();
+    MachineMemOperand *MMO = MF.getMachineMemOperand(
+        MachinePointerInfo::getFixedStack(MF, CS.getFrameIdx()),
+        MachineMemOperand::MOStore, MFI.getObjectSize(CS.getFrameIdx()),
+        MFI.getObjectAlignment(CS.getFrameIdx()));
+    BuildMI(MBB, MI, DL, TII.get(AAP::STW_predec_wb), SP)
+        .addReg(SP)
+        .addImm(0)
+        .addReg(Reg, getKillRegState(IsKill(Reg)))
+        .addMemOperand(MMO)
+        .setMIFlag(MachineInstr::FrameSetup);
+  }
+  return true;
+}
+
+bool AAPFrameLowering::restoreCalleeSavedRegisters(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
+    std::vector<CalleeSavedInfo> &CSI, const TargetRegisterInfo *TRI) const {
+  if (CSI.empty())
+    return true;
+
+  MachineFunction &MF = *MBB.getParent();
+  const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  unsigned NumLibCallRegs =
+      MF.getInfo<AAPMachineFunctionInfo>()->getSaveRestoreLibCalls();
+  unsigned SP = AAPRegisterInfo::getStackPtrRegister();
+  DebugLoc DL = MI != MBB.end() ? MI->getDebugLoc() : DebugLoc();
+
+  // The target of an indirect tail call, or a value live out of a restore
+  // point chosen by shrink-wrapping, may be held in R10.
+  if (NumLibCallRegs) {
+    LivePhysRegs LiveRegs(*TRI);
+    LiveRegs.addLiveOuts(MBB);
+    for (auto I = MBB.end(); I != MI;)
+      LiveRegs.stepBackward(*--I);
+
+    if (LiveRegs.available(MF.getRegInfo(), AAP::R10)) {
+      MachineInstrBuilder MIB =
+          BuildMI(MBB, MI, DL, TII.get(AAP::PseudoRESTORE_CSR))
+              .addExternalSymbol(RestoreLibCalls[NumLibCallRegs])
+              .setMIFlag(MachineInstr::FrameDestroy);
+      for (const CalleeSavedInfo &CS : CSI)
+        MIB.addReg(CS.getReg(), RegState::ImplicitDefine);
+      return true;
+    }
+  }
+
+  for (const CalleeSavedInfo &CS : reverse(CSI)) {
+    MachineMemOperand *MMO = MF.getMachineMemOperand(
+        MachinePointerInfo::getFixedStack(MF, CS.getFrameIdx()),
+        MachineMemOperand::MOLoad, MFI.getObjectSize(CS.getFrameIdx()),
+        MFI.getObjectAlignment(CS.getFrameIdx()));
+    BuildMI(MBB, MI, DL, TII.get(AAP::LDW_postinc_wb), CS.getReg())
+        .addReg(SP, RegState::Define)
+        .addReg(SP)
+        .addImm(0)
+        .addMemOperand(MMO)
+        .setMIFlag(MachineInstr::FrameDestroy);
+  }
+  return true;
 }
 
 int AAPFrameLowering::getFrameIndexReference(const MachineFunction &MF, int FI,
                                              unsigned &FrameReg) const {
   const MachineFrameInfo &MFrameInfo = MF.getFrameInfo();
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
 
   // Determine the offset to the start of the frame.
   int Offset = MFrameInfo.getObjectOffset(FI) - getOffsetOfLocalArea() +
                MFrameInfo.getOffsetAdjustment();
+  int SPOffset = Offset + MFrameInfo.getStackSize();
 
   // Determine whether to use the frame pointer. The logic is kept as a set of
   // if statements for clarity.
@@ -82,19 +286,15 @@ int AAPFrameLowering::getFrameIndexReference(const MachineFunction &MF, int FI,
   if (hasFP(MF)) {
     // For callee saved registers the stack pointer must be used.
 
+    // The callee saved registers are pushed into fixed slots, which are not
+    // necessarily a contiguous range of frame indices.
     const std::vector<CalleeSavedInfo> &CSI = MFrameInfo.getCalleeSavedInfo();
-    int MinCSFI = 0;
-    int MaxCSFI = -1;
-    for (auto &CS : CSI) {
-      int CSFI = CS.getFrameIdx();
-      if (CSFI < MinCSFI)
-        MinCSFI = CSFI;
-      if (CSFI > MaxCSFI)
-        MaxCSFI = CSFI;
-    }
+    bool IsCalleeSavedSlot = any_of(CSI, [FI](const CalleeSavedInfo &CS) {
+      return CS.getFrameIdx() == FI;
+    });
 
     // Not a callee saved register:
-    if (FI < MinCSFI || FI > MaxCSFI) {
+    if (!IsCalleeSavedSlot) {
 
       // If the offset is to a fixed stack object, the frame pointer should be
       // used.
@@ -110,12 +310,21 @@ int AAPFrameLowering::getFrameIndexReference(const MachineFunction &MF, int FI,
       // is within a safe range.
       if (Offset >= -512)
         UseFP = true;
+
+      // The frame pointer is not one of the registers which short loads and
+      // stores can use as a base, so when the stack pointer is at a known
+      // offset from the object and that offset fits the short form, use the
+      // stack pointer instead. orderFrameObjects places the most frequently
+      // accessed objects there.
+      if (!MFrameInfo.hasVarSizedObjects() && !TRI->needsStackRealignment(MF) &&
+          isInt<3>(SPOffset))
+        UseFP = false;
     }
   }
 
   if (!UseFP) {
     FrameReg = AAPRegisterInfo::getStackPtrRegister();
-    Offset += MFrameInfo.getStackSize();
+    Offset = SPOffset;
   } else
     FrameReg = AAPRegisterInfo::getFramePtrRegister();
 
@@ -126,6 +335,74 @@ int AAPFrameLowering::getFrameIndexReference(const MachineFunction &MF, int FI,
   return Offset;
 }
 
+namespace {
+// The access weight of a stack object, used to order the objects so that the
+// most frequently accessed are allocated nearest the stack pointer.
+struct AAPFrameObject {
+  int FI;
+  uint64_t Weight;
+  uint64_t Size;
+};
+} // end anonymous namespace
+
+// Order the local stack objects by the estimated frequency with which they are
+// accessed per byte. Objects are allocated downwards from the top of the frame
+// in the order given, so those at the end of the list end up nearest the stack
+// pointer. Loads and stores from the stack pointer with an offset that fits in
+// 3 bits can use the short encodings, and those within 10 bits can be done
+// without a scavenged base register.
+void AAPFrameLowering::orderFrameObjects(
+    const MachineFunction &MF, SmallVectorImpl<int> &ObjectsToAllocate) const {
+  if (ObjectsToAllocate.size() < 2)
+    return;
+
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+
+  // Block frequencies are not available to the prologue/epilogue inserter, so
+  // compute them here in the same way as the lazy block frequency analysis.
+  MachineDominatorTree MDT;
+  MDT.getBase().recalculate(const_cast<MachineFunction &>(MF));
+  MachineLoopInfo MLI;
+  MLI.getBase().analyze(MDT.getBase());
+  MachineBranchProbabilityInfo MBPI;
+  MachineBlockFrequencyInfo MBFI;
+  MBFI.calculate(MF, MBPI, MLI);
+
+  std::vector<uint64_t> Weights(MFI.getObjectIndexEnd());
+  for (const MachineBasicBlock &MBB : MF) {
+    uint64_t Freq = MBFI.getBlockFreq(&MBB).getFrequency();
+    for (const MachineInstr &MI : MBB) {
+      if (MI.isDebugInstr())
+        continue;
+      for (const MachineOperand &MO : MI.operands()) {
+        if (!MO.isFI() || MO.getIndex() < 0)
+          continue;
+        uint64_t &Weight = Weights[MO.getIndex()];
+        Weight = SaturatingAdd(Weight, Freq);
+      }
+    }
+  }
+
+  SmallVector<AAPFrameObject, 16> Objects;
+  for (int FI : ObjectsToAllocate) {
+    // Treat variable sized objects as a single word.
+    uint64_t Size = MFI.getObjectSize(FI);
+    Objects.push_back({FI, Weights[FI], Size ? Size : 2});
+  }
+
+  // Compare the weight per byte of each object, scaling each side by the size
+  // of the other to avoid division. Objects of equal density keep their
+  // original order.
+  std::stable_sort(Objects.begin(), Objects.end(),
+                   [](const AAPFrameObject &A, const AAPFrameObject &B) {
+                     return SaturatingMultiply(A.Weight, B.Size) <
+                            SaturatingMultiply(B.Weight, A.Size);
+                   });
+
+  for (unsigned i = 0, e = Objects.size(); i != e; ++i)
+    ObjectsToAllocate[i] = Objects[i].FI;
+}
+
 // Ensure that for varargs, the size of the caller reserved frame is taken into
 // account when calculating stack offset.
 bool AAPFrameLowering::hasReservedCallFrame(const MachineFunction &MF) const {
@@ -160,68 +437,78 @@ MachineBasicBlock::iterator AAPFrameLowering::eliminateCallFramePseudoInstr(
 void AAPFrameLowering::emitPrologue(MachineFunction &MF,
                                     MachineBasicBlock &MBB) const {
   const MachineFrameInfo &MFrameInfo = MF.getFrameInfo();
+  AAPMachineFunctionInfo *AFI = MF.getInfo<AAPMachineFunctionInfo>();
 
+  // When shrink-wrapping, the prologue may be placed in a block other than the
+  // entry, and the link register is not known to be free outside of it.
+  AFI->setShrinkWrapped(MFrameInfo.getSavePoint() != nullptr);
+
+  // The callee saved registers have already been pushed at the start of the
+  // block, so the frame is set up after them.
   MachineBasicBlock::iterator MBBI = MBB.begin();
+  while (MBBI != MBB.end() && MBBI->getFlag(MachineInstr::FrameSetup))
+    ++MBBI;
   DebugLoc DL = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
   unsigned SP = AAPRegisterInfo::getStackPtrRegister();
 
-  // Get the number of bytes to allocate from the FrameInfo.
+  // Get the number of bytes to allocate from the FrameInfo, less those already
+  // allocated by pushing the callee saved registers.
   const uint64_t StackSize = MFrameInfo.getStackSize();
+  const uint64_t CSSize = AFI->getCalleeSavedFrameSize();
 
-  // Adjust the stack pointer down by the number of bytes needed.
-  AAPRegisterInfo::adjustReg(MBB, MBBI, DL, SP, SP, -StackSize,
-                             MachineInstr::FrameSetup);
-
-  if (!hasFP(MF))
-    return;
-
-  unsigned FP = AAPRegisterInfo::getFramePtrRegister();
-
-  // To ensure that the previous state of the frame pointer remains available to
-  // be restored, the frame pointer adjustment must be done after the callee
-  // saved registers are spilled to the stack, since the frame pointer is a
-  // callee saved register.
-  std::advance(MBBI, MFrameInfo.getCalleeSavedInfo().size());
-
+  // The frame pointer is set to the value of the stack pointer on entry. The
+  // previous frame pointer has been pushed, so it may be overwritten here.
+  //
   // NOTE: If AAP did not pass all varargs on the stack, the restore adjustment
   // would need to take into account the size of the varargs stored off the
   // stack to remain accurate.
-  AAPRegisterInfo::adjustReg(MBB, MBBI, DL, FP, SP, StackSize,
+  if (hasFP(MF))
+    AAPRegisterInfo::adjustReg(MBB, MBBI, DL,
+                               AAPRegisterInfo::getFramePtrRegister(), SP,
+                               CSSize, MachineInstr::FrameSetup);
+
+  // Adjust the stack pointer down by the number of bytes needed.
+  AAPRegisterInfo::adjustReg(MBB, MBBI, DL, SP, SP, -(StackSize - CSSize),
                              MachineInstr::FrameSetup);
 }
 
 void AAPFrameLowering::emitEpilogue(MachineFunction &MF,
                                     MachineBasicBlock &MBB) const {
   const MachineFrameInfo &MFrameInfo = MF.getFrameInfo();
-
-  MachineBasicBlock::iterator MBBI = MBB.getLastNonDebugInstr();
-  assert((MBBI->getDesc().isReturn()) &&
-         "Epilogue can only be inserted in returning blocks");
+  const AAPMachineFunctionInfo *AFI = MF.getInfo<AAPMachineFunctionInfo>();
+
+  // The epilogue is inserted before the callee saved registers are popped,
+  // which is immediately before the terminators of the block. This is the
+  // return or the branch of a tail call, or when shrink-wrapping, a branch
+  // towards the return. The target of an indirect tail call is held in a
+  // register which is not restored, so the same sequence is used in all cases.
+  MachineBasicBlock::iterator MBBI = MBB.getFirstTerminator();
+  while (MBBI != MBB.begin() &&
+         std::prev(MBBI)->getFlag(MachineInstr::FrameDestroy))
+    --MBBI;
   DebugLoc DL = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
   unsigned SP = AAPRegisterInfo::getStackPtrRegister();
 
-  // Get the number of bytes to deallocate from the FrameInfo
+  // Get the number of bytes to deallocate from the FrameInfo, less those
+  // deallocated by popping the callee saved registers.
   const uint64_t StackSize = MFrameInfo.getStackSize();
+  const uint64_t CSSize = AFI->getCalleeSavedFrameSize();
 
   if (MFrameInfo.hasVarSizedObjects() ||
       MF.getSubtarget().getRegisterInfo()->needsStackRealignment(MF)) {
-    unsigned FP = AAPRegisterInfo::getFramePtrRegister();
-
-    // To ensure that the state of the stack pointer can be restored to the
-    // current state of the frame pointer, the adjustment must be done before
-    // the callee saved registers are restored from the stack, since the frame
-    // pointer is a callee saved register.
-    MachineBasicBlock::iterator PreRestore = MBBI;
-    std::advance(PreRestore, -MFrameInfo.getCalleeSavedInfo().size());
-
+    // The stack pointer is at an unknown offset from the frame, so is restored
+    // from the frame pointer, which is not popped until after this.
+    //
     // NOTE: If AAP did not pass all varargs on the stack, the restore
-    // adjustment would need to take into account the size of the varargs stored
-    // off the stack to remain accurate.
-    AAPRegisterInfo::adjustReg(MBB, PreRestore, DL, SP, FP, -StackSize,
+    // adjustment would need to take into account the size of the varargs
+    // stored off the stack to remain accurate.
+    AAPRegisterInfo::adjustReg(MBB, MBBI, DL, SP,
+                               AAPRegisterInfo::getFramePtrRegister(), -CSSize,
                                MachineInstr::FrameDestroy);
+    return;
   }
 
   // Adjust the stack pointer up by the number of bytes needed.
-  AAPRegisterInfo::adjustReg(MBB, MBBI, DL, SP, SP, StackSize,
+  AAPRegisterInfo::adjustReg(MBB, MBBI, DL, SP, SP, StackSize - CSSize,
                              MachineInstr::FrameDestroy);
 }
@@ -14,6 +14,7 @@
 #include "AAP.h"
 #include "AAPISelLowering.h"
 #include "AAPTargetMachine.h"
+#include "AAPTargetObjectFile.h"
 #include "MCTargetDesc/AAPMCTargetDesc.h"
 #include "llvm/CodeGen/SelectionDAGISel.h"
 #include "llvm/Support/Debug.h"
@@ -41,6 +42,11 @@ public:
     return "AAP DAG->DAG Pattern Instruction Selection";
   }
 
+  bool runOnMachineFunction(MachineFunction &MF) override {
+    Subtarget = &MF.getSubtarget<AAPSubtarget>();
+    return SelectionDAGISel::runOnMachineFunction(MF);
+  }
+
   void Select(SDNode *N) override;
 
   bool SelectInlineAsmMemoryOperand(const SDValue &Op, unsigned ConstraintID,
@@ -48,7 +54,13 @@ public:
 
 #include "AAPGenDAGISel.inc"
 private:
+  const AAPSubtarget *Subtarget = nullptr;
+
+  bool tryIndexedLoad(SDNode *N);
+  bool tryIndexedStore(SDNode *N);
+
   bool SelectAddr(SDValue Addr, SDValue &Base, SDValue &Offset);
+  bool SelectSmallDataAddr(SDValue Addr, SDValue &Base, SDValue &Offset);
   bool SelectAddr_MO3(SDValue Addr, SDValue &Base, SDValue &Offset);
   bool SelectAddr_MO10(SDValue Addr, SDValue &Base, SDValue &Offset);
 };
@@ -83,12 +95,80 @@ void AAPISelDAGToDAG::Select(SDNode *Node) {
     ReplaceNode(Node, N);
     return;
   }
+  case ISD::LOAD:
+    if (tryIndexedLoad(Node))
+      return;
+    break;
+  case ISD::STORE:
+    if (tryIndexedStore(Node))
+      return;
+    break;
   }
 
   // Select the default instruction
   SelectCode(Node);
 }
 
+// Select pre-decrement and post-increment loads. The base register is
+// adjusted by the size of the access, which has already been checked when
+// the indexed node was formed, so the offset field is always zero.
+bool AAPISelDAGToDAG::tryIndexedLoad(SDNode *N) {
+  LoadSDNode *LD = cast<LoadSDNode>(N);
+  ISD::MemIndexedMode AM = LD->getAddressingMode();
+  if (AM == ISD::UNINDEXED || LD->getExtensionType() == ISD::SEXTLOAD)
+    return false;
+
+  unsigned Opcode;
+  switch (LD->getMemoryVT().getSimpleVT().SimpleTy) {
+  case MVT::i8:
+    Opcode = AM == ISD::POST_INC ? AAP::LDB_postinc_wb : AAP::LDB_predec_wb;
+    break;
+  case MVT::i16:
+    Opcode = AM == ISD::POST_INC ? AAP::LDW_postinc_wb : AAP::LDW_predec_wb;
+    break;
+  default:
+    return false;
+  }
+
+  SDLoc Loc(N);
+  SDValue Offset = CurDAG->getTargetConstant(0, Loc, MVT::i16);
+  MachineSDNode *Res =
+      CurDAG->getMachineNode(Opcode, Loc, MVT::i16, MVT::i16, MVT::Other,
+                             LD->getBasePtr(), Offset, LD->getChain());
+  CurDAG->setNodeMemRefs(Res, {LD->getMemOperand()});
+  ReplaceNode(N, Res);
+  return true;
+}
+
+// Select pre-decrement and post-increment stores, see tryIndexedLoad.
+bool AAPISelDAGToDAG::tryIndexedStore(SDNode *N) {
+  StoreSDNode *ST = cast<StoreSDNode>(N);
+  ISD::MemIndexedMode AM = ST->getAddressingMode();
+  if (AM == ISD::UNINDEXED)
+    return false;
+
+  unsigned Opcode;
+  switch (ST->getMemoryVT().getSimpleVT().SimpleTy) {
+  case MVT::i8:
+    Opcode = AM == ISD::POST_INC ? AAP::STB_postinc_wb : AAP::STB_predec_wb;
+    break;
+  case MVT::i16:
+    Opcode = AM == ISD::POST_INC ? AAP::STW_postinc_wb : AAP::STW_predec_wb;
+    break;
+  default:
+    return false;
+  }
+
+  SDLoc Loc(N);
+  SDValue Offset = CurDAG->getTargetConstant(0, Loc, MVT::i16);
+  SDValue Ops[] = {ST->getBasePtr(), Offset, ST->getValue(), ST->getChain()};
+  MachineSDNode *Res =
+      CurDAG->getMachineNode(Opcode, Loc, MVT::i16, MVT::Other, Ops);
+  CurDAG->setNodeMemRefs(Res, {ST->getMemOperand()});
+  ReplaceNode(N, Res);
+  return true;
+}
+
 bool AAPISelDAGToDAG::SelectInlineAsmMemoryOperand(
     const SDValue &Op, unsigned ConstraintID, std::vector<SDValue> &OutOps) {
   switch (ConstraintID) {
@@ -153,9 +233,42 @@ bool AAPISelDAGToDAG::SelectAddr(SDValue Addr, SDValue &Base, SDValue &Offset) {
   return true;
 }
 
+// Select the address of a global in a small data section as an offset from
+// the global pointer, which the linker resolves.
+bool AAPISelDAGToDAG::SelectSmallDataAddr(SDValue Addr, SDValue &Base,
+                                          SDValue &Offset) {
+  int64_t Disp = 0;
+  if (CurDAG->isBaseWithConstantOffset(Addr)) {
+    Disp = cast<ConstantSDNode>(Addr.getOperand(1))->getSExtValue();
+    Addr = Addr.getOperand(0);
+  }
+
+  if (Addr.getOpcode() != AAPISD::Wrapper)
+    return false;
+  auto *GA = dyn_cast<GlobalAddressSDNode>(Addr.getOperand(0));
+  if (!GA)
+    return false;
+
+  const auto &TLOF =
+      static_cast<const AAPTargetObjectFile &>(*TM.getObjFileLowering());
+  const GlobalObject *GO = dyn_cast<GlobalObject>(GA->getGlobal());
+  if (!GO || !TLOF.isGlobalInSmallSection(GO, TM))
+    return false;
+
+  Base = CurDAG->getRegister(AAPRegisterInfo::getGlobalPtrRegister(), MVT::i16);
+  Offset = CurDAG->getTargetGlobalAddress(GA->getGlobal(), SDLoc(Addr),
+                                          MVT::i16, GA->getOffset() + Disp,
+                                          AAPII::MO_GPREL);
+  return true;
+}
+
 bool AAPISelDAGToDAG::SelectAddr_MO3(SDValue Addr, SDValue &Base,
                                      SDValue &Offset) {
   SDValue B, O;
+  // Small data needs a 10-bit offset field to hold its relocation
+  if (SelectSmallDataAddr(Addr, B, O))
+    return false;
+
   if (!SelectAddr(Addr, B, O))
     return false;
 
@@ -171,6 +284,9 @@ bool AAPISelDAGToDAG::SelectAddr_MO3(SDValue Addr, SDValue &Base,
 
 bool AAPISelDAGToDAG::SelectAddr_MO10(SDValue Addr, SDValue &Base,
                                       SDValue &Offset) {
+  if (SelectSmallDataAddr(Addr, Base, Offset))
+    return true;
+
   SDValue B, O;
   if (!SelectAddr(Addr, B, O))
     return false;
@@ -17,14 +17,33 @@
 #include "AAPRegisterInfo.h"
 #include "AAPSubtarget.h"
 #include "MCTargetDesc/AAPMCTargetDesc.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
 
 #define DEBUG_TYPE "aap-lower"
 
 using namespace llvm;
 
+STATISTIC(NumTailCalls, "Number of tail calls");
+
+static cl::opt<unsigned> MulConstMaxOps(
+    "aap-mul-const-max-ops", cl::Hidden, cl::init(8),
+    cl::desc("Maximum number of instructions used to multiply by a constant "
+             "instead of calling the runtime library"));
+
+static cl::opt<unsigned> DivConstMaxOps(
+    "aap-div-const-max-ops", cl::Hidden, cl::init(40),
+    cl::desc("Maximum number of instructions used to multiply by the magic "
+             "number when dividing by a constant instead of calling the "
+             "runtime library"));
+
+static cl::opt<unsigned> MinimumJumpTableEntries(
+    "aap-min-jump-table-entries", cl::Hidden, cl::init(8),
+    cl::desc("Minimum number of cases for a switch to use a jump table"));
+
 AAPTargetLowering::AAPTargetLowering(const TargetMachine &TM,
                                      const AAPSubtarget &STI)
     : TargetLowering(TM), STI(STI) {
@@ -61,20 +80,22 @@ AAPTargetLowering::AAPTargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i1, Expand);
   setOperationAction(ISD::SIGN_EXTEND_INREG, MVT::i8, Expand);
 
-  // Division operations unsupported by the architecture
-  setOperationAction(ISD::SDIV, MVT::i16, Expand);
-  setOperationAction(ISD::UDIV, MVT::i16, Expand);
+  // Division is only available with the hardware divider, remainders are
+  // always computed from the quotient.
+  setOperationAction(ISD::SDIV, MVT::i16, STI.hasDiv() ? Legal : Expand);
+  setOperationAction(ISD::UDIV, MVT::i16, STI.hasDiv() ? Legal : Expand);
   setOperationAction(ISD::SREM, MVT::i16, Expand);
   setOperationAction(ISD::UREM, MVT::i16, Expand);
   setOperationAction(ISD::SDIVREM, MVT::i16, Expand);
   setOperationAction(ISD::UDIVREM, MVT::i16, Expand);
 
-  // Multiplication operations unsupported by the architecture
-  setOperationAction(ISD::MUL, MVT::i16, Expand);
+  // Multiplication is only available with the hardware multiplier, which
+  // produces the low and high halves of the product separately.
+  setOperationAction(ISD::MUL, MVT::i16, STI.hasMul() ? Legal : Expand);
   setOperationAction(ISD::SMUL_LOHI, MVT::i16, Expand);
   setOperationAction(ISD::UMUL_LOHI, MVT::i16, Expand);
-  setOperationAction(ISD::MULHS, MVT::i16, Expand);
-  setOperationAction(ISD::MULHU, MVT::i16, Expand);
+  setOperationAction(ISD::MULHS, MVT::i16, STI.hasMul() ? Legal : Expand);
+  setOperationAction(ISD::MULHU, MVT::i16, STI.hasMul() ? Legal : Expand);
   setOperationAction(ISD::SMULO, MVT::i16, Expand);
   setOperationAction(ISD::UMULO, MVT::i16, Expand);
 
@@ -113,14 +134,31 @@ AAPTargetLowering::AAPTargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::SELECT_CC, MVT::i16, Custom);
   setOperationAction(ISD::BR_CC, MVT::i16, Custom);
 
+  // Compare i32 values with a carry chain rather than the default expansion,
+  // which branches on each half, see lowerI32Compare.
+  setOperationAction(ISD::SETCC, MVT::i32, Custom);
+  setOperationAction(ISD::SELECT_CC, MVT::i32, Custom);
+  setOperationAction(ISD::BR_CC, MVT::i32, Custom);
+
   // Expand some condition codes which are not natively supported
   setCondCodeAction(ISD::SETGT, MVT::i16, Expand);
   setCondCodeAction(ISD::SETGE, MVT::i16, Expand);
   setCondCodeAction(ISD::SETUGT, MVT::i16, Expand);
   setCondCodeAction(ISD::SETUGE, MVT::i16, Expand);
 
-  // BR_JT unsupported by the architecture
+  // Loads and stores can pre-decrement or post-increment their base register
+  // by the size of the access
+  for (MVT VT : {MVT::i8, MVT::i16}) {
+    setIndexedLoadAction(ISD::PRE_DEC, VT, Legal);
+    setIndexedLoadAction(ISD::POST_INC, VT, Legal);
+    setIndexedStoreAction(ISD::PRE_DEC, VT, Legal);
+    setIndexedStoreAction(ISD::POST_INC, VT, Legal);
+  }
+
+  // Jump tables are expanded to a load from a table of block addresses
+  // followed by an indirect jump
   setOperationAction(ISD::BR_JT, MVT::Other, Expand);
+  setOperationAction(ISD::JumpTable, MVT::i16, Custom);
 
   // Handle varargs through VASTART
   setOperationAction(ISD::VASTART, MVT::Other, Custom);
@@ -135,9 +173,22 @@ AAPTargetLowering::AAPTargetLowering(const TargetMachine &TM,
 
   // Custom DAGCombine
   setTargetDAGCombine(ISD::ADD);
-
-  // No support for jump tables
-  setMinimumJumpTableEntries(INT_MAX);
+  setTargetDAGCombine(ISD::MUL);
+  setTargetDAGCombine(ISD::SDIV);
+  setTargetDAGCombine(ISD::UDIV);
+  setTargetDAGCombine(ISD::SREM);
+  setTargetDAGCombine(ISD::UREM);
+
+  // Dispatching through a jump table costs a bounds check, the address
+  // calculation, a load and an indirect jump. Below this many cases a tree of
+  // compares and branches is cheaper.
+  setMinimumJumpTableEntries(MinimumJumpTableEntries);
+
+  // Copies and sets of up to this many words are unrolled, anything larger
+  // is a loop emitted by AAPSelectionDAGInfo.
+  MaxStoresPerMemcpy = MaxStoresPerMemset = MaxStoresPerMemmove = 8;
+  MaxStoresPerMemcpyOptSize = MaxStoresPerMemsetOptSize =
+      MaxStoresPerMemmoveOptSize = 4;
 }
 
 const char *AAPTargetLowering::getTargetNodeName(unsigned Opcode) const {
@@ -148,10 +199,16 @@ const char *AAPTargetLowering::getTargetNodeName(unsigned Opcode) const {
     return "AAPISD::RET_FLAG";
   case AAPISD::CALL:
     return "AAPISD::CALL";
+  case AAPISD::TAIL_CALL:
+    return "AAPISD::TAIL_CALL";
   case AAPISD::Wrapper:
     return "AAPISD::Wrapper";
   case AAPISD::SELECT_CC:
     return "AAPISD::SELECT_CC";
+  case AAPISD::MEMCPY_LOOP:
+    return "AAPISD::MEMCPY_LOOP";
+  case AAPISD::MEMSET_LOOP:
+    return "AAPISD::MEMSET_LOOP";
   }
 }
 
@@ -171,10 +228,14 @@ SDValue AAPTargetLowering::LowerOperation(SDValue Op, SelectionDAG &DAG) const {
     return LowerBlockAddress(Op, DAG);
   case ISD::ConstantPool:
     return LowerConstantPool(Op, DAG);
+  case ISD::JumpTable:
+    return LowerJumpTable(Op, DAG);
   case ISD::SELECT_CC:
     return LowerSELECT_CC(Op, DAG);
   case ISD::BR_CC:
     return LowerBR_CC(Op, DAG);
+  case ISD::SETCC:
+    return LowerSETCC(Op, DAG);
   case ISD::VASTART:
     return LowerVASTART(Op, DAG);
   case ISD::FRAMEADDR:
@@ -226,6 +287,14 @@ SDValue AAPTargetLowering::LowerConstantPool(SDValue Op,
   return DAG.getNode(AAPISD::Wrapper, SDLoc(Op), Ty, Result);
 }
 
+SDValue AAPTargetLowering::LowerJumpTable(SDValue Op, SelectionDAG &DAG) const {
+  EVT Ty = getPointerTy(DAG.getDataLayout());
+  JumpTableSDNode *JT = cast<JumpTableSDNode>(Op);
+
+  SDValue Result = DAG.getTargetJumpTable(JT->getIndex(), Ty);
+  return DAG.getNode(AAPISD::Wrapper, SDLoc(Op), Ty, Result);
+}
+
 // Get the AAP specific condition code for a given CondCode DAG node.
 static AAPCC::CondCode getAAPCondCode(ISD::CondCode CC) {
   switch (CC) {
@@ -248,6 +317,115 @@ static AAPCC::CondCode getAAPCondCode(ISD::CondCode CC) {
   }
 }
 
+// Return the carry out of adding the i16 values LHS and RHS, as 0 or 1.
+static SDValue getCarryOut(SelectionDAG &DAG, const SDLoc &DL, SDValue LHS,
+                           SDValue RHS, SDValue CarryIn = SDValue()) {
+  SDVTList VTs = DAG.getVTList(MVT::i16, MVT::Glue);
+  SDValue Sum = CarryIn ? DAG.getNode(ISD::ADDE, DL, VTs, LHS, RHS, CarryIn)
+                        : DAG.getNode(ISD::ADDC, DL, VTs, LHS, RHS);
+  SDValue Zero = DAG.getConstant(0, DL, MVT::i16);
+  return DAG.getNode(ISD::ADDE, DL, VTs, Zero, Zero, Sum.getValue(1));
+}
+
+// Lower a comparison of two i32 values to an i16 value, which is non-zero
+// exactly when the comparison holds, or when Invert is set, exactly when it
+// does not. No branches are needed:
+//
+// - Equality compares the OR of the XOR of each half with zero.
+// - A >u B exactly when A + ~B carries out of the high half, so the ordered
+//   comparisons are a 32-bit add of the halves with ADDC/ADDE, and an ADDE
+//   to materialize the carry. The operands are swapped for A <u B, and the
+//   result inverted for the non-strict comparisons.
+// - Signed comparisons flip the sign bits first, except that a comparison
+//   with zero only needs the sign bit of the high half.
+static SDValue lowerI32Compare(SelectionDAG &DAG, const SDLoc &DL, SDValue LHS,
+                               SDValue RHS, ISD::CondCode CC, bool &Invert) {
+  auto Half = [&](SDValue V, unsigned Part) {
+    return DAG.getNode(ISD::EXTRACT_ELEMENT, DL, MVT::i16, V,
+                       DAG.getIntPtrConstant(Part, DL));
+  };
+  Invert = false;
+
+  switch (CC) {
+  default:
+    llvm_unreachable("Unhandled condition code for i32 comparison");
+  case ISD::SETEQ:
+  case ISD::SETNE:
+    Invert = CC == ISD::SETEQ;
+    return DAG.getNode(
+        ISD::OR, DL, MVT::i16,
+        DAG.getNode(ISD::XOR, DL, MVT::i16, Half(LHS, 0), Half(RHS, 0)),
+        DAG.getNode(ISD::XOR, DL, MVT::i16, Half(LHS, 1), Half(RHS, 1)));
+  case ISD::SETLT:
+  case ISD::SETGE:
+    if (isNullConstant(RHS)) {
+      Invert = CC == ISD::SETGE;
+      return DAG.getNode(ISD::SRL, DL, MVT::i16, Half(LHS, 1),
+                         DAG.getConstant(15, DL, MVT::i16));
+    }
+    break;
+  case ISD::SETGT:
+  case ISD::SETLE:
+  case ISD::SETUGT:
+  case ISD::SETULE:
+  case ISD::SETULT:
+  case ISD::SETUGE:
+    break;
+  }
+
+  if (ISD::isSignedIntSetCC(CC)) {
+    SDValue SignBit = DAG.getConstant(0x80000000, DL, MVT::i32);
+    LHS = DAG.getNode(ISD::XOR, DL, MVT::i32, LHS, SignBit);
+    RHS = DAG.getNode(ISD::XOR, DL, MVT::i32, RHS, SignBit);
+  }
+
+  // Reduce to A >u B.
+  switch (CC) {
+  default:
+    break;
+  case ISD::SETLT:
+  case ISD::SETULT:
+    std::swap(LHS, RHS);
+    break;
+  case ISD::SETGE:
+  case ISD::SETUGE:
+    std::swap(LHS, RHS);
+    Invert = true;
+    break;
+  case ISD::SETLE:
+  case ISD::SETULE:
+    Invert = true;
+    break;
+  }
+
+  SDValue NotRHS = DAG.getNOT(DL, RHS, MVT::i32);
+  SDVTList VTs = DAG.getVTList(MVT::i16, MVT::Glue);
+  SDValue Lo = DAG.getNode(ISD::ADDC, DL, VTs, Half(LHS, 0), Half(NotRHS, 0));
+  return getCarryOut(DAG, DL, Half(LHS, 1), Half(NotRHS, 1), Lo.getValue(1));
+}
+
+SDValue AAPTargetLowering::LowerSETCC(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc Loc(Op);
+
+  SDValue LHS = Op.getOperand(0);
+  SDValue RHS = Op.getOperand(1);
+  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(2))->get();
+  assert(LHS.getValueType() == MVT::i32 && "Only i32 setcc is custom lowered");
+
+  bool Invert;
+  SDValue Res = lowerI32Compare(DAG, Loc, LHS, RHS, CC, Invert);
+
+  // Turn a non-zero value into 1, as X + 0xffff carries exactly when X is
+  // non-zero.
+  if (CC == ISD::SETEQ || CC == ISD::SETNE)
+    Res = getCarryOut(DAG, Loc, Res, DAG.getConstant(0xffff, Loc, MVT::i16));
+
+  if (Invert)
+    Res = DAG.getNode(ISD::XOR, Loc, MVT::i16, Res,
+                      DAG.getConstant(1, Loc, MVT::i16));
+  return DAG.getZExtOrTrunc(Res, Loc, Op.getValueType());
+}
+
 SDValue AAPTargetLowering::LowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const {
   SDLoc Loc(Op);
 
@@ -257,6 +435,20 @@ SDValue AAPTargetLowering::LowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const {
   SDValue FalseValue = Op.getOperand(3);
 
   ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(4))->get();
+
+  // Only a select of i16 values is lowered here. Wider selects are split
+  // into i16 selects first.
+  if (Op.getValueType() != MVT::i16)
+    return SDValue();
+
+  // An i32 comparison is reduced to a single select on an i16 value.
+  if (LHS.getValueType() == MVT::i32) {
+    bool Invert;
+    LHS = lowerI32Compare(DAG, Loc, LHS, RHS, CC, Invert);
+    RHS = DAG.getConstant(0, Loc, MVT::i16);
+    CC = Invert ? ISD::SETEQ : ISD::SETNE;
+  }
+
   // get equivalent AAP condition code
   AAPCC::CondCode TargetCC = getAAPCondCode(CC);
 
@@ -279,13 +471,21 @@ SDValue AAPTargetLowering::LowerBR_CC(SDValue Op, SelectionDAG &DAG) const {
   SDValue Chain = Op.getOperand(0);
 
   ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(1))->get();
-  // get equivalent AAP condition code
-  AAPCC::CondCode TargetCC = getAAPCondCode(CC);
-
   SDValue LHS = Op.getOperand(2);
   SDValue RHS = Op.getOperand(3);
   SDValue BranchTarget = Op.getOperand(4);
 
+  // An i32 comparison is reduced to a single branch on an i16 value.
+  if (LHS.getValueType() == MVT::i32) {
+    bool Invert;
+    LHS = lowerI32Compare(DAG, Loc, LHS, RHS, CC, Invert);
+    RHS = DAG.getConstant(0, Loc, MVT::i16);
+    CC = Invert ? ISD::SETEQ : ISD::SETNE;
+  }
+
+  // get equivalent AAP condition code
+  AAPCC::CondCode TargetCC = getAAPCondCode(CC);
+
   SDValue Ops[] = {Chain, DAG.getConstant(TargetCC, Loc, MVT::i16), LHS, RHS,
                    BranchTarget};
   return DAG.getNode(AAPISD::BR_CC, Loc, Op.getValueType(), Ops);
@@ -376,6 +576,13 @@ SDValue AAPTargetLowering::PerformDAGCombine(SDNode *N,
     return SDValue();
   case ISD::ADD:
     return PerformADDCombine(N, DCI);
+  case ISD::MUL:
+    return PerformMULCombine(N, DCI);
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+    return PerformDIVREMCombine(N, DCI);
   }
 }
 
@@ -402,6 +609,358 @@ SDValue AAPTargetLowering::PerformADDCombine(SDNode *N,
   return SDValue(N, 0);
 }
 
+// Decompose C into signed binary digits, in the non-adjacent form which has
+// the fewest non-zero digits. Each digit is returned as its shift and whether
+// it is negative. Digits at or above the width of C vanish modulo 2^width and
+// are dropped, which also handles negative constants.
+static void
+getSignedDigits(const APInt &C,
+                SmallVectorImpl<std::pair<unsigned, bool>> &Digits) {
+  unsigned BitWidth = C.getBitWidth();
+  APInt Rem = C.zext(BitWidth + 1);
+  for (unsigned Shift = 0; !Rem.isNullValue(); ++Shift, Rem.lshrInPlace(1)) {
+    if (!Rem[0])
+      continue;
+    // A digit of -1 leaves a carry into the run of ones above it
+    bool Negative = Rem[1];
+    if (Negative)
+      ++Rem;
+    else
+      --Rem;
+    if (Shift < BitWidth)
+      Digits.push_back(std::make_pair(Shift, Negative));
+  }
+}
+
+// Multiply X by the constant C using shifts, adds and subtracts. Returns an
+// empty SDValue if this would take more than MaxOps instructions. Types wider
+// than a register are costed as the pairs of instructions they are legalized
+// to, with adds using ADDC/ADDE.
+static SDValue buildMulByConstant(SelectionDAG &DAG, const SDLoc &DL,
+                                  SDValue X, const APInt &C, unsigned MaxOps) {
+  EVT VT = X.getValueType();
+  unsigned Parts = VT.getSizeInBits() / 16;
+  assert((Parts == 1 || Parts == 2) && "Unexpected multiply type");
+
+  SmallVector<std::pair<unsigned, bool>, 16> Digits;
+  getSignedDigits(C, Digits);
+  if (Digits.empty())
+    return DAG.getConstant(0, DL, VT);
+
+  // Shifting a value extended from a single register only needs two
+  // instructions, as one half of it is known.
+  unsigned AddCost = Parts;
+  unsigned ShiftCost = 1;
+  if (Parts == 2)
+    ShiftCost = (X.getOpcode() == ISD::ZERO_EXTEND ||
+                 X.getOpcode() == ISD::SIGN_EXTEND) &&
+                        X.getOperand(0).getValueType() == MVT::i16
+                    ? 2
+                    : 4;
+
+  // Start from a positive digit, so that the result needs to be negated only
+  // if every digit is negative.
+  std::stable_partition(
+      Digits.begin(), Digits.end(),
+      [](const std::pair<unsigned, bool> &D) { return !D.second; });
+  bool Negate = Digits[0].second;
+
+  unsigned Cost = (Digits.size() - 1) * AddCost + (Negate ? AddCost : 0);
+  for (const auto &D : Digits)
+    if (D.first)
+      Cost += ShiftCost;
+  if (Cost > MaxOps)
+    return SDValue();
+
+  const TargetLowering &TLI = DAG.getTargetLoweringInfo();
+  EVT ShiftTy = TLI.getShiftAmountTy(VT, DAG.getDataLayout());
+  auto GetTerm = [&](unsigned Shift) {
+    if (!Shift)
+      return X;
+    return DAG.getNode(ISD::SHL, DL, VT, X,
+                       DAG.getConstant(Shift, DL, ShiftTy));
+  };
+
+  SDValue Res = GetTerm(Digits[0].first);
+  if (Negate)
+    Res = DAG.getNode(ISD::SUB, DL, VT, DAG.getConstant(0, DL, VT), Res);
+  for (const auto &D : makeArrayRef(Digits).drop_front())
+    Res = DAG.getNode(D.second ? ISD::SUB : ISD::ADD, DL, VT, Res,
+                      GetTerm(D.first));
+  return Res;
+}
+
+// Return the high half of the product of the i16 value X and the constant M.
+// The product is formed by shifts and adds of X extended to i32, which are
+// legalized to ADDC/ADDE pairs.
+static SDValue buildMULHByConstant(SelectionDAG &DAG, const SDLoc &DL,
+                                   SDValue X, const APInt &M, bool Signed,
+                                   unsigned MaxOps) {
+  SDValue WideX = DAG.getNode(Signed ? ISD::SIGN_EXTEND : ISD::ZERO_EXTEND, DL,
+                              MVT::i32, X);
+  APInt WideM = Signed ? M.sext(32) : M.zext(32);
+  SDValue Prod = buildMulByConstant(DAG, DL, WideX, WideM, MaxOps);
+  if (!Prod)
+    return SDValue();
+
+  const TargetLowering &TLI = DAG.getTargetLoweringInfo();
+  EVT ShiftTy = TLI.getShiftAmountTy(MVT::i32, DAG.getDataLayout());
+  Prod = DAG.getNode(ISD::SRL, DL, MVT::i32, Prod,
+                     DAG.getConstant(16, DL, ShiftTy));
+  return DAG.getNode(ISD::TRUNCATE, DL, MVT::i16, Prod);
+}
+
+// Divide N0 by a constant using a multiply by its magic number, as in
+// TargetLowering::BuildUDIV and TargetLowering::BuildSDIV, which require a
+// legal MULHU or MULHS.
+static SDValue buildDIVByConstant(SelectionDAG &DAG, const SDLoc &DL,
+                                  SDValue N0, const APInt &Divisor,
+                                  bool Signed, unsigned MaxOps) {
+  const TargetLowering &TLI = DAG.getTargetLoweringInfo();
+  EVT VT = N0.getValueType();
+  EVT ShiftTy = TLI.getShiftAmountTy(VT, DAG.getDataLayout());
+  unsigned BitWidth = VT.getSizeInBits();
+  auto Shift = [&](unsigned Opcode, SDValue V, unsigned Amt) {
+    if (!Amt)
+      return V;
+    return DAG.getNode(Opcode, DL, VT, V, DAG.getConstant(Amt, DL, ShiftTy));
+  };
+
+  if (Signed) {
+    APInt::ms Magics = Divisor.magic();
+    SDValue Q = buildMULHByConstant(DAG, DL, N0, Magics.m, true, MaxOps);
+    if (!Q)
+      return SDValue();
+
+    // Correct for the magic number overflowing into the sign bit
+    if (Divisor.isStrictlyPositive() && Magics.m.isNegative())
+      Q = DAG.getNode(ISD::ADD, DL, VT, Q, N0);
+    else if (Divisor.isNegative() && Magics.m.isStrictlyPositive())
+      Q = DAG.getNode(ISD::SUB, DL, VT, Q, N0);
+
+    // Shift right algebraic, then round towards zero by adding one if the
+    // quotient is negative.
+    Q = Shift(ISD::SRA, Q, Magics.s);
+    SDValue T = Shift(ISD::SRL, Q, BitWidth - 1);
+    return DAG.getNode(ISD::ADD, DL, VT, Q, T);
+  }
+
+  APInt::mu Magics = Divisor.magicu();
+  unsigned PreShift = 0;
+
+  // If the divisor is even, shifting the dividend first avoids the fixup
+  if (Magics.a != 0 && !Divisor[0]) {
+    PreShift = Divisor.countTrailingZeros();
+    Magics = Divisor.lshr(PreShift).magicu(PreShift);
+  }
+
+  SDValue Q = Shift(ISD::SRL, N0, PreShift);
+  Q = buildMULHByConstant(DAG, DL, Q, Magics.m, false, MaxOps);
+  if (!Q)
+    return SDValue();
+
+  if (Magics.a == 0)
+    return Shift(ISD::SRL, Q, Magics.s);
+
+  SDValue NPQ = DAG.getNode(ISD::SUB, DL, VT, N0, Q);
+  NPQ = Shift(ISD::SRL, NPQ, 1);
+  Q = DAG.getNode(ISD::ADD, DL, VT, NPQ, Q);
+  return Shift(ISD::SRL, Q, Magics.s - 1);
+}
+
+// Fold (mul x, c) into shifts and adds when that is cheaper than a call to the
+// runtime library.
+SDValue AAPTargetLowering::PerformMULCombine(SDNode *N,
+                                             DAGCombinerInfo &DCI) const {
+  EVT VT = N->getValueType(0);
+  ConstantSDNode *Const = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (!Const || !isOperationExpand(ISD::MUL, getTypeToTransformTo(
+                                                  *DCI.DAG.getContext(), VT)))
+    return SDValue();
+
+  // Wider multiplies can only be decomposed before they are split into
+  // registers.
+  if (VT != MVT::i16 && (VT != MVT::i32 || !DCI.isBeforeLegalize()))
+    return SDValue();
+
+  // At -Os a call is at most a MOVI, a BAL and a move of the result.
+  const Function &F = DCI.DAG.getMachineFunction().getFunction();
+  unsigned MaxOps = MulConstMaxOps;
+  if (F.optForSize())
+    MaxOps = std::min(MaxOps, 3u);
+
+  return buildMulByConstant(DCI.DAG, SDLoc(N), N->getOperand(0),
+                            Const->getAPIntValue(), MaxOps);
+}
+
+// Fold divides and remainders by a constant into a multiply by a magic number.
+// The generic combine only does this given a legal MULHU or MULHS.
+//
+// Remainders are always expanded using the division of the same signedness.
+// With a hardware divider, only the multiply of the quotient by the constant
+// is built here, as the legalizer would otherwise turn it into a call.
+SDValue AAPTargetLowering::PerformDIVREMCombine(SDNode *N,
+                                                DAGCombinerInfo &DCI) const {
+  SelectionDAG &DAG = DCI.DAG;
+  unsigned Opcode = N->getOpcode();
+  EVT VT = N->getValueType(0);
+  ConstantSDNode *Const = dyn_cast<ConstantSDNode>(N->getOperand(1));
+  if (!Const || VT != MVT::i16 || !DCI.isBeforeLegalize())
+    return SDValue();
+
+  // Division by zero, one and powers of two is left to the generic combine
+  bool Signed = Opcode == ISD::SDIV || Opcode == ISD::SREM;
+  const APInt &Divisor = Const->getAPIntValue();
+  if (Divisor.isNullValue() || Divisor.isPowerOf2() ||
+      (Signed && (-Divisor).isPowerOf2()))
+    return SDValue();
+
+  SDLoc DL(N);
+  SDValue N0 = N->getOperand(0);
+  unsigned DivOpcode = Signed ? ISD::SDIV : ISD::UDIV;
+  bool OptSize = DAG.getMachineFunction().getFunction().optForSize();
+  SDValue Div;
+  if (isOperationLegal(DivOpcode, VT)) {
+    if (Opcode == DivOpcode || isOperationLegal(ISD::MUL, VT))
+      return SDValue();
+    Div = DAG.getNode(DivOpcode, DL, VT, N0, N->getOperand(1));
+  } else {
+    if (OptSize)
+      return SDValue();
+    Div = buildDIVByConstant(DAG, DL, N0, Divisor, Signed, DivConstMaxOps);
+    if (!Div || Opcode == DivOpcode)
+      return Div;
+  }
+
+  // X % C == X - (X / C) * C. At -Os the multiply is limited as in
+  // PerformMULCombine.
+  unsigned MaxOps = MulConstMaxOps;
+  if (OptSize)
+    MaxOps = std::min(MaxOps, 3u);
+  SDValue Mul = buildMulByConstant(DAG, DL, Div, Divisor, MaxOps);
+  if (!Mul)
+    return SDValue();
+  return DAG.getNode(ISD::SUB, DL, VT, N0, Mul);
+}
+
+//===----------------------------------------------------------------------===//
+//                         Addressing Mode Support
+//===----------------------------------------------------------------------===//
+
+bool AAPTargetLowering::isLegalAddressingMode(const DataLayout &DL,
+                                              const AddrMode &AM, Type *Ty,
+                                              unsigned AS,
+                                              Instruction *I) const {
+  // No global is ever allowed as a base
+  if (AM.BaseGV)
+    return false;
+
+  // Loads and stores take a signed 10-bit offset
+  if (!isInt<10>(AM.BaseOffs))
+    return false;
+
+  switch (AM.Scale) {
+  case 0: // "r+i" or just "i"
+    break;
+  case 1:
+    if (!AM.HasBaseReg) // "r+i", allowed
+      break;
+    return false; // "r+r+i" is not allowed
+  default:
+    return false;
+  }
+  return true;
+}
+
+// Get the memory type and base pointer of a load or store which may be
+// converted to a pre-decrement or post-increment access.
+static bool getIndexedAccess(SDNode *N, EVT &VT, SDValue &Ptr) {
+  if (LoadSDNode *LD = dyn_cast<LoadSDNode>(N)) {
+    // There is no sign extending byte load
+    if (LD->getExtensionType() == ISD::SEXTLOAD)
+      return false;
+    VT = LD->getMemoryVT();
+    Ptr = LD->getBasePtr();
+  } else if (StoreSDNode *ST = dyn_cast<StoreSDNode>(N)) {
+    VT = ST->getMemoryVT();
+    Ptr = ST->getBasePtr();
+  } else {
+    return false;
+  }
+  return VT == MVT::i8 || VT == MVT::i16;
+}
+
+// Returns true if Op adjusts its first operand by the size of an access of
+// type VT, incrementing or decrementing as requested.
+static bool isAccessSizeAdjust(SDNode *Op, EVT VT, bool Increment) {
+  if (Op->getOpcode() != ISD::ADD && Op->getOpcode() != ISD::SUB)
+    return false;
+
+  ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op->getOperand(1));
+  if (!C)
+    return false;
+
+  int64_t Adjust = C->getSExtValue();
+  if (Op->getOpcode() == ISD::SUB)
+    Adjust = -Adjust;
+
+  int64_t Size = VT.getStoreSize();
+  return Adjust == (Increment ? Size : -Size);
+}
+
+bool AAPTargetLowering::getPreIndexedAddressParts(SDNode *N, SDValue &Base,
+                                                  SDValue &Offset,
+                                                  ISD::MemIndexedMode &AM,
+                                                  SelectionDAG &DAG) const {
+  EVT VT;
+  SDValue Ptr;
+  if (!getIndexedAccess(N, VT, Ptr))
+    return false;
+
+  // Only pre-decrement by the access size is supported
+  if (!isAccessSizeAdjust(Ptr.getNode(), VT, /*Increment=*/false))
+    return false;
+
+  Base = Ptr.getOperand(0);
+  Offset = DAG.getConstant(VT.getStoreSize(), SDLoc(N), MVT::i16);
+  AM = ISD::PRE_DEC;
+  return true;
+}
+
+bool AAPTargetLowering::getPostIndexedAddressParts(SDNode *N, SDNode *Op,
+                                                   SDValue &Base,
+                                                   SDValue &Offset,
+                                                   ISD::MemIndexedMode &AM,
+                                                   SelectionDAG &DAG) const {
+  EVT VT;
+  SDValue Ptr;
+  if (!getIndexedAccess(N, VT, Ptr))
+    return false;
+
+  // Only post-increment by the access size is supported
+  if (!isAccessSizeAdjust(Op, VT, /*Increment=*/true))
+    return false;
+
+  Base = Op->getOperand(0);
+  Offset = DAG.getConstant(VT.getStoreSize(), SDLoc(N), MVT::i16);
+  AM = ISD::POST_INC;
+  return true;
+}
+
+void AAPTargetLowering::finalizeLowering(MachineFunction &MF) const {
+  // Whether a frame pointer is used must be known before the reserved
+  // registers are frozen. If the locals alone already exceed the reach of a
+  // 10-bit stack pointer offset, set up the frame pointer as a base for the
+  // top of the frame so that only the middle of the frame needs a scavenged
+  // base register. Frame objects are ordered so the hottest sit nearest the
+  // stack pointer, see AAPFrameLowering::orderFrameObjects.
+  const MachineFrameInfo &MFI = MF.getFrameInfo();
+  if (!isInt<10>(MFI.estimateStackSize(MF)))
+    MF.getInfo<AAPMachineFunctionInfo>()->setLargeFrame(true);
+
+  TargetLowering::finalizeLowering(MF);
+}
+
 //===----------------------------------------------------------------------===//
 //                      Calling Convention Implementation
 //===----------------------------------------------------------------------===//
@@ -417,6 +976,7 @@ SDValue AAPTargetLowering::LowerFormalArguments(
     llvm_unreachable("Unsupported calling convention");
   case CallingConv::C:
   case CallingConv::Fast:
+  case CallingConv::Cold:
     break;
   }
 
@@ -535,10 +1095,6 @@ SDValue AAPTargetLowering::LowerReturn(
   SDValue Flag;
   SmallVector<SDValue, 4> RetOps(1, Chain);
 
-  // Add the link register as the first operand
-  RetOps.push_back(
-      DAG.getRegister(AAPRegisterInfo::getLinkRegister(), MVT::i16));
-
   // Add return registers to the CalleeSaveDisableRegs list.
   MachineRegisterInfo &MRI = DAG.getMachineFunction().getRegInfo();
   for (unsigned i = 0; i != RVLocs.size(); ++i) {
@@ -567,6 +1123,131 @@ SDValue AAPTargetLowering::LowerReturn(
   return DAG.getNode(AAPISD::RET_FLAG, Loc, {MVT::Other, MVT::i16}, RetOps);
 }
 
+// Assign locations to the values returned by the function being lowered.
+static void analyzeFunctionReturn(MachineFunction &MF,
+                                  const TargetLowering &TLI,
+                                  SmallVectorImpl<CCValAssign> &RVLocs) {
+  const Function &F = MF.getFunction();
+  SmallVector<ISD::OutputArg, 4> Outs;
+  GetReturnInfo(F.getCallingConv(), F.getReturnType(), F.getAttributes(), Outs,
+                TLI, MF.getDataLayout());
+  CCState CCInfo(F.getCallingConv(), F.isVarArg(), MF, RVLocs, F.getContext());
+  CCInfo.AnalyzeReturn(Outs, RetCC_AAP);
+}
+
+// Return true if Arg is the unmodified value the function received in the
+// physical register Reg.
+static bool isIncomingArgument(const MachineRegisterInfo &MRI, SDValue Arg,
+                               unsigned Reg) {
+  if (Arg.getOpcode() != ISD::CopyFromReg)
+    return false;
+
+  // Arguments used outside the entry block are copied to another virtual
+  // register, which is defined by the time later blocks are lowered.
+  unsigned VReg = cast<RegisterSDNode>(Arg.getOperand(1))->getReg();
+  while (TargetRegisterInfo::isVirtualRegister(VReg)) {
+    if (MRI.getLiveInPhysReg(VReg) == Reg)
+      return true;
+    const MachineInstr *Def = MRI.getVRegDef(VReg);
+    if (!Def || !Def->isCopy() || Def->getOperand(1).getSubReg())
+      return false;
+    VReg = Def->getOperand(1).getReg();
+  }
+  return false;
+}
+
+/// isEligibleForTailCallOptimization - Check whether the call is eligible for
+/// tail call optimization.
+bool AAPTargetLowering::isEligibleForTailCallOptimization(
+    CCState &CCInfo, CallLoweringInfo &CLI, MachineFunction &MF,
+    const SmallVectorImpl<CCValAssign> &ArgLocs) const {
+  const Function &Caller = MF.getFunction();
+  CallingConv::ID CallerCC = Caller.getCallingConv();
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+
+  // Outgoing stack arguments would overwrite the caller's incoming arguments,
+  // which belong to the caller's caller.
+  if (CCInfo.getNextStackOffset() != 0)
+    return false;
+
+  // Do not tail call if either the caller or the callee uses struct return
+  // semantics, or if any arguments are passed by value.
+  if (Caller.hasStructRetAttr())
+    return false;
+  for (const ISD::OutputArg &Arg : CLI.Outs)
+    if (Arg.Flags.isSRet() || Arg.Flags.isByVal())
+      return false;
+
+  // An undefined weak function must not be branched to directly, as the
+  // branch is not replaced by the linker.
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(CLI.Callee))
+    if (G->getGlobal()->hasExternalWeakLinkage())
+      return false;
+
+  // The callee has to preserve all registers the caller needs to preserve.
+  if (CLI.CallConv != CallerCC) {
+    const uint32_t *CallerPreserved = TRI->getCallPreservedMask(MF, CallerCC);
+    const uint32_t *CalleePreserved =
+        TRI->getCallPreservedMask(MF, CLI.CallConv);
+    if (!TRI->regmaskSubsetEqual(CallerPreserved, CalleePreserved))
+      return false;
+  }
+
+  // The registers the caller returns values in are not callee saved.
+  SmallVector<CCValAssign, 4> CallerRVLocs;
+  analyzeFunctionReturn(MF, *this, CallerRVLocs);
+  auto IsCallerReturnReg = [&](unsigned Reg) {
+    return any_of(CallerRVLocs,
+                  [Reg](const CCValAssign &VA) { return VA.getLocReg() == Reg; });
+  };
+
+  // The callee's results are returned straight to the caller's caller, so
+  // they must be in registers the caller is allowed to clobber.
+  SmallVector<CCValAssign, 4> CalleeRVLocs;
+  CCState CalleeRVInfo(CLI.CallConv, CLI.IsVarArg, MF, CalleeRVLocs,
+                       *CLI.DAG.getContext());
+  CalleeRVInfo.AnalyzeCallResult(CLI.Ins, RetCC_AAP);
+  for (const CCValAssign &VA : CalleeRVLocs)
+    if (!IsCallerReturnReg(VA.getLocReg()))
+      return false;
+
+  // The argument registers are callee saved, so the epilogue restores them
+  // before the tail call is made. An argument can only be passed in such a
+  // register if it is the value the caller received in it, or if the caller
+  // returns a value in that register and so does not save it.
+  auto IsCalleeSavedReg = [&](unsigned Reg) {
+    for (const MCPhysReg *CSR = TRI->getCalleeSavedRegs(&MF); *CSR; ++CSR)
+      if (*CSR == Reg)
+        return true;
+    return false;
+  };
+  for (unsigned i = 0, e = ArgLocs.size(); i != e; ++i) {
+    const CCValAssign &VA = ArgLocs[i];
+    unsigned Reg = VA.getLocReg();
+    if (!IsCalleeSavedReg(Reg) || IsCallerReturnReg(Reg))
+      continue;
+    if (VA.getLocInfo() != CCValAssign::Full ||
+        !isIncomingArgument(MRI, CLI.OutVals[i], Reg))
+      return false;
+  }
+
+  // The target of an indirect tail call is held in a GRTC register so that
+  // it survives the epilogue. Callers which save those registers, such as
+  // coldcc functions, would restore them over the target.
+  if (!isa<GlobalAddressSDNode>(CLI.Callee) &&
+      !isa<ExternalSymbolSDNode>(CLI.Callee))
+    for (MCPhysReg Reg : AAP::GRTCRegClass)
+      if (IsCalleeSavedReg(Reg))
+        return false;
+
+  return true;
+}
+
+bool AAPTargetLowering::mayBeEmittedAsTailCall(const CallInst *CI) const {
+  return CI->isTailCall();
+}
+
 /// LowerCallTo - functions arguments are copied from virtual regs to
 /// (physical regs)/(stack frame), CALLSEQ_START and CALLSEQ_END are emitted.
 SDValue AAPTargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
@@ -575,6 +1256,7 @@ SDValue AAPTargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   default:
     llvm_unreachable("Unsupported calling convention");
   case CallingConv::Fast:
+  case CallingConv::Cold:
   case CallingConv::C:
     break;
   }
@@ -586,8 +1268,7 @@ SDValue AAPTargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   SmallVectorImpl<ISD::InputArg> &Ins = CLI.Ins;
   SDValue Chain = CLI.Chain;
   SDValue Callee = CLI.Callee;
-  // AAP target does not yet support tail call optimization.
-  CLI.IsTailCall = false;
+  bool &IsTailCall = CLI.IsTailCall;
   CallingConv::ID CallConv = CLI.CallConv;
   bool isVarArg = CLI.IsVarArg;
 
@@ -600,10 +1281,21 @@ SDValue AAPTargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
 
   CCInfo.AnalyzeCallOperands(Outs, CC_AAP);
 
+  // Check if it's really possible to do a tail call.
+  if (IsTailCall)
+    IsTailCall = isEligibleForTailCallOptimization(CCInfo, CLI, MF, ArgLocs);
+
+  if (IsTailCall)
+    ++NumTailCalls;
+  else if (CLI.CS && CLI.CS.isMustTailCall())
+    report_fatal_error("failed to perform tail call elimination on a call "
+                       "site marked musttail");
+
   // Get a count of how many bytes are to be pushed on the stack.
   unsigned NumBytes = CCInfo.getNextStackOffset();
 
-  Chain = DAG.getCALLSEQ_START(Chain, NumBytes, 0, DL);
+  if (!IsTailCall)
+    Chain = DAG.getCALLSEQ_START(Chain, NumBytes, 0, DL);
 
   SmallVector<std::pair<unsigned, SDValue>, 4> RegsToPass;
   SmallVector<SDValue, 12> MemOpChains;
@@ -689,8 +1381,11 @@ SDValue AAPTargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   Ops.push_back(Chain);
   Ops.push_back(Callee);
 
-  // Add the link register as the first operand
-  Ops.push_back(DAG.getRegister(AAPRegisterInfo::getLinkRegister(), MVT::i16));
+  // Add the link register as the first operand. A tail call leaves the link
+  // register holding the caller's return address.
+  if (!IsTailCall)
+    Ops.push_back(
+        DAG.getRegister(AAPRegisterInfo::getLinkRegister(), MVT::i16));
 
   // Add argument registers to the end of the list so that they are
   // known live into the call.
@@ -699,15 +1394,30 @@ SDValue AAPTargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
                                   RegsToPass[i].second.getValueType()));
 
   // Add the caller saved registers as a register mask operand to the call
-  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
-  const uint32_t *Mask = TRI->getCallPreservedMask(MF, CallConv);
-  assert(Mask && "No call preserved mask for the calling convention");
-  Ops.push_back(DAG.getRegisterMask(Mask));
+  if (!IsTailCall) {
+    const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+    const uint32_t *Mask = TRI->getCallPreservedMask(MF, CallConv);
+    assert(Mask && "No call preserved mask for the calling convention");
+    Ops.push_back(DAG.getRegisterMask(Mask));
+  }
 
   // Glue the call to the argument copies, if any.
   if (Glue.getNode())
     Ops.push_back(Glue);
 
+  // A tail call is a terminator, the epilogue is inserted before it. The
+  // epilogue must not restore the registers the callee returns values in, even
+  // if the function has no other return to disable them.
+  if (IsTailCall) {
+    SmallVector<CCValAssign, 4> CallerRVLocs;
+    analyzeFunctionReturn(MF, *this, CallerRVLocs);
+    for (const CCValAssign &VA : CallerRVLocs)
+      MF.getRegInfo().disableCalleeSavedRegister(VA.getLocReg());
+
+    MF.getFrameInfo().setHasTailCall();
+    return DAG.getNode(AAPISD::TAIL_CALL, DL, MVT::Other, Ops);
+  }
+
   // Emit the call.
   SDVTList NodeTys = DAG.getVTList(MVT::Other, MVT::Glue);
   Chain = DAG.getNode(AAPISD::CALL, DL, NodeTys, Ops);
@@ -752,6 +1462,9 @@ AAPTargetLowering::EmitInstrWithCustomInserter(MachineInstr &MI,
     return EmitSELECT_CC(MI, MBB);
   case AAP::BR_CC:
     return EmitBR_CC(MI, MBB);
+  case AAP::MEMCPY_LOOP:
+  case AAP::MEMSET_LOOP:
+    return EmitMemLoop(MI, MBB);
   }
 }
 
@@ -835,6 +1548,186 @@ MachineBasicBlock *AAPTargetLowering::EmitBR_CC(MachineInstr &MI,
   return MBB;
 }
 
+// Expand a copy or set of memory into a loop of post-increment loads and
+// stores, a word at a time if the pointers are aligned, IE:
+//
+//     EntryMBB
+//      |  \
+//     LoopMBB --.   (loop over each word or byte)
+//      |  /  <--'
+//     TailMBB       (only for a word loop of unknown size)
+//      |  \
+//      |  ByteMBB   (copy or set the trailing byte)
+//      | /
+//     ExitMBB
+//
+// The zero iteration check in EntryMBB is only needed when the size is not
+// known, and a known odd size copies the trailing byte in ExitMBB.
+MachineBasicBlock *
+AAPTargetLowering::EmitMemLoop(MachineInstr &MI,
+                               MachineBasicBlock *MBB) const {
+  DebugLoc DL = MI.getDebugLoc();
+  MachineFunction *MF = MBB->getParent();
+  const TargetInstrInfo &TII = *MF->getSubtarget().getInstrInfo();
+  MachineRegisterInfo &MRI = MF->getRegInfo();
+  const TargetRegisterClass *RC = &AAP::GR64RegClass;
+
+  bool IsMemset = MI.getOpcode() == AAP::MEMSET_LOOP;
+  unsigned DstReg = MI.getOperand(0).getReg();
+  unsigned SrcReg = MI.getOperand(1).getReg();
+  unsigned SizeReg = MI.getOperand(2).getReg();
+  uint64_t KnownSize = MI.getOperand(3).getImm();
+  bool IsWord = MI.getOperand(4).getImm() >= 2;
+
+  const BasicBlock *BB = MBB->getBasicBlock();
+  MachineFunction::iterator It = MBB->getIterator();
+  ++It;
+
+  MachineBasicBlock *EntryMBB = MBB;
+  MachineBasicBlock *LoopMBB = MF->CreateMachineBasicBlock(BB);
+  MachineBasicBlock *TailMBB = nullptr;
+  MachineBasicBlock *ByteMBB = nullptr;
+  MachineBasicBlock *ExitMBB = MF->CreateMachineBasicBlock(BB);
+  MF->insert(It, LoopMBB);
+  if (IsWord && !KnownSize) {
+    TailMBB = MF->CreateMachineBasicBlock(BB);
+    ByteMBB = MF->CreateMachineBasicBlock(BB);
+    MF->insert(It, TailMBB);
+    MF->insert(It, ByteMBB);
+  }
+  MF->insert(It, ExitMBB);
+
+  // Transfer remainder of EntryMBB to ExitMBB
+  ExitMBB->splice(ExitMBB->begin(), EntryMBB,
+                  std::next(MachineBasicBlock::iterator(MI)), EntryMBB->end());
+  ExitMBB->transferSuccessorsAndUpdatePHIs(EntryMBB);
+  MachineBasicBlock *LoopExitMBB = TailMBB ? TailMBB : ExitMBB;
+
+  // Compute the number of iterations, and skip the loop if there are none.
+  unsigned CountReg = SizeReg;
+  if (IsWord) {
+    CountReg = MRI.createVirtualRegister(RC);
+    if (KnownSize)
+      BuildMI(EntryMBB, DL, TII.get(AAP::MOVI_i16), CountReg)
+          .addImm(KnownSize >> 1);
+    else
+      BuildMI(EntryMBB, DL, TII.get(AAP::LSRI_i6), CountReg)
+          .addReg(SizeReg)
+          .addImm(1);
+  }
+  unsigned ZeroReg = MRI.createVirtualRegister(RC);
+  BuildMI(EntryMBB, DL, TII.get(AAP::MOVI_i16), ZeroReg).addImm(0);
+  if (!KnownSize) {
+    BuildMI(EntryMBB, DL, TII.get(AAP::BEQ_))
+        .addMBB(LoopExitMBB)
+        .addReg(CountReg)
+        .addReg(ZeroReg);
+    EntryMBB->addSuccessor(LoopExitMBB);
+  }
+  EntryMBB->addSuccessor(LoopMBB);
+
+  // The loop body, a load and store which both advance their pointer.
+  unsigned DstPhiReg = MRI.createVirtualRegister(RC);
+  unsigned DstNextReg = MRI.createVirtualRegister(RC);
+  unsigned SrcNextReg = 0;
+  unsigned CountPhiReg = MRI.createVirtualRegister(RC);
+  unsigned CountNextReg = MRI.createVirtualRegister(RC);
+  BuildMI(LoopMBB, DL, TII.get(AAP::PHI), DstPhiReg)
+      .addReg(DstReg)
+      .addMBB(EntryMBB)
+      .addReg(DstNextReg)
+      .addMBB(LoopMBB);
+  BuildMI(LoopMBB, DL, TII.get(AAP::PHI), CountPhiReg)
+      .addReg(CountReg)
+      .addMBB(EntryMBB)
+      .addReg(CountNextReg)
+      .addMBB(LoopMBB);
+
+  unsigned ValReg = SrcReg;
+  if (!IsMemset) {
+    unsigned SrcPhiReg = MRI.createVirtualRegister(RC);
+    SrcNextReg = MRI.createVirtualRegister(RC);
+    BuildMI(LoopMBB, DL, TII.get(AAP::PHI), SrcPhiReg)
+        .addReg(SrcReg)
+        .addMBB(EntryMBB)
+        .addReg(SrcNextReg)
+        .addMBB(LoopMBB);
+    ValReg = MRI.createVirtualRegister(RC);
+    BuildMI(LoopMBB, DL,
+            TII.get(IsWord ? AAP::LDW_postinc_wb : AAP::LDB_postinc_wb),
+            ValReg)
+        .addReg(SrcNextReg, RegState::Define)
+        .addReg(SrcPhiReg)
+        .addImm(0);
+  }
+  BuildMI(LoopMBB, DL,
+          TII.get(IsWord ? AAP::STW_postinc_wb : AAP::STB_postinc_wb),
+          DstNextReg)
+      .addReg(DstPhiReg)
+      .addImm(0)
+      .addReg(ValReg);
+  BuildMI(LoopMBB, DL, TII.get(AAP::SUBI_i10), CountNextReg)
+      .addReg(CountPhiReg)
+      .addImm(1);
+  BuildMI(LoopMBB, DL, TII.get(AAP::BNE_))
+      .addMBB(LoopMBB)
+      .addReg(CountNextReg)
+      .addReg(ZeroReg);
+  LoopMBB->addSuccessor(LoopMBB);
+  LoopMBB->addSuccessor(LoopExitMBB);
+
+  // Copy or set the trailing byte of an odd sized word loop.
+  auto EmitByte = [&](MachineBasicBlock &ByteBB, MachineBasicBlock::iterator I,
+                      unsigned Dst, unsigned Src) {
+    unsigned ByteReg = SrcReg;
+    if (!IsMemset) {
+      ByteReg = MRI.createVirtualRegister(RC);
+      BuildMI(ByteBB, I, DL, TII.get(AAP::LDB), ByteReg).addReg(Src).addImm(0);
+    }
+    BuildMI(ByteBB, I, DL, TII.get(AAP::STB))
+        .addReg(Dst)
+        .addImm(0)
+        .addReg(ByteReg);
+  };
+
+  if (TailMBB) {
+    unsigned DstTailReg = MRI.createVirtualRegister(RC);
+    BuildMI(TailMBB, DL, TII.get(AAP::PHI), DstTailReg)
+        .addReg(DstReg)
+        .addMBB(EntryMBB)
+        .addReg(DstNextReg)
+        .addMBB(LoopMBB);
+    unsigned SrcTailReg = 0;
+    if (!IsMemset) {
+      SrcTailReg = MRI.createVirtualRegister(RC);
+      BuildMI(TailMBB, DL, TII.get(AAP::PHI), SrcTailReg)
+          .addReg(SrcReg)
+          .addMBB(EntryMBB)
+          .addReg(SrcNextReg)
+          .addMBB(LoopMBB);
+    }
+
+    unsigned OddReg = MRI.createVirtualRegister(RC);
+    BuildMI(TailMBB, DL, TII.get(AAP::ANDI_i9), OddReg)
+        .addReg(SizeReg)
+        .addImm(1);
+    BuildMI(TailMBB, DL, TII.get(AAP::BEQ_))
+        .addMBB(ExitMBB)
+        .addReg(OddReg)
+        .addReg(ZeroReg);
+    TailMBB->addSuccessor(ByteMBB);
+    TailMBB->addSuccessor(ExitMBB);
+
+    EmitByte(*ByteMBB, ByteMBB->end(), DstTailReg, SrcTailReg);
+    ByteMBB->addSuccessor(ExitMBB);
+  } else if (IsWord && KnownSize % 2) {
+    EmitByte(*ExitMBB, ExitMBB->begin(), DstNextReg, SrcNextReg);
+  }
+
+  MI.eraseFromParent();
+  return ExitMBB;
+}
+
 //===----------------------------------------------------------------------===//
 //                      AAP Inline Assembly Support
 //===----------------------------------------------------------------------===//
@@ -15,6 +15,7 @@
 #ifndef LLVM_LIB_TARGET_AAP_AAPISELLOWERING_H
 #define LLVM_LIB_TARGET_AAP_AAPISELLOWERING_H
 
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/TargetLowering.h"
 
 namespace llvm {
@@ -33,6 +34,10 @@ enum NodeType {
   /// CALL - A node to wrap calls.
   CALL,
 
+  /// TAIL_CALL - A call which reuses the caller's frame and return address.
+  /// Operand 0 is the chain and operand 1 is the callee.
+  TAIL_CALL,
+
   /// Wrapper - A wrapper node for TargetConstantPool, TargetExternalSymbol,
   /// and TargetGlobalAddress.
   Wrapper,
@@ -43,7 +48,14 @@ enum NodeType {
 
   /// SELECT_CC - Custom selectcc node, where the condition code is an
   /// AAP specific value
-  SELECT_CC
+  SELECT_CC,
+
+  /// MEMCPY_LOOP, MEMSET_LOOP - A copy or set of memory using a loop of
+  /// post-increment loads and stores. Operand 0 is the chain, followed by the
+  /// destination, the source or the value to store, the size in bytes, the
+  /// size if known at compile time (zero otherwise) and the alignment.
+  MEMCPY_LOOP,
+  MEMSET_LOOP
 };
 }
 
@@ -74,6 +86,26 @@ public:
     return MVT::i16;
   }
 
+  // There is no position independent code model, so jump table entries are
+  // always absolute 16-bit block addresses.
+  unsigned getJumpTableEncoding() const override {
+    return MachineJumpTableInfo::EK_BlockAddress;
+  }
+
+  bool isLegalAddressingMode(const DataLayout &DL, const AddrMode &AM, Type *Ty,
+                             unsigned AS,
+                             Instruction *I = nullptr) const override;
+
+  bool getPreIndexedAddressParts(SDNode *N, SDValue &Base, SDValue &Offset,
+                                 ISD::MemIndexedMode &AM,
+                                 SelectionDAG &DAG) const override;
+
+  bool getPostIndexedAddressParts(SDNode *N, SDNode *Op, SDValue &Base,
+                                  SDValue &Offset, ISD::MemIndexedMode &AM,
+                                  SelectionDAG &DAG) const override;
+
+  void finalizeLowering(MachineFunction &MF) const override;
+
 private:
   SDValue LowerGlobalAddress(SDValue Op, SelectionDAG &DAG) const;
 
@@ -83,10 +115,14 @@ private:
 
   SDValue LowerConstantPool(SDValue Op, SelectionDAG &DAG) const;
 
+  SDValue LowerJumpTable(SDValue Op, SelectionDAG &DAG) const;
+
   SDValue LowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const;
 
   SDValue LowerBR_CC(SDValue Op, SelectionDAG &DAG) const;
 
+  SDValue LowerSETCC(SDValue Op, SelectionDAG &DAG) const;
+
   SDValue LowerVASTART(SDValue Op, SelectionDAG &DAG) const;
 
   SDValue LowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const;
@@ -97,6 +133,10 @@ private:
 
   SDValue PerformADDCombine(SDNode *N, DAGCombinerInfo &DCI) const;
 
+  SDValue PerformMULCombine(SDNode *N, DAGCombinerInfo &DCI) const;
+
+  SDValue PerformDIVREMCombine(SDNode *N, DAGCombinerInfo &DCI) const;
+
   SDValue LowerFormalArguments(SDValue Chain, CallingConv::ID CC, bool IsVarArg,
                                const SmallVectorImpl<ISD::InputArg> &Ins,
                                const SDLoc &Loc, SelectionDAG &DAG,
@@ -114,11 +154,20 @@ private:
   SDValue LowerCall(TargetLowering::CallLoweringInfo &CLI,
                     SmallVectorImpl<SDValue> &InVals) const override;
 
+  bool isEligibleForTailCallOptimization(
+      CCState &CCInfo, CallLoweringInfo &CLI, MachineFunction &MF,
+      const SmallVectorImpl<CCValAssign> &ArgLocs) const;
+
+  bool mayBeEmittedAsTailCall(const CallInst *CI) const override;
+
   MachineBasicBlock *EmitSELECT_CC(MachineInstr &MI,
                                    MachineBasicBlock *MBB) const;
 
   MachineBasicBlock *EmitBR_CC(MachineInstr &MI,
                                MachineBasicBlock *MBB) const;
+
+  MachineBasicBlock *EmitMemLoop(MachineInstr &MI,
+                                 MachineBasicBlock *MBB) const;
 };
 }
 
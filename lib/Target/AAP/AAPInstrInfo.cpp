@@ -12,10 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "AAPInstrInfo.h"
+#include "AAPMachineFunctionInfo.h"
 #include "AAPTargetMachine.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/Support/MathExtras.h"
+#include <numeric>
 
 using namespace llvm;
 
@@ -86,6 +88,12 @@ bool AAPInstrInfo::analyzeBranch(MachineBasicBlock &MBB,
     if (!isUnpredicatedTerminator(*I))
       break;
 
+    // Tail calls are terminators which are not branches. Generic branches and
+    // the BR_CC pseudo selected by GlobalISel have not been expanded yet.
+    if (!I->getDesc().isBranch() || isPreISelGenericOpcode(I->getOpcode()) ||
+        I->getOpcode() == AAP::BR_CC)
+      return true;
+
     ++NumTerminators;
     FirstBr = I;
     if (I->getDesc().isUnconditionalBranch() || I->getDesc().isIndirectBranch())
@@ -403,6 +411,55 @@ unsigned AAPInstrInfo::getInstSizeInBytes(const MachineInstr &MI) const {
   }
 }
 
+bool AAPInstrInfo::hasShortForm(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return false;
+  case TargetOpcode::COPY: // Lowered to MOV_r
+  case AAP::MOV_r:
+  case AAP::MOVI_i16:
+  case AAP::NOP:
+  case AAP::ADD_r:
+  case AAP::AND_r:
+  case AAP::OR_r:
+  case AAP::XOR_r:
+  case AAP::SUB_r:
+  case AAP::ASR_r:
+  case AAP::LSL_r:
+  case AAP::LSR_r:
+  case AAP::ADDI_i10:
+  case AAP::SUBI_i10:
+  case AAP::ASRI_i6:
+  case AAP::LSLI_i6:
+  case AAP::LSRI_i6:
+  case AAP::LDB:
+  case AAP::LDW:
+  case AAP::LDB_postinc:
+  case AAP::LDW_postinc:
+  case AAP::LDB_predec:
+  case AAP::LDW_predec:
+  case AAP::LDB_postinc_wb:
+  case AAP::LDW_postinc_wb:
+  case AAP::LDB_predec_wb:
+  case AAP::LDW_predec_wb:
+  case AAP::STB:
+  case AAP::STW:
+  case AAP::STB_postinc:
+  case AAP::STW_postinc:
+  case AAP::STB_predec:
+  case AAP::STW_predec:
+  case AAP::STB_postinc_wb:
+  case AAP::STW_postinc_wb:
+  case AAP::STB_predec_wb:
+  case AAP::STW_predec_wb:
+  case AAP::BRA:
+  case AAP::BAL:
+  case AAP::JAL:
+  case AAP::JMP:
+    return true;
+  }
+}
+
 AAPCC::CondCode AAPInstrInfo::getCondFromBranchOpcode(unsigned Opcode) {
   switch (Opcode) {
   default:
@@ -456,3 +513,271 @@ AAPCC::CondCode AAPInstrInfo::reverseCondCode(AAPCC::CondCode CC) {
     return AAPCC::COND_INVALID;
   }
 }
+
+// Ways in which a call to an outlined function is constructed.
+enum MachineOutlinerClass {
+  MachineOutlinerDefault,  // Call with BAL, the link register is free.
+  MachineOutlinerRegSave,  // Same as default, but preserve the link register
+                           // in a free register across the call.
+  MachineOutlinerTailCall, // The sequence ends in a return, branch to it.
+  MachineOutlinerThunk     // The sequence ends in a call, which becomes a
+                           // tail call from the outlined function.
+};
+
+// Size in bytes of a move between two registers, which has a 16-bit encoding
+// when both registers are in R0-R7.
+static unsigned getMoveSize(unsigned DstReg, unsigned SrcReg) {
+  if (AAP::GR8RegClass.contains(DstReg) && AAP::GR8RegClass.contains(SrcReg))
+    return 2;
+  return 4;
+}
+
+static unsigned getMoveOpcode(unsigned DstReg, unsigned SrcReg) {
+  return getMoveSize(DstReg, SrcReg) == 2 ? AAP::MOV_r_short : AAP::MOV_r;
+}
+
+// The link register is reserved, so its liveness is not tracked through the
+// block live-in lists. It is only known to be free across a candidate when
+// the prologue in the entry block has spilled it, in which case the liveness
+// within the block determines whether the epilogue has yet to restore it.
+// When shrink-wrapped, it also holds the return address in blocks outside the
+// prologue and epilogue.
+static bool isLinkRegisterFree(const outliner::Candidate &C) {
+  const MachineFrameInfo &MFI = C.getMF()->getFrameInfo();
+  unsigned LR = AAPRegisterInfo::getLinkRegister();
+  if (C.getMF()->getInfo<AAPMachineFunctionInfo>()->isShrinkWrapped() ||
+      !MFI.isCalleeSavedInfoValid() ||
+      std::none_of(MFI.getCalleeSavedInfo().begin(),
+                   MFI.getCalleeSavedInfo().end(),
+                   [LR](const CalleeSavedInfo &CSI) {
+                     return CSI.getReg() == LR;
+                   }))
+    return false;
+  return C.LRU.available(LR);
+}
+
+unsigned
+AAPInstrInfo::findRegisterToSaveLinkTo(const outliner::Candidate &C) const {
+  const MachineRegisterInfo &MRI = C.getMF()->getRegInfo();
+
+  // Prefer R0-R7, so that the save and restore use the short encoding.
+  for (const TargetRegisterClass *RC : {&AAP::GR8RegClass, &AAP::GR64RegClass})
+    for (unsigned Reg : *RC)
+      if (!MRI.isReserved(Reg) && C.LRU.available(Reg) &&
+          C.UsedInSequence.available(Reg))
+        return Reg;
+  return 0;
+}
+
+bool AAPInstrInfo::isFunctionSafeToOutlineFrom(
+    MachineFunction &MF, bool OutlineFromLinkOnceODRs) const {
+  const Function &F = MF.getFunction();
+
+  // Functions which the linker may deduplicate are left alone unless asked.
+  if (!OutlineFromLinkOnceODRs && F.hasLinkOnceODRLinkage())
+    return false;
+
+  // The program may expect all of the code of a function with an explicit
+  // section to be placed in that section.
+  if (F.hasSection())
+    return false;
+
+  return true;
+}
+
+bool AAPInstrInfo::shouldOutlineFromFunctionByDefault(
+    MachineFunction &MF) const {
+  return MF.getFunction().optForMinSize();
+}
+
+outliner::OutlinedFunction AAPInstrInfo::getOutliningCandidateInfo(
+    std::vector<outliner::Candidate> &RepeatedSequenceLocs) const {
+  // The outliner runs after the short instruction peephole, so the sizes here
+  // reflect the 16-bit encodings that have been chosen.
+  outliner::Candidate &FirstCand = RepeatedSequenceLocs[0];
+  unsigned SequenceSize = std::accumulate(
+      FirstCand.front(), std::next(FirstCand.back()), 0,
+      [this](unsigned Sum, const MachineInstr &MI) {
+        return Sum + getInstSizeInBytes(MI);
+      });
+
+  const TargetRegisterInfo &TRI = *FirstCand.getMF()->getSubtarget()
+                                       .getRegisterInfo();
+  for (outliner::Candidate &C : RepeatedSequenceLocs)
+    C.initLRU(TRI);
+
+  // The link register holds the return address of the outlined function, so
+  // a call may only appear as the last instruction of the sequence.
+  unsigned LR = AAPRegisterInfo::getLinkRegister();
+  if (std::any_of(FirstCand.front(), FirstCand.back(),
+                  [](const MachineInstr &MI) { return MI.isCall(); }))
+    return outliner::OutlinedFunction();
+
+  const MachineInstr &LastInst = *FirstCand.back();
+  unsigned FrameID;
+  unsigned FrameOverhead;
+
+  if (LastInst.isTerminator()) {
+    // The sequence returns itself, so branch to it with a BRA.
+    FrameID = MachineOutlinerTailCall;
+    FrameOverhead = 0;
+    for (outliner::Candidate &C : RepeatedSequenceLocs)
+      C.setCallInfo(MachineOutlinerTailCall, 4);
+  } else if (LastInst.isCall()) {
+    // The final call returns directly to the caller of the outlined function,
+    // so nothing before it may depend on the link register.
+    if (std::any_of(FirstCand.front(), FirstCand.back(),
+                    [&](const MachineInstr &MI) {
+                      return MI.readsRegister(LR, &TRI) ||
+                             MI.modifiesRegister(LR, &TRI);
+                    }))
+      return outliner::OutlinedFunction();
+    FrameID = MachineOutlinerThunk;
+    FrameOverhead = 0;
+    for (outliner::Candidate &C : RepeatedSequenceLocs)
+      C.setCallInfo(MachineOutlinerThunk, 4);
+  } else {
+    // The outlined function returns with a JMP through the link register.
+    if (!FirstCand.UsedInSequence.available(LR))
+      return outliner::OutlinedFunction();
+    FrameID = MachineOutlinerDefault;
+    FrameOverhead = 2;
+
+    // Where the link register is live, it is preserved by a pair of moves to
+    // and from a free register. Candidates with neither are dropped.
+    auto SetCallInfo = [&](outliner::Candidate &C) {
+      if (isLinkRegisterFree(C)) {
+        C.setCallInfo(MachineOutlinerDefault, 4);
+        return false;
+      }
+      if (unsigned Reg = findRegisterToSaveLinkTo(C)) {
+        C.setCallInfo(MachineOutlinerRegSave,
+                      4 + getMoveSize(Reg, LR) + getMoveSize(LR, Reg));
+        return false;
+      }
+      return true;
+    };
+    RepeatedSequenceLocs.erase(std::remove_if(RepeatedSequenceLocs.begin(),
+                                              RepeatedSequenceLocs.end(),
+                                              SetCallInfo),
+                               RepeatedSequenceLocs.end());
+  }
+
+  // Never replace a sequence with a larger call. Besides not saving anything,
+  // this keeps any short branches across the candidate in range.
+  RepeatedSequenceLocs.erase(
+      std::remove_if(RepeatedSequenceLocs.begin(), RepeatedSequenceLocs.end(),
+                     [SequenceSize](const outliner::Candidate &C) {
+                       return C.getCallOverhead() >= SequenceSize;
+                     }),
+      RepeatedSequenceLocs.end());
+
+  if (RepeatedSequenceLocs.size() < 2)
+    return outliner::OutlinedFunction();
+
+  return outliner::OutlinedFunction(RepeatedSequenceLocs, SequenceSize,
+                                    FrameOverhead, FrameID);
+}
+
+outliner::InstrType
+AAPInstrInfo::getOutliningType(MachineBasicBlock::iterator &MIT,
+                               unsigned Flags) const {
+  MachineInstr &MI = *MIT;
+
+  if (MI.isDebugInstr() || MI.isKill())
+    return outliner::InstrType::Invisible;
+
+  // Terminators may only be outlined as a tail call, from a block which does
+  // not fall through or branch elsewhere.
+  if (MI.isTerminator())
+    return MI.getParent()->succ_empty() ? outliner::InstrType::Legal
+                                        : outliner::InstrType::Illegal;
+
+  if (MI.isPosition() || MI.isCFIInstruction())
+    return outliner::InstrType::Illegal;
+
+  // The shared save and restore routines return through R10 rather than the
+  // link register.
+  if (MI.getOpcode() == AAP::PseudoSAVE_CSR ||
+      MI.getOpcode() == AAP::PseudoRESTORE_CSR)
+    return outliner::InstrType::Illegal;
+
+  for (const MachineOperand &MO : MI.operands())
+    if (MO.isMBB() || MO.isCPI() || MO.isJTI() || MO.isFI() ||
+        MO.isCFIIndex() || MO.isTargetIndex())
+      return outliner::InstrType::Illegal;
+
+  // No stack is used by calls to outlined functions, so stack pointer
+  // relative accesses such as spills and reloads remain valid.
+  return outliner::InstrType::Legal;
+}
+
+void AAPInstrInfo::buildOutlinedFrame(
+    MachineBasicBlock &MBB, MachineFunction &MF,
+    const outliner::OutlinedFunction &OF) const {
+  unsigned LR = AAPRegisterInfo::getLinkRegister();
+
+  switch (OF.FrameConstructionID) {
+  case MachineOutlinerTailCall:
+    // The sequence already returns.
+    return;
+  case MachineOutlinerThunk: {
+    // Turn the final call into a tail call.
+    MachineInstr &Call = MBB.back();
+    MachineInstr *TC;
+    if (Call.getOpcode() == AAP::BAL || Call.getOpcode() == AAP::BAL_short) {
+      TC = BuildMI(MF, DebugLoc(), get(AAP::TC_RETURNd))
+               .add(Call.getOperand(0));
+    } else {
+      unsigned Callee = Call.getOperand(0).getReg();
+      TC = BuildMI(MF, DebugLoc(),
+                   get(AAP::GR8RegClass.contains(Callee) ? AAP::JMP_short
+                                                         : AAP::JMP))
+               .addReg(Callee);
+    }
+    MBB.insert(MBB.end(), TC);
+    Call.eraseFromParent();
+    return;
+  }
+  default:
+    BuildMI(MBB, MBB.end(), DebugLoc(), get(AAP::JMP_short)).addReg(LR);
+    return;
+  }
+}
+
+MachineBasicBlock::iterator
+AAPInstrInfo::insertOutlinedCall(Module &M, MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator &It,
+                                 MachineFunction &MF,
+                                 const outliner::Candidate &C) const {
+  unsigned LR = AAPRegisterInfo::getLinkRegister();
+  GlobalValue *Callee = M.getNamedValue(MF.getName());
+
+  if (C.CallConstructionID == MachineOutlinerTailCall) {
+    It = MBB.insert(It, BuildMI(MF, DebugLoc(), get(AAP::TC_RETURNd))
+                            .addGlobalAddress(Callee));
+    return It;
+  }
+
+  MachineInstr *Call =
+      BuildMI(MF, DebugLoc(), get(AAP::BAL)).addGlobalAddress(Callee).addReg(LR);
+
+  if (C.CallConstructionID != MachineOutlinerRegSave) {
+    It = MBB.insert(It, Call);
+    return It;
+  }
+
+  unsigned Reg = findRegisterToSaveLinkTo(C);
+  assert(Reg && "No free register to save the link register to?");
+
+  It = MBB.insert(It, BuildMI(MF, DebugLoc(), get(getMoveOpcode(Reg, LR)), Reg)
+                          .addReg(LR));
+  ++It;
+  It = MBB.insert(It, Call);
+  MachineBasicBlock::iterator CallPt = It;
+  ++It;
+  // The outliner erases the candidate from the instruction after It
+  It = MBB.insert(It, BuildMI(MF, DebugLoc(), get(getMoveOpcode(LR, Reg)), LR)
+                          .addReg(Reg, RegState::Kill));
+  return CallPt;
+}
@@ -86,9 +86,39 @@ public:
 
   unsigned getInstSizeInBytes(const MachineInstr &MI) const override;
 
+  // Machine outliner hooks
+  bool isFunctionSafeToOutlineFrom(MachineFunction &MF,
+                                   bool OutlineFromLinkOnceODRs) const override;
+
+  bool shouldOutlineFromFunctionByDefault(MachineFunction &MF) const override;
+
+  outliner::OutlinedFunction getOutliningCandidateInfo(
+      std::vector<outliner::Candidate> &RepeatedSequenceLocs) const override;
+
+  outliner::InstrType getOutliningType(MachineBasicBlock::iterator &MIT,
+                                       unsigned Flags) const override;
+
+  void buildOutlinedFrame(MachineBasicBlock &MBB, MachineFunction &MF,
+                          const outliner::OutlinedFunction &OF) const override;
+
+  MachineBasicBlock::iterator
+  insertOutlinedCall(Module &M, MachineBasicBlock &MBB,
+                     MachineBasicBlock::iterator &It, MachineFunction &MF,
+                     const outliner::Candidate &C) const override;
+
+  // Returns true if the instruction may be replaced with a 16-bit equivalent
+  // by the short instruction peephole, given suitable operands.
+  static bool hasShortForm(unsigned Opcode);
+
   static AAPCC::CondCode getCondFromBranchOpcode(unsigned Opcode);
   static unsigned getBranchOpcodeFromCond(AAPCC::CondCode CC);
   static AAPCC::CondCode reverseCondCode(AAPCC::CondCode CC);
+
+private:
+  // Returns a register which is unused across the outlining candidate and
+  // may hold the link register during a call to the outlined function, or 0
+  // if there is none.
+  unsigned findRegisterToSaveLinkTo(const outliner::Candidate &C) const;
 };
 } // namespace llvm
 
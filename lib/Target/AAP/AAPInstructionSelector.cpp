@@ -0,0 +1,448 @@
+//===-- AAPInstructionSelector.cpp - AAP GlobalISel selector --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// AAP. Most instructions are selected by the patterns imported from the
+/// SelectionDAG descriptions, the remainder are selected here.
+//===----------------------------------------------------------------------===//
+
+#include "AAP.h"
+#include "AAPInstrInfo.h"
+#include "AAPRegisterBankInfo.h"
+#include "AAPSubtarget.h"
+#include "AAPTargetMachine.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelectorImpl.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "aap-isel"
+
+using namespace llvm;
+
+namespace {
+
+#define GET_GLOBALISEL_PREDICATE_BITSET
+#include "AAPGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATE_BITSET
+
+class AAPInstructionSelector : public InstructionSelector {
+public:
+  AAPInstructionSelector(const AAPTargetMachine &TM, const AAPSubtarget &STI,
+                         const AAPRegisterBankInfo &RBI);
+
+  bool select(MachineInstr &I, CodeGenCoverage &CoverageInfo) const override;
+  static const char *getName() { return DEBUG_TYPE; }
+
+private:
+  bool selectImpl(MachineInstr &I, CodeGenCoverage &CoverageInfo) const;
+
+  bool selectCopy(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectLoadStore(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectExt(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectCompare(MachineInstr &I, MachineRegisterInfo &MRI) const;
+
+  /// Find the AAP condition code and operands of a comparison feeding a
+  /// G_BRCOND or G_SELECT, materializing a test of bit 0 of \p CondReg if it
+  /// is not defined by a G_ICMP which can be folded.
+  AAPCC::CondCode getCondition(MachineInstr &I, unsigned CondReg,
+                               MachineRegisterInfo &MRI, unsigned &LHS,
+                               unsigned &RHS) const;
+
+  unsigned buildConstant(MachineInstr &I, int64_t Imm,
+                         MachineRegisterInfo &MRI) const;
+
+  ComplexRendererFns selectAddrMO10(MachineOperand &Root) const;
+
+  const AAPTargetMachine &TM;
+  const AAPSubtarget &STI;
+  const AAPInstrInfo &TII;
+  const TargetRegisterInfo &TRI;
+  const AAPRegisterBankInfo &RBI;
+
+#define GET_GLOBALISEL_PREDICATES_DECL
+#include "AAPGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_DECL
+
+#define GET_GLOBALISEL_TEMPORARIES_DECL
+#include "AAPGenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_DECL
+};
+
+} // end anonymous namespace
+
+#define GET_GLOBALISEL_IMPL
+#include "AAPGenGlobalISel.inc"
+#undef GET_GLOBALISEL_IMPL
+
+AAPInstructionSelector::AAPInstructionSelector(const AAPTargetMachine &TM,
+                                               const AAPSubtarget &STI,
+                                               const AAPRegisterBankInfo &RBI)
+    : InstructionSelector(), TM(TM), STI(STI), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI),
+#define GET_GLOBALISEL_PREDICATES_INIT
+#include "AAPGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_INIT
+#define GET_GLOBALISEL_TEMPORARIES_INIT
+#include "AAPGenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_INIT
+{
+}
+
+// Get the AAP condition code for an integer comparison, and whether the
+// operands must be swapped. AAP only branches on less than (or equal), so
+// greater than comparisons are performed with the operands reversed.
+static AAPCC::CondCode getAAPCondCode(CmpInst::Predicate Pred, bool &Swap) {
+  Swap = false;
+  switch (Pred) {
+  default:
+    llvm_unreachable("Unknown integer comparison");
+  case CmpInst::ICMP_EQ:
+    return AAPCC::COND_EQ;
+  case CmpInst::ICMP_NE:
+    return AAPCC::COND_NE;
+  case CmpInst::ICMP_SGT:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_SLT:
+    return AAPCC::COND_LTS;
+  case CmpInst::ICMP_SGE:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_SLE:
+    return AAPCC::COND_LES;
+  case CmpInst::ICMP_UGT:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_ULT:
+    return AAPCC::COND_LTU;
+  case CmpInst::ICMP_UGE:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_ULE:
+    return AAPCC::COND_LEU;
+  }
+}
+
+bool AAPInstructionSelector::selectCopy(MachineInstr &I,
+                                        MachineRegisterInfo &MRI) const {
+  // Values of every type live in the same registers, so any virtual register
+  // operand is constrained to the general register class.
+  for (MachineOperand &MO : I.operands()) {
+    if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      continue;
+    if (!RBI.constrainGenericRegister(MO.getReg(), AAP::GR64RegClass, MRI)) {
+      LLVM_DEBUG(dbgs() << "Failed to constrain " << TII.getName(I.getOpcode())
+                        << " operand\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+unsigned AAPInstructionSelector::buildConstant(MachineInstr &I, int64_t Imm,
+                                               MachineRegisterInfo &MRI) const {
+  unsigned Reg = MRI.createVirtualRegister(&AAP::GR64RegClass);
+  BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(AAP::MOVI_i16), Reg)
+      .addImm(Imm);
+  return Reg;
+}
+
+InstructionSelector::ComplexRendererFns
+AAPInstructionSelector::selectAddrMO10(MachineOperand &Root) const {
+  if (!Root.isReg())
+    return None;
+
+  MachineRegisterInfo &MRI =
+      Root.getParent()->getParent()->getParent()->getRegInfo();
+  MachineInstr *RootDef = MRI.getVRegDef(Root.getReg());
+  if (!RootDef)
+    return None;
+
+  // Fold frame indices and constant offsets in the signed 10-bit range into
+  // the memory operand, as AAPDAGToDAGISel::SelectAddr_MO10 does.
+  if (RootDef->getOpcode() == TargetOpcode::G_FRAME_INDEX) {
+    return {{
+        [=](MachineInstrBuilder &MIB) { MIB.add(RootDef->getOperand(1)); },
+        [=](MachineInstrBuilder &MIB) { MIB.addImm(0); },
+    }};
+  }
+
+  if (isBaseWithConstantOffset(Root, MRI)) {
+    MachineOperand &LHS = RootDef->getOperand(1);
+    MachineInstr *LHSDef = MRI.getVRegDef(LHS.getReg());
+    MachineInstr *RHSDef = MRI.getVRegDef(RootDef->getOperand(2).getReg());
+    int64_t Offset = RHSDef->getOperand(1).getCImm()->getSExtValue();
+    if (LHSDef && isInt<10>(Offset)) {
+      if (LHSDef->getOpcode() == TargetOpcode::G_FRAME_INDEX)
+        return {{
+            [=](MachineInstrBuilder &MIB) { MIB.add(LHSDef->getOperand(1)); },
+            [=](MachineInstrBuilder &MIB) { MIB.addImm(Offset); },
+        }};
+      return {{
+          [=](MachineInstrBuilder &MIB) { MIB.add(LHS); },
+          [=](MachineInstrBuilder &MIB) { MIB.addImm(Offset); },
+      }};
+    }
+  }
+
+  return {{
+      [=](MachineInstrBuilder &MIB) { MIB.add(Root); },
+      [=](MachineInstrBuilder &MIB) { MIB.addImm(0); },
+  }};
+}
+
+bool AAPInstructionSelector::selectLoadStore(MachineInstr &I,
+                                             MachineRegisterInfo &MRI) const {
+  // All loads and stores are selected here. The opcode depends on the size
+  // of the memory access rather than on the type of the value.
+  bool IsStore = I.getOpcode() == TargetOpcode::G_STORE;
+  unsigned Size = (*I.memoperands_begin())->getSize();
+  unsigned Opc;
+  if (Size == 1)
+    Opc = IsStore ? AAP::STB : AAP::LDB;
+  else if (Size == 2)
+    Opc = IsStore ? AAP::STW : AAP::LDW;
+  else
+    return false;
+
+  ComplexRendererFns Addr = selectAddrMO10(I.getOperand(1));
+  if (!Addr)
+    return false;
+
+  MachineInstrBuilder MIB =
+      BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc));
+  if (!IsStore)
+    MIB.add(I.getOperand(0));
+  for (const auto &Render : *Addr)
+    Render(MIB);
+  if (IsStore)
+    MIB.add(I.getOperand(0));
+  MIB.cloneMemRefs(I);
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+bool AAPInstructionSelector::selectExt(MachineInstr &I,
+                                       MachineRegisterInfo &MRI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+  unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+
+  // Zero extensions mask off the high bits, sign extensions shift the sign
+  // bit to the top of the register and back again.
+  MachineInstr *MI;
+  if (I.getOpcode() == TargetOpcode::G_ZEXT) {
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::ANDI_i9), DstReg)
+             .addReg(SrcReg)
+             .addImm((1 << SrcSize) - 1);
+  } else {
+    unsigned ShiftReg = MRI.createVirtualRegister(&AAP::GR64RegClass);
+    MachineInstr *Shl = BuildMI(MBB, I, DL, TII.get(AAP::LSLI_i6), ShiftReg)
+                            .addReg(SrcReg)
+                            .addImm(16 - SrcSize);
+    if (!constrainSelectedInstRegOperands(*Shl, TII, TRI, RBI))
+      return false;
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::ASRI_i6), DstReg)
+             .addReg(ShiftReg)
+             .addImm(16 - SrcSize);
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MI, TII, TRI, RBI);
+}
+
+AAPCC::CondCode
+AAPInstructionSelector::getCondition(MachineInstr &I, unsigned CondReg,
+                                     MachineRegisterInfo &MRI, unsigned &LHS,
+                                     unsigned &RHS) const {
+  MachineInstr *CondDef = MRI.getVRegDef(CondReg);
+  if (CondDef && CondDef->getOpcode() == TargetOpcode::G_ICMP &&
+      MRI.hasOneUse(CondReg)) {
+    bool Swap;
+    AAPCC::CondCode CC = getAAPCondCode(
+        static_cast<CmpInst::Predicate>(CondDef->getOperand(1).getPredicate()),
+        Swap);
+    LHS = CondDef->getOperand(2).getReg();
+    RHS = CondDef->getOperand(3).getReg();
+    if (Swap)
+      std::swap(LHS, RHS);
+    return CC;
+  }
+
+  // Only bit 0 of an s1 value is defined.
+  LHS = MRI.createVirtualRegister(&AAP::GR64RegClass);
+  BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(AAP::ANDI_i9), LHS)
+      .addReg(CondReg)
+      .addImm(1);
+  RHS = buildConstant(I, 0, MRI);
+  return AAPCC::COND_NE;
+}
+
+bool AAPInstructionSelector::selectCompare(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  MachineInstr *MI;
+
+  // There are no flag registers or conditional moves, so comparisons are
+  // selected into the same branch and select pseudos that SelectionDAG uses.
+  // These are expanded by AAPTargetLowering::EmitInstrWithCustomInserter.
+  switch (I.getOpcode()) {
+  default:
+    llvm_unreachable("Unexpected comparison");
+  case TargetOpcode::G_BRCOND: {
+    unsigned LHS, RHS;
+    AAPCC::CondCode CC =
+        getCondition(I, I.getOperand(0).getReg(), MRI, LHS, RHS);
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::BR_CC))
+             .addImm(CC)
+             .addReg(LHS)
+             .addReg(RHS)
+             .add(I.getOperand(1));
+    break;
+  }
+  case TargetOpcode::G_SELECT: {
+    unsigned LHS, RHS;
+    AAPCC::CondCode CC =
+        getCondition(I, I.getOperand(1).getReg(), MRI, LHS, RHS);
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::SELECT_CC))
+             .add(I.getOperand(0))
+             .addReg(LHS)
+             .addReg(RHS)
+             .add(I.getOperand(2))
+             .add(I.getOperand(3))
+             .addImm(CC);
+    break;
+  }
+  case TargetOpcode::G_ICMP: {
+    // A comparison whose result is used as a value, rather than folded into
+    // a branch or select, selects between one and zero.
+    bool Swap;
+    AAPCC::CondCode CC = getAAPCondCode(
+        static_cast<CmpInst::Predicate>(I.getOperand(1).getPredicate()), Swap);
+    unsigned LHS = I.getOperand(2).getReg();
+    unsigned RHS = I.getOperand(3).getReg();
+    if (Swap)
+      std::swap(LHS, RHS);
+    unsigned One = buildConstant(I, 1, MRI);
+    unsigned Zero = buildConstant(I, 0, MRI);
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::SELECT_CC))
+             .add(I.getOperand(0))
+             .addReg(LHS)
+             .addReg(RHS)
+             .addReg(One)
+             .addReg(Zero)
+             .addImm(CC);
+    break;
+  }
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MI, TII, TRI, RBI);
+}
+
+bool AAPInstructionSelector::select(MachineInstr &I,
+                                    CodeGenCoverage &CoverageInfo) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  if (!isPreISelGenericOpcode(I.getOpcode())) {
+    if (I.isCopy())
+      return selectCopy(I, MRI);
+    return true;
+  }
+
+  using namespace TargetOpcode;
+
+  // The imported load and store patterns do not check the size of the memory
+  // access, so byte accesses of 16-bit values would be selected as words.
+  if (I.getOpcode() == G_LOAD || I.getOpcode() == G_STORE)
+    return selectLoadStore(I, MRI);
+
+  if (selectImpl(I, CoverageInfo))
+    return true;
+
+  const DebugLoc &DL = I.getDebugLoc();
+  MachineInstr *MI = nullptr;
+
+  switch (I.getOpcode()) {
+  default:
+    return false;
+  case G_ANYEXT:
+  case G_TRUNC:
+  case G_INTTOPTR:
+  case G_PTRTOINT:
+    I.setDesc(TII.get(TargetOpcode::COPY));
+    return selectCopy(I, MRI);
+  case G_PHI:
+    I.setDesc(TII.get(TargetOpcode::PHI));
+    return selectCopy(I, MRI);
+  case G_IMPLICIT_DEF:
+    I.setDesc(TII.get(TargetOpcode::IMPLICIT_DEF));
+    return selectCopy(I, MRI);
+  case G_ZEXT:
+  case G_SEXT:
+    return selectExt(I, MRI);
+  case G_ICMP:
+  case G_BRCOND:
+  case G_SELECT:
+    return selectCompare(I, MRI);
+  case G_CONSTANT: {
+    // Null and other constant pointers, integers are selected by the
+    // imported MOVI_i16 pattern.
+    const MachineOperand &Imm = I.getOperand(1);
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::MOVI_i16))
+             .add(I.getOperand(0))
+             .addImm(Imm.getCImm()->getSExtValue());
+    break;
+  }
+  case G_GLOBAL_VALUE:
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::MOVI_i16))
+             .add(I.getOperand(0))
+             .add(I.getOperand(1));
+    break;
+  case G_FRAME_INDEX:
+    // Replaced by an ADDI or SUBI from the frame register once the frame
+    // layout is known.
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::LEA))
+             .add(I.getOperand(0))
+             .add(I.getOperand(1))
+             .addImm(0);
+    break;
+  case G_GEP:
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::ADD_r))
+             .add(I.getOperand(0))
+             .add(I.getOperand(1))
+             .add(I.getOperand(2));
+    break;
+  case G_BRINDIRECT:
+    MI = BuildMI(MBB, I, DL, TII.get(AAP::JMP)).add(I.getOperand(0));
+    break;
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MI, TII, TRI, RBI);
+}
+
+namespace llvm {
+InstructionSelector *
+createAAPInstructionSelector(const AAPTargetMachine &TM,
+                             AAPSubtarget &Subtarget,
+                             AAPRegisterBankInfo &RBI) {
+  return new AAPInstructionSelector(TM, Subtarget, RBI);
+}
+} // end namespace llvm
@@ -0,0 +1,167 @@
+//===-- AAPLegalizerInfo.cpp - AAP GlobalISel legalizer -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the MachineLegalizer class for AAP.
+///
+/// Everything is done in 16-bit registers. Narrower values are widened, and
+/// wider values are not legalized at all so that such functions fall back to
+/// SelectionDAG, which knows how to expand them into carry chains.
+//===----------------------------------------------------------------------===//
+
+#include "AAPLegalizerInfo.h"
+#include "AAPSubtarget.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerHelper.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Type.h"
+
+using namespace llvm;
+
+AAPLegalizerInfo::AAPLegalizerInfo(const AAPSubtarget &ST) {
+  using namespace TargetOpcode;
+
+  const LLT p0 = LLT::pointer(0, 16);
+
+  const LLT s1 = LLT::scalar(1);
+  const LLT s8 = LLT::scalar(8);
+  const LLT s16 = LLT::scalar(16);
+
+  getActionDefinitionsBuilder({G_ADD, G_SUB, G_AND, G_OR, G_XOR})
+      .legalFor({s16})
+      .minScalar(0, s16);
+
+  getActionDefinitionsBuilder({G_SHL, G_LSHR, G_ASHR})
+      .legalFor({s16})
+      .minScalar(0, s16);
+
+  // Without the multiply or divide hardware these become calls to the same
+  // runtime library routines used by SelectionDAG, as do all remainders.
+  if (ST.hasMul())
+    getActionDefinitionsBuilder(G_MUL)
+        .legalFor({s16})
+        .minScalar(0, s16);
+  else
+    getActionDefinitionsBuilder(G_MUL)
+        .customFor({s16})
+        .minScalar(0, s16);
+
+  if (ST.hasDiv())
+    getActionDefinitionsBuilder({G_SDIV, G_UDIV})
+        .legalFor({s16})
+        .minScalar(0, s16);
+  else
+    getActionDefinitionsBuilder({G_SDIV, G_UDIV})
+        .customFor({s16})
+        .minScalar(0, s16);
+
+  getActionDefinitionsBuilder({G_SREM, G_UREM})
+      .customFor({s16})
+      .minScalar(0, s16);
+
+  getActionDefinitionsBuilder({G_SEXT, G_ZEXT, G_ANYEXT})
+      .legalForCartesianProduct({s16}, {s1, s8});
+  getActionDefinitionsBuilder(G_TRUNC)
+      .legalForCartesianProduct({s1, s8}, {s16});
+
+  getActionDefinitionsBuilder({G_CONSTANT, G_IMPLICIT_DEF})
+      .legalFor({s16, p0})
+      .minScalar(0, s16);
+
+  getActionDefinitionsBuilder(G_ICMP)
+      .legalForCartesianProduct({s1}, {s16, p0})
+      .minScalar(1, s16);
+
+  getActionDefinitionsBuilder(G_SELECT)
+      .legalForCartesianProduct({s16, p0}, {s1})
+      .minScalar(0, s16);
+
+  getActionDefinitionsBuilder(G_BRCOND).legalFor({s1});
+  getActionDefinitionsBuilder(G_BRINDIRECT).legalFor({p0});
+
+  getActionDefinitionsBuilder(G_PHI).legalFor({s16, p0}).minScalar(0, s16);
+
+  // Byte loads zero extend, and byte stores truncate. The generic legalizer
+  // cannot widen byte sized values in memory operations, so that is done by
+  // legalizeCustom.
+  getActionDefinitionsBuilder({G_LOAD, G_STORE})
+      .legalForTypesWithMemSize({{s16, p0, 8}, {s16, p0, 16}, {p0, p0, 16}})
+      .customForCartesianProduct({s8}, {p0})
+      .minScalar(0, s8);
+
+  getActionDefinitionsBuilder(G_GEP).legalFor({{p0, s16}});
+  getActionDefinitionsBuilder({G_FRAME_INDEX, G_GLOBAL_VALUE}).legalFor({p0});
+  getActionDefinitionsBuilder(G_INTTOPTR).legalFor({{p0, s16}});
+  getActionDefinitionsBuilder(G_PTRTOINT).legalFor({{s16, p0}});
+
+  computeTables();
+  verify(*ST.getInstrInfo());
+}
+
+bool AAPLegalizerInfo::legalizeCustom(MachineInstr &MI,
+                                      MachineRegisterInfo &MRI,
+                                      MachineIRBuilder &MIRBuilder) const {
+  using namespace TargetOpcode;
+
+  RTLIB::Libcall Libcall;
+  switch (MI.getOpcode()) {
+  default:
+    return false;
+  case G_LOAD:
+  case G_STORE:
+    return legalizeByteLoadStore(MI, MRI, MIRBuilder);
+  case G_MUL:
+    Libcall = RTLIB::MUL_I16;
+    break;
+  case G_SDIV:
+    Libcall = RTLIB::SDIV_I16;
+    break;
+  case G_UDIV:
+    Libcall = RTLIB::UDIV_I16;
+    break;
+  case G_SREM:
+    Libcall = RTLIB::SREM_I16;
+    break;
+  case G_UREM:
+    Libcall = RTLIB::UREM_I16;
+    break;
+  }
+
+  MIRBuilder.setInstr(MI);
+  Type *Ty = Type::getInt16Ty(MIRBuilder.getMF().getFunction().getContext());
+  auto Status =
+      createLibcall(MIRBuilder, Libcall, {MI.getOperand(0).getReg(), Ty},
+                    {{MI.getOperand(1).getReg(), Ty},
+                     {MI.getOperand(2).getReg(), Ty}});
+  if (Status != LegalizerHelper::Legalized)
+    return false;
+
+  MI.eraseFromParent();
+  return true;
+}
+
+bool AAPLegalizerInfo::legalizeByteLoadStore(
+    MachineInstr &MI, MachineRegisterInfo &MRI,
+    MachineIRBuilder &MIRBuilder) const {
+  using namespace TargetOpcode;
+
+  const LLT s16 = LLT::scalar(16);
+  unsigned ValReg = MI.getOperand(0).getReg();
+  unsigned WideReg = MRI.createGenericVirtualRegister(s16);
+  MI.getOperand(0).setReg(WideReg);
+
+  // The memory operand is unchanged, so the access remains a single byte.
+  if (MI.getOpcode() == G_LOAD) {
+    MIRBuilder.setInsertPt(*MI.getParent(), std::next(MI.getIterator()));
+    MIRBuilder.buildTrunc(ValReg, WideReg);
+  } else {
+    MIRBuilder.setInstr(MI);
+    MIRBuilder.buildAnyExt(WideReg, ValReg);
+  }
+  return true;
+}
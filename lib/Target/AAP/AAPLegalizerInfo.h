@@ -0,0 +1,37 @@
+//===-- AAPLegalizerInfo.h - AAP GlobalISel legalizer -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the MachineLegalizer class for AAP.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_AAP_AAPLEGALIZERINFO_H
+#define LLVM_LIB_TARGET_AAP_AAPLEGALIZERINFO_H
+
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+
+namespace llvm {
+
+class AAPSubtarget;
+
+/// This class provides legalization strategies.
+class AAPLegalizerInfo : public LegalizerInfo {
+public:
+  AAPLegalizerInfo(const AAPSubtarget &ST);
+
+  bool legalizeCustom(MachineInstr &MI, MachineRegisterInfo &MRI,
+                      MachineIRBuilder &MIRBuilder) const override;
+
+private:
+  /// Widen the value of a byte load or store to 16 bits.
+  bool legalizeByteLoadStore(MachineInstr &MI, MachineRegisterInfo &MRI,
+                             MachineIRBuilder &MIRBuilder) const;
+};
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_AAP_AAPLEGALIZERINFO_H
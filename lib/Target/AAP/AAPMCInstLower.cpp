@@ -29,15 +29,20 @@ static MCOperand lowerSymbolOperand(const MachineOperand &MO, MCSymbol *Sym,
                                     const AsmPrinter &AP) {
   MCContext &Ctx = AP.OutContext;
 
-  const MCExpr *Expr = MCSymbolRefExpr::create(Sym, Ctx);
-
+  MCSymbolRefExpr::VariantKind Kind;
   switch (MO.getTargetFlags()) {
   default:
     llvm_unreachable("Unknown target flag on GV operand");
-  case 0:
+  case AAPII::MO_NO_FLAG:
+    Kind = MCSymbolRefExpr::VK_None;
+    break;
+  case AAPII::MO_GPREL:
+    Kind = MCSymbolRefExpr::VK_AAP_GPREL;
     break;
   }
 
+  const MCExpr *Expr = MCSymbolRefExpr::create(Sym, Kind, Ctx);
+
   if (!MO.isJTI() && !MO.isMBB() && MO.getOffset())
     Expr = MCBinaryExpr::createAdd(
         Expr, MCConstantExpr::create(MO.getOffset(), Ctx), Ctx);
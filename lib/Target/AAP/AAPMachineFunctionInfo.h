@@ -38,9 +38,30 @@ class AAPMachineFunctionInfo : public MachineFunctionInfo {
   /// VarArgsFrameIndex - FrameIndex for start of varargs area.
   int VarArgsFrameIndex;
 
+  /// LargeFrame - set when the stack frame is too large for every object to
+  /// be reached from the stack pointer with a 10-bit offset. Such frames use
+  /// the frame pointer as a second base register for the top of the frame.
+  bool LargeFrame;
+
+  /// CalleeSavedFrameSize - size of the area at the top of the frame into
+  /// which the callee saved registers are pushed.
+  unsigned CalleeSavedFrameSize;
+
+  /// SaveRestoreLibCalls - the number of callee saved registers which are
+  /// saved and restored by calls to the shared routines, or zero if they are
+  /// pushed and popped inline.
+  unsigned SaveRestoreLibCalls;
+
+  /// ShrinkWrapped - set when the prologue and epilogue are not in the entry
+  /// and return blocks, so that the link register holds the return address
+  /// outside of the region between them.
+  bool ShrinkWrapped;
+
 public:
   AAPMachineFunctionInfo(MachineFunction &MF)
-      : MF(MF), SRetReturnReg(0), GlobalBaseReg(0), VarArgsFrameIndex(0) {}
+      : MF(MF), SRetReturnReg(0), GlobalBaseReg(0), VarArgsFrameIndex(0),
+        LargeFrame(false), CalleeSavedFrameSize(0), SaveRestoreLibCalls(0),
+        ShrinkWrapped(false) {}
 
   unsigned getSRetReturnReg() const { return SRetReturnReg; }
   void setSRetReturnReg(unsigned Reg) { SRetReturnReg = Reg; }
@@ -49,6 +70,18 @@ public:
 
   int getVarArgsFrameIndex() const { return VarArgsFrameIndex; }
   void setVarArgsFrameIndex(int Index) { VarArgsFrameIndex = Index; }
+
+  bool isLargeFrame() const { return LargeFrame; }
+  void setLargeFrame(bool Large) { LargeFrame = Large; }
+
+  unsigned getCalleeSavedFrameSize() const { return CalleeSavedFrameSize; }
+  void setCalleeSavedFrameSize(unsigned Size) { CalleeSavedFrameSize = Size; }
+
+  unsigned getSaveRestoreLibCalls() const { return SaveRestoreLibCalls; }
+  void setSaveRestoreLibCalls(unsigned Num) { SaveRestoreLibCalls = Num; }
+
+  bool isShrinkWrapped() const { return ShrinkWrapped; }
+  void setShrinkWrapped(bool Wrapped) { ShrinkWrapped = Wrapped; }
 };
 } // namespace llvm
 
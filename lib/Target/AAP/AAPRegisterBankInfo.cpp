@@ -0,0 +1,67 @@
+//===-- AAPRegisterBankInfo.cpp - AAP register bank info ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the RegisterBankInfo class for AAP.
+/// There is a single bank of general purpose registers, which holds integers
+/// and pointers alike.
+//===----------------------------------------------------------------------===//
+
+#include "AAPRegisterBankInfo.h"
+#include "AAPInstrInfo.h"
+#include "MCTargetDesc/AAPMCTargetDesc.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+
+#define GET_TARGET_REGBANK_IMPL
+#include "AAPGenRegisterBank.inc"
+
+using namespace llvm;
+
+namespace llvm {
+namespace AAP {
+RegisterBankInfo::PartialMapping GPRPartialMapping{0, 16, GPRRegBank};
+RegisterBankInfo::ValueMapping GPRValueMapping{&GPRPartialMapping, 1};
+} // end namespace AAP
+} // end namespace llvm
+
+AAPRegisterBankInfo::AAPRegisterBankInfo(const TargetRegisterInfo &TRI)
+    : AAPGenRegisterBankInfo() {}
+
+const RegisterBank &AAPRegisterBankInfo::getRegBankFromRegClass(
+    const TargetRegisterClass &RC) const {
+  switch (RC.getID()) {
+  case AAP::GR64RegClassID:
+  case AAP::GR8RegClassID:
+  case AAP::GRTCRegClassID:
+    return getRegBank(AAP::GPRRegBankID);
+  default:
+    llvm_unreachable("Register class not supported");
+  }
+}
+
+const RegisterBankInfo::InstructionMapping &
+AAPRegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
+  // Copies and target instructions are handled by the default logic.
+  const InstructionMapping &Mapping = getInstrMappingImpl(MI);
+  if (Mapping.isValid())
+    return Mapping;
+
+  // Every value lives in a GPR. Operands which are not registers, such as
+  // the immediate of a G_CONSTANT or the predicate of a G_ICMP, are not
+  // mapped.
+  unsigned NumOperands = MI.getNumOperands();
+  SmallVector<const ValueMapping *, 4> OpdsMapping(NumOperands);
+  for (unsigned i = 0; i != NumOperands; ++i) {
+    const MachineOperand &MO = MI.getOperand(i);
+    if (MO.isReg() && MO.getReg())
+      OpdsMapping[i] = &AAP::GPRValueMapping;
+  }
+
+  return getInstructionMapping(DefaultMappingID, /*Cost=*/1,
+                               getOperandsMapping(OpdsMapping), NumOperands);
+}
@@ -0,0 +1,43 @@
+//===-- AAPRegisterBankInfo.h - AAP register bank info ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the RegisterBankInfo class for AAP.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_AAP_AAPREGISTERBANKINFO_H
+#define LLVM_LIB_TARGET_AAP_AAPREGISTERBANKINFO_H
+
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+
+#define GET_REGBANK_DECLARATIONS
+#include "AAPGenRegisterBank.inc"
+
+namespace llvm {
+
+class TargetRegisterInfo;
+
+class AAPGenRegisterBankInfo : public RegisterBankInfo {
+#define GET_TARGET_REGBANK_CLASS
+#include "AAPGenRegisterBank.inc"
+};
+
+/// This class provides the information for the target register banks.
+class AAPRegisterBankInfo final : public AAPGenRegisterBankInfo {
+public:
+  AAPRegisterBankInfo(const TargetRegisterInfo &TRI);
+
+  const RegisterBank &
+  getRegBankFromRegClass(const TargetRegisterClass &RC) const override;
+
+  const InstructionMapping &
+  getInstrMapping(const MachineInstr &MI) const override;
+};
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_AAP_AAPREGISTERBANKINFO_H
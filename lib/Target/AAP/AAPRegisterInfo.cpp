@@ -30,12 +30,26 @@ AAPRegisterInfo::AAPRegisterInfo() : AAPGenRegisterInfo(getLinkRegister()) {}
 const uint32_t *
 AAPRegisterInfo::getCallPreservedMask(const MachineFunction &MF,
                                       CallingConv::ID CC) const {
-  return CSR_RegMask;
+  switch (CC) {
+  default:
+    return CSR_RegMask;
+  case CallingConv::Fast:
+    return CSR_Fast_RegMask;
+  case CallingConv::Cold:
+    return CSR_Cold_RegMask;
+  }
 }
 
 const MCPhysReg *
 AAPRegisterInfo::getCalleeSavedRegs(const MachineFunction *MF) const {
-  return CSR_SaveList;
+  switch (MF->getFunction().getCallingConv()) {
+  default:
+    return CSR_SaveList;
+  case CallingConv::Fast:
+    return CSR_Fast_SaveList;
+  case CallingConv::Cold:
+    return CSR_Cold_SaveList;
+  }
 }
 
 BitVector AAPRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
@@ -47,9 +61,58 @@ BitVector AAPRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
   if (TFI->hasFP(MF))
     Reserved.set(getFramePtrRegister());
 
+  // The global pointer is set up by the startup code to point into the small
+  // data area. Code built without small data may clobber it, so every object
+  // in the program must agree on the feature, see FeatureSmallData.
+  if (MF.getSubtarget<AAPSubtarget>().useSmallData())
+    Reserved.set(getGlobalPtrRegister());
+
   return Reserved;
 }
 
+bool AAPRegisterInfo::getRegAllocationHints(unsigned VirtReg,
+                                            ArrayRef<MCPhysReg> Order,
+                                            SmallVectorImpl<MCPhysReg> &Hints,
+                                            const MachineFunction &MF,
+                                            const VirtRegMap *VRM,
+                                            const LiveRegMatrix *Matrix) const {
+  const MachineRegisterInfo &MRI = MF.getRegInfo();
+  unsigned HintType = MRI.getRegAllocationHint(VirtReg).first;
+
+  // Copy hints are always preferred
+  TargetRegisterInfo::getRegAllocationHints(VirtReg, Order, Hints, MF, VRM,
+                                            Matrix);
+
+  // The allocation order puts callee saved registers, which include most of
+  // R0-R7, last. Move the short encodable registers to the front for
+  // registers which are used frequently by instructions with short forms.
+  if (HintType == AAPRI::RegHintShort) {
+    for (MCPhysReg Reg : Order)
+      if (AAP::GR8RegClass.contains(Reg) && !is_contained(Hints, Reg))
+        Hints.push_back(Reg);
+  }
+  return false;
+}
+
+void AAPRegisterInfo::updateRegAllocHint(unsigned Reg, unsigned NewReg,
+                                         MachineFunction &MF) const {
+  // Registers created by PHI elimination and two address lowering have no
+  // hint, so keep the short hint when one of them is coalesced with Reg.
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  if (!TargetRegisterInfo::isVirtualRegister(NewReg) ||
+      MRI.getRegAllocationHint(Reg).first != AAPRI::RegHintShort ||
+      MRI.getRegAllocationHint(NewReg).first != 0)
+    return;
+
+  // The first entry of a target hint is its preferred register, so the
+  // existing simple hints of NewReg follow a null preferred register.
+  SmallVector<unsigned, 4> SimpleHints(
+      MRI.getRegAllocationHints(NewReg).second);
+  MRI.setRegAllocationHint(NewReg, AAPRI::RegHintShort, 0);
+  for (unsigned Hint : SimpleHints)
+    MRI.addRegAllocationHint(NewReg, Hint);
+}
+
 void AAPRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator MBBI,
                                           int SPAdj, unsigned FIOperandNum,
                                           RegScavenger *RS) const {
@@ -142,3 +205,4 @@ void AAPRegisterInfo::adjustReg(MachineBasicBlock &MBB,
 unsigned AAPRegisterInfo::getLinkRegister() { return AAP::R0; }
 unsigned AAPRegisterInfo::getStackPtrRegister() { return AAP::R1; }
 unsigned AAPRegisterInfo::getFramePtrRegister() { return AAP::R8; }
+unsigned AAPRegisterInfo::getGlobalPtrRegister() { return AAP::R9; }
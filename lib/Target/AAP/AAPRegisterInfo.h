@@ -20,6 +20,14 @@
 #include "AAPGenRegisterInfo.inc"
 
 namespace llvm {
+namespace AAPRI {
+// Target specific register allocation hint types
+enum {
+  // Prefer R0-R7, so that users of the register may use short encodings
+  RegHintShort = 1
+};
+} // namespace AAPRI
+
 class AAPRegisterInfo : public AAPGenRegisterInfo {
 public:
   AAPRegisterInfo();
@@ -32,6 +40,18 @@ public:
 
   BitVector getReservedRegs(const MachineFunction &MF) const override;
 
+  // Copy hints are kept alongside the AAPRI::RegHintShort target hint
+  bool enableMultipleCopyHints() const override { return true; }
+
+  bool getRegAllocationHints(unsigned VirtReg, ArrayRef<MCPhysReg> Order,
+                             SmallVectorImpl<MCPhysReg> &Hints,
+                             const MachineFunction &MF,
+                             const VirtRegMap *VRM,
+                             const LiveRegMatrix *Matrix) const override;
+
+  void updateRegAllocHint(unsigned Reg, unsigned NewReg,
+                          MachineFunction &MF) const override;
+
   void eliminateFrameIndex(MachineBasicBlock::iterator II, int SPAdj,
                            unsigned FIOperandNum,
                            RegScavenger *RS = nullptr) const override;
@@ -47,6 +67,11 @@ public:
     return true;
   }
 
+  // The PostRA MachineScheduler needs accurate liveness.
+  bool trackLivenessAfterRegAlloc(const MachineFunction &MF) const override {
+    return true;
+  }
+
   static void adjustReg(MachineBasicBlock &MBB,
                         MachineBasicBlock::iterator MBBI, const DebugLoc &DL,
                         unsigned DestReg, unsigned SrcReg, int64_t Val,
@@ -55,6 +80,7 @@ public:
   static unsigned getLinkRegister();
   static unsigned getStackPtrRegister();
   static unsigned getFramePtrRegister();
+  static unsigned getGlobalPtrRegister();
 };
 }
 
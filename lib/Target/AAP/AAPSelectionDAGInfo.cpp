@@ -0,0 +1,86 @@
+//===-- AAPSelectionDAGInfo.cpp - AAP SelectionDAG Info -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the AAPSelectionDAGInfo class.
+//
+// Copies and sets of up to MaxStoresPerMemcpy/MaxStoresPerMemset words are
+// unrolled by the generic code before these hooks are reached. Anything
+// larger, or of unknown size, is emitted as a MEMCPY_LOOP or MEMSET_LOOP node
+// which is expanded into a post-increment load/store loop by
+// AAPTargetLowering::EmitMemLoop.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AAPSelectionDAGInfo.h"
+#include "AAPISelLowering.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "aap-selectiondag-info"
+
+// Decide whether a copy or set should be expanded inline, returning false if
+// it should be left to the runtime library. A loop is a few instructions
+// longer than a call, so only the smallest code is left to the library.
+static bool shouldEmitMemLoop(SelectionDAG &DAG, SDValue Size, unsigned Align,
+                              bool isVolatile) {
+  if (isVolatile || DAG.getMachineFunction().getFunction().optForMinSize())
+    return false;
+
+  // A loop of known size must run at least once
+  ConstantSDNode *ConstSize = dyn_cast<ConstantSDNode>(Size);
+  if (ConstSize && ConstSize->getZExtValue() < std::min(Align, 2u))
+    return false;
+  return true;
+}
+
+static SDValue getMemLoopNode(SelectionDAG &DAG, const SDLoc &dl,
+                              unsigned Opcode, SDValue Chain, SDValue Dst,
+                              SDValue Src, SDValue Size, unsigned Align) {
+  // A known size is passed on as well, so that the loop need not check for
+  // zero iterations or a trailing byte. Zero means the size is unknown.
+  uint64_t KnownSize = 0;
+  if (ConstantSDNode *ConstSize = dyn_cast<ConstantSDNode>(Size))
+    KnownSize = ConstSize->getZExtValue();
+
+  SDValue Ops[] = {Chain, Dst, Src, DAG.getZExtOrTrunc(Size, dl, MVT::i16),
+                   DAG.getTargetConstant(KnownSize, dl, MVT::i16),
+                   DAG.getTargetConstant(Align, dl, MVT::i16)};
+  return DAG.getNode(Opcode, dl, MVT::Other, Ops);
+}
+
+SDValue AAPSelectionDAGInfo::EmitTargetCodeForMemcpy(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst, SDValue Src,
+    SDValue Size, unsigned Align, bool isVolatile, bool AlwaysInline,
+    MachinePointerInfo DstPtrInfo, MachinePointerInfo SrcPtrInfo) const {
+  if (!AlwaysInline && !shouldEmitMemLoop(DAG, Size, Align, isVolatile))
+    return SDValue();
+
+  return getMemLoopNode(DAG, dl, AAPISD::MEMCPY_LOOP, Chain, Dst, Src, Size,
+                        Align);
+}
+
+SDValue AAPSelectionDAGInfo::EmitTargetCodeForMemset(
+    SelectionDAG &DAG, const SDLoc &dl, SDValue Chain, SDValue Dst, SDValue Src,
+    SDValue Size, unsigned Align, bool isVolatile,
+    MachinePointerInfo DstPtrInfo) const {
+  if (!shouldEmitMemLoop(DAG, Size, Align, isVolatile))
+    return SDValue();
+
+  // Word stores need the byte value splatted into both halves
+  SDValue Val = DAG.getZExtOrTrunc(Src, dl, MVT::i8);
+  Val = DAG.getNode(ISD::ZERO_EXTEND, dl, MVT::i16, Val);
+  if (Align >= 2)
+    Val = DAG.getNode(ISD::OR, dl, MVT::i16, Val,
+                      DAG.getNode(ISD::SHL, dl, MVT::i16, Val,
+                                  DAG.getConstant(8, dl, MVT::i16)));
+
+  return getMemLoopNode(DAG, dl, AAPISD::MEMSET_LOOP, Chain, Dst, Val, Size,
+                        Align);
+}
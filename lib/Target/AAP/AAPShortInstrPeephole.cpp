@@ -9,16 +9,32 @@
 //
 // Simple pass to replace long instructions with shorter equivalents
 //
+// Instructions are shortened using the CompressPat patterns in
+// AAPInstrInfo.td, the same patterns the AsmPrinter applies as it emits them.
+// Applying them here as well means the size of each instruction is known to
+// the passes which run before emission. Branches, and indexed loads and stores
+// with an explicit writeback, which the patterns do not cover, are handled
+// here.
+//
+// Branches to blocks are shortened last, once the size of every other
+// instruction is known, when the displacement to their target is in range of
+// the short form.
+//
 //===----------------------------------------------------------------------===//
 
 #include "AAP.h"
+#include "AAPInstrInfo.h"
 #include "AAPRegisterInfo.h"
 #include "AAPTargetMachine.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineOperand.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInst.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/MathExtras.h"
 
@@ -26,6 +42,11 @@
 
 using namespace llvm;
 
+STATISTIC(NumShortened, "Number of instructions replaced with a short form");
+STATISTIC(NumMissed, "Number of instructions with a short form left long");
+STATISTIC(NumShortBranches, "Number of branches to blocks using a short form");
+STATISTIC(NumLongBranches, "Number of branches to blocks left long");
+
 namespace {
 class ShortInstrPeephole : public MachineFunctionPass {
 public:
@@ -44,32 +65,132 @@ private:
   const MCInstrInfo &MII;
 
   bool runOnInstruction(MachineInstr &MI) const;
+  bool shortenBranches(MachineFunction &MF) const;
 
-  bool updateMOV_r(MachineInstr &MI) const;
-  bool updateMOVI_i16(MachineInstr &MI) const;
-  bool updateNOP(MachineInstr &MI) const;
-  bool updateALU_r(MachineInstr &MI) const;
-  bool updateARITH_i10(MachineInstr &MI) const;
-  bool updateSHIFT_i6(MachineInstr &MI) const;
-  bool updateLD(MachineInstr &MI) const;
-  bool updateST(MachineInstr &MI) const;
+  bool compress(MachineInstr &MI) const;
+  void removeWriteback(MachineInstr &MI, unsigned OpNo, unsigned Opcode) const;
+
+  bool updateLD_wb(MachineInstr &MI) const;
+  bool updateST_wb(MachineInstr &MI) const;
   bool updateBRA(MachineInstr &MI) const;
   bool updateBAL(MachineInstr &MI) const;
-  bool updateJMP(MachineInstr &MI) const;
-  bool updateJAL(MachineInstr &MI) const;
 };
 
 char ShortInstrPeephole::ID = 0;
 } // namespace
 
+// Return true if MI is a direct branch to a block. Returns and other indirect
+// branches do not necessarily have a first operand.
+static bool isBranchToBlock(const MachineInstr &MI) {
+  return MI.isBranch() && !MI.isIndirectBranch() && MI.getOperand(0).isMBB();
+}
+
 bool ShortInstrPeephole::runOnMachineFunction(MachineFunction &MF) {
   bool Changed = false;
 
-  for (MachineBasicBlock &MBB : MF)
-    for (MachineInstr &MI : MBB)
+  for (MachineBasicBlock &MBB : MF) {
+    for (MachineInstr &MI : MBB) {
+      // Branches to blocks are counted once shortenBranches has run.
+      bool Candidate = AAPInstrInfo::hasShortForm(MI.getOpcode()) &&
+                       !isBranchToBlock(MI);
       if (runOnInstruction(MI))
         Changed = true;
 
+      if (Candidate) {
+        if (MI.getDesc().getSize() == 2)
+          ++NumShortened;
+        else
+          ++NumMissed;
+      }
+    }
+  }
+
+  if (shortenBranches(MF))
+    Changed = true;
+
+  return Changed;
+}
+
+// Return the short form of a branch to a block, if the displacement and its
+// register operands fit it.
+static unsigned getShortBranchOpcode(const MachineInstr &MI, int64_t BrOffset) {
+  auto IsShortReg = [&MI](unsigned OpNo) {
+    return AAP::GR8RegClass.contains(MI.getOperand(OpNo).getReg());
+  };
+
+  unsigned Opcode;
+  switch (MI.getOpcode()) {
+  default:
+    return 0;
+  case AAP::BRA:
+    return isInt<9>(BrOffset) ? AAP::BRA_short : 0;
+  case AAP::BEQ_:
+    Opcode = AAP::BEQ_short;
+    break;
+  case AAP::BNE_:
+    Opcode = AAP::BNE_short;
+    break;
+  case AAP::BLTS_:
+    Opcode = AAP::BLTS_short;
+    break;
+  case AAP::BLES_:
+    Opcode = AAP::BLES_short;
+    break;
+  case AAP::BLTU_:
+    Opcode = AAP::BLTU_short;
+    break;
+  case AAP::BLEU_:
+    Opcode = AAP::BLEU_short;
+    break;
+  }
+  return isInt<3>(BrOffset) && IsShortReg(1) && IsShortReg(2) ? Opcode : 0;
+}
+
+// Shorten the branches to blocks which are in range of the short form, given
+// the offsets of the blocks computed from the current instruction sizes.
+// Shortening a branch can only bring others closer to their targets, so each
+// branch which is in range remains so, and this is repeated until no more
+// branches come into range.
+bool ShortInstrPeephole::shortenBranches(MachineFunction &MF) const {
+  const TargetInstrInfo &TII = *MF.getSubtarget().getInstrInfo();
+  DenseMap<const MachineBasicBlock *, int64_t> BlockOffsets;
+  bool Changed = false;
+  bool Shortened;
+
+  do {
+    int64_t Offset = 0;
+    for (const MachineBasicBlock &MBB : MF) {
+      BlockOffsets[&MBB] = Offset;
+      for (const MachineInstr &MI : MBB)
+        Offset += TII.getInstSizeInBytes(MI);
+    }
+
+    Shortened = false;
+    for (MachineBasicBlock &MBB : MF) {
+      Offset = BlockOffsets[&MBB];
+      for (MachineInstr &MI : MBB) {
+        if (isBranchToBlock(MI)) {
+          int64_t BrOffset = BlockOffsets[MI.getOperand(0).getMBB()] - Offset;
+          if (unsigned Opcode = getShortBranchOpcode(MI, BrOffset)) {
+            MI.setDesc(MII.get(Opcode));
+            Shortened = true;
+          }
+        }
+        Offset += TII.getInstSizeInBytes(MI);
+      }
+    }
+    Changed |= Shortened;
+  } while (Shortened);
+
+  for (const MachineBasicBlock &MBB : MF)
+    for (const MachineInstr &MI : MBB)
+      if (isBranchToBlock(MI)) {
+        if (MI.getDesc().getSize() == 2)
+          ++NumShortBranches;
+        else
+          ++NumLongBranches;
+      }
+
   return Changed;
 }
 
@@ -79,251 +200,113 @@ FunctionPass *llvm::createAAPShortInstrPeepholePass(AAPTargetMachine &TM) {
 
 bool ShortInstrPeephole::runOnInstruction(MachineInstr &MI) const {
   switch (MI.getOpcode()) {
-  case AAP::MOV_r:
-    return updateMOV_r(MI);
-  case AAP::MOVI_i16:
-    return updateMOVI_i16(MI);
-  case AAP::NOP:
-    return updateNOP(MI);
-
-  case AAP::ADD_r:
-  case AAP::AND_r:
-  case AAP::OR_r:
-  case AAP::XOR_r:
-  case AAP::SUB_r:
-  case AAP::ASR_r:
-  case AAP::LSL_r:
-  case AAP::LSR_r:
-    return updateALU_r(MI);
-
-  case AAP::ADDI_i10:
-  case AAP::SUBI_i10:
-    return updateARITH_i10(MI);
-
-  case AAP::ASRI_i6:
-  case AAP::LSLI_i6:
-  case AAP::LSRI_i6:
-    return updateSHIFT_i6(MI);
-
-  case AAP::LDB:
-  case AAP::LDW:
-  case AAP::LDB_postinc:
-  case AAP::LDW_postinc:
-  case AAP::LDB_predec:
-  case AAP::LDW_predec:
-    return updateLD(MI);
-
-  case AAP::STB:
-  case AAP::STW:
-  case AAP::STB_postinc:
-  case AAP::STW_postinc:
-  case AAP::STB_predec:
-  case AAP::STW_predec:
-    return updateST(MI);
+  case AAP::LDB_postinc_wb:
+  case AAP::LDW_postinc_wb:
+  case AAP::LDB_predec_wb:
+  case AAP::LDW_predec_wb:
+    return updateLD_wb(MI);
+
+  case AAP::STB_postinc_wb:
+  case AAP::STW_postinc_wb:
+  case AAP::STB_predec_wb:
+  case AAP::STW_predec_wb:
+    return updateST_wb(MI);
 
   case AAP::BRA:
     return updateBRA(MI);
   case AAP::BAL:
     return updateBAL(MI);
-  case AAP::JAL:
-    return updateJAL(MI);
-  case AAP::JMP:
-    return updateJMP(MI);
 
   default:
-    return false;
-  }
-}
-
-bool ShortInstrPeephole::updateMOV_r(MachineInstr &MI) const {
-  unsigned DstReg = MI.getOperand(0).getReg();
-  unsigned SrcReg = MI.getOperand(1).getReg();
-
-  if (AAP::GR8RegClass.contains(DstReg) && AAP::GR8RegClass.contains(SrcReg)) {
-    MI.setDesc(MII.get(AAP::MOV_r_short));
-    return true;
-  }
-  return false;
-}
-
-bool ShortInstrPeephole::updateMOVI_i16(MachineInstr &MI) const {
-  unsigned DstReg = MI.getOperand(0).getReg();
-  const MachineOperand &Imm = MI.getOperand(1);
-
-  if (AAP::GR8RegClass.contains(DstReg) && Imm.isImm() &&
-      isUInt<6>(Imm.getImm())) {
-    MI.setDesc(MII.get(AAP::MOVI_i6_short));
-    return true;
-  }
-  return false;
-}
-
-bool ShortInstrPeephole::updateNOP(MachineInstr &MI) const {
-  unsigned SrcReg = MI.getOperand(0).getReg();
-  int64_t Imm = MI.getOperand(1).getImm();
-
-  if (AAP::GR8RegClass.contains(SrcReg) && isUInt<6>(Imm)) {
-    MI.setDesc(MII.get(AAP::NOP_short));
-    return true;
+    return compress(MI);
   }
-  return false;
 }
 
-bool ShortInstrPeephole::updateALU_r(MachineInstr &MI) const {
-  unsigned DstReg = MI.getOperand(0).getReg();
-  unsigned Op1Reg = MI.getOperand(1).getReg();
-  unsigned Op2Reg = MI.getOperand(2).getReg();
-
-  if (AAP::GR8RegClass.contains(DstReg) && AAP::GR8RegClass.contains(Op1Reg) &&
-      AAP::GR8RegClass.contains(Op2Reg)) {
-    unsigned Opcode = MI.getOpcode();
-    switch (Opcode) {
-    case AAP::ADD_r:
-      Opcode = AAP::ADD_r_short;
-      break;
-    case AAP::AND_r:
-      Opcode = AAP::AND_r_short;
-      break;
-    case AAP::OR_r:
-      Opcode = AAP::OR_r_short;
-      break;
-    case AAP::XOR_r:
-      Opcode = AAP::XOR_r_short;
-      break;
-    case AAP::SUB_r:
-      Opcode = AAP::SUB_r_short;
-      break;
-    case AAP::ASR_r:
-      Opcode = AAP::ASR_r_short;
-      break;
-    case AAP::LSL_r:
-      Opcode = AAP::LSL_r_short;
-      break;
-    case AAP::LSR_r:
-      Opcode = AAP::LSR_r_short;
-      break;
-    default:
-      llvm_unreachable("Unknown opcode");
-    }
-    MI.setDesc(MII.get(Opcode));
-    return true;
+#define GEN_COMPRESS_INSTR
+#include "AAPGenCompressInstEmitter.inc"
+
+// Replace MI with its short form if a CompressPat pattern applies to it. Each
+// short form takes the same operands as its long form, so only the
+// description needs to change.
+bool ShortInstrPeephole::compress(MachineInstr &MI) const {
+  MCInst Inst, ShortInst;
+  Inst.setOpcode(MI.getOpcode());
+  for (const MachineOperand &MO : MI.explicit_operands()) {
+    if (MO.isReg())
+      Inst.addOperand(MCOperand::createReg(MO.getReg()));
+    else if (MO.isImm())
+      Inst.addOperand(MCOperand::createImm(MO.getImm()));
+    else
+      return false;
   }
-  return false;
-}
 
-bool ShortInstrPeephole::updateARITH_i10(MachineInstr &MI) const {
-  unsigned DstReg = MI.getOperand(0).getReg();
-  unsigned SrcReg = MI.getOperand(1).getReg();
-  const MachineOperand &Imm = MI.getOperand(2);
-
-  if (AAP::GR8RegClass.contains(DstReg, SrcReg) && Imm.isImm() &&
-      isUInt<3>(Imm.getImm())) {
-    unsigned Opcode = MI.getOpcode();
-    switch (Opcode) {
-    case AAP::ADDI_i10:
-      Opcode = AAP::ADDI_i3_short;
-      break;
-    case AAP::SUBI_i10:
-      Opcode = AAP::SUBI_i3_short;
-      break;
-    }
-    MI.setDesc(MII.get(Opcode));
-    return true;
-  }
-  return false;
+  const MachineFunction &MF = *MI.getMF();
+  if (!compressInst(ShortInst, Inst, MF.getSubtarget(), MF.getContext()))
+    return false;
+  assert(ShortInst.getNumOperands() == Inst.getNumOperands() &&
+         "short form takes different operands");
+  MI.setDesc(MII.get(ShortInst.getOpcode()));
+  return true;
 }
 
-bool ShortInstrPeephole::updateSHIFT_i6(MachineInstr &MI) const {
-  unsigned DstReg = MI.getOperand(0).getReg();
-  unsigned SrcReg = MI.getOperand(1).getReg();
-  const MachineOperand &Imm = MI.getOperand(2);
-
-  if (AAP::GR8RegClass.contains(DstReg, SrcReg) && Imm.isImm() &&
-      isUInt<3>(Imm.getImm() - 1)) {
-    unsigned Opcode = MI.getOpcode();
-    switch (Opcode) {
-    case AAP::ASRI_i6:
-      Opcode = AAP::ASRI_i3_short;
-      break;
-    case AAP::LSLI_i6:
-      Opcode = AAP::LSLI_i3_short;
-      break;
-    case AAP::LSRI_i6:
-      Opcode = AAP::LSRI_i3_short;
-      break;
-    }
-    MI.setDesc(MII.get(Opcode));
-    return true;
-  }
-  return false;
+// Indexed loads and stores are selected with an explicit def of the updated
+// base register. Replace them with the equivalent instruction, which defines
+// the base register implicitly, so that they can be shortened.
+void ShortInstrPeephole::removeWriteback(MachineInstr &MI, unsigned OpNo,
+                                         unsigned Opcode) const {
+  MachineOperand WB = MI.getOperand(OpNo);
+  MI.untieRegOperand(OpNo);
+  MI.RemoveOperand(OpNo);
+  MI.setDesc(MII.get(Opcode));
+  MI.addOperand(MachineOperand::CreateReg(WB.getReg(), /*isDef=*/true,
+                                          /*isImp=*/true, /*isKill=*/false,
+                                          WB.isDead()));
 }
 
-bool ShortInstrPeephole::updateLD(MachineInstr &MI) const {
-  unsigned DstReg = MI.getOperand(0).getReg();
-  unsigned BaseReg = MI.getOperand(1).getReg();
-  const MachineOperand &Offset = MI.getOperand(2);
-
-  if (AAP::GR8RegClass.contains(DstReg) && AAP::GR8RegClass.contains(BaseReg) &&
-      Offset.isImm() && isInt<3>(Offset.getImm())) {
-    unsigned Opcode = MI.getOpcode();
-    switch (Opcode) {
-    case AAP::LDB:
-      Opcode = AAP::LDB_short;
-      break;
-    case AAP::LDW:
-      Opcode = AAP::LDW_short;
-      break;
-    case AAP::LDB_postinc:
-      Opcode = AAP::LDB_postinc_short;
-      break;
-    case AAP::LDW_postinc:
-      Opcode = AAP::LDW_postinc_short;
-      break;
-    case AAP::LDB_predec:
-      Opcode = AAP::LDB_predec_short;
-      break;
-    case AAP::LDW_predec:
-      Opcode = AAP::LDW_predec_short;
-      break;
-    }
-    MI.setDesc(MII.get(Opcode));
-    return true;
+bool ShortInstrPeephole::updateLD_wb(MachineInstr &MI) const {
+  unsigned Opcode = MI.getOpcode();
+  switch (Opcode) {
+  case AAP::LDB_postinc_wb:
+    Opcode = AAP::LDB_postinc;
+    break;
+  case AAP::LDW_postinc_wb:
+    Opcode = AAP::LDW_postinc;
+    break;
+  case AAP::LDB_predec_wb:
+    Opcode = AAP::LDB_predec;
+    break;
+  case AAP::LDW_predec_wb:
+    Opcode = AAP::LDW_predec;
+    break;
+  default:
+    llvm_unreachable("Unknown opcode");
   }
-  return false;
+  removeWriteback(MI, 1, Opcode);
+  compress(MI);
+  return true;
 }
 
-bool ShortInstrPeephole::updateST(MachineInstr &MI) const {
-  unsigned BaseReg = MI.getOperand(0).getReg();
-  const MachineOperand &Offset = MI.getOperand(1);
-  unsigned SrcReg = MI.getOperand(2).getReg();
-
-  if (AAP::GR8RegClass.contains(BaseReg) && Offset.isImm() &&
-      isInt<3>(Offset.getImm()) && AAP::GR8RegClass.contains(SrcReg)) {
-    unsigned Opcode = MI.getOpcode();
-    switch (Opcode) {
-    case AAP::STB:
-      Opcode = AAP::STB_short;
-      break;
-    case AAP::STW:
-      Opcode = AAP::STW_short;
-      break;
-    case AAP::STB_postinc:
-      Opcode = AAP::STB_postinc_short;
-      break;
-    case AAP::STW_postinc:
-      Opcode = AAP::STW_postinc_short;
-      break;
-    case AAP::STB_predec:
-      Opcode = AAP::STB_predec_short;
-      break;
-    case AAP::STW_predec:
-      Opcode = AAP::STW_predec_short;
-      break;
-    }
-    MI.setDesc(MII.get(Opcode));
-    return true;
+bool ShortInstrPeephole::updateST_wb(MachineInstr &MI) const {
+  unsigned Opcode = MI.getOpcode();
+  switch (Opcode) {
+  case AAP::STB_postinc_wb:
+    Opcode = AAP::STB_postinc;
+    break;
+  case AAP::STW_postinc_wb:
+    Opcode = AAP::STW_postinc;
+    break;
+  case AAP::STB_predec_wb:
+    Opcode = AAP::STB_predec;
+    break;
+  case AAP::STW_predec_wb:
+    Opcode = AAP::STW_predec;
+    break;
+  default:
+    llvm_unreachable("Unknown opcode");
   }
-  return false;
+  removeWriteback(MI, 0, Opcode);
+  compress(MI);
+  return true;
 }
 
 bool ShortInstrPeephole::updateBRA(MachineInstr &MI) const {
@@ -347,24 +330,3 @@ bool ShortInstrPeephole::updateBAL(MachineInstr &MI) const {
   }
   return false;
 }
-
-bool ShortInstrPeephole::updateJMP(MachineInstr &MI) const {
-  unsigned LinkReg = MI.getOperand(0).getReg();
-
-  if (AAP::GR8RegClass.contains(LinkReg)) {
-    MI.setDesc(MII.get(AAP::JMP_short));
-    return true;
-  }
-  return false;
-}
-
-bool ShortInstrPeephole::updateJAL(MachineInstr &MI) const {
-  unsigned TargetReg = MI.getOperand(0).getReg();
-  unsigned LinkReg = MI.getOperand(1).getReg();
-
-  if (AAP::GR8RegClass.contains(TargetReg, LinkReg)) {
-    MI.setDesc(MII.get(AAP::JAL_short));
-    return true;
-  }
-  return false;
-}
@@ -0,0 +1,117 @@
+//===-------- AAPShortRegHints.cpp - Hint registers into R0-R7 -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// The short instruction peephole can only use a 16-bit encoding when all of
+// the register operands of an instruction are in R0-R7. This pass runs before
+// register allocation and weights each virtual register by the frequency of
+// the blocks in which it is used by instructions with a short form. Registers
+// which are used often enough are hinted towards R0-R7, see
+// AAPRegisterInfo::getRegAllocationHints.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AAP.h"
+#include "AAPInstrInfo.h"
+#include "AAPRegisterInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "aap-short-reg-hints"
+
+using namespace llvm;
+
+STATISTIC(NumHinted, "Number of virtual registers hinted to R0-R7");
+
+// All of R0-R7 other than the stack pointer are callee saved, so a hint may
+// cost a save and restore in every call. The default requires a register to
+// be used by short form candidates at least twice as often as that.
+static cl::opt<unsigned> ShortHintThreshold(
+    "aap-short-hint-threshold", cl::Hidden, cl::init(400),
+    cl::desc("Frequency weighted number of uses by instructions with a short "
+             "form, as a percentage of the entry block frequency, above which "
+             "a register is hinted to R0-R7"));
+
+namespace {
+class AAPShortRegHints : public MachineFunctionPass {
+public:
+  static char ID;
+
+  AAPShortRegHints() : MachineFunctionPass(ID) {}
+
+  StringRef getPassName() const override {
+    return "AAP Short Encoding Register Hints";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+};
+
+char AAPShortRegHints::ID = 0;
+} // namespace
+
+bool AAPShortRegHints::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()))
+    return false;
+
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const MachineBlockFrequencyInfo &MBFI =
+      getAnalysis<MachineBlockFrequencyInfo>();
+
+  // Accumulate the frequency, relative to the entry block, of each use or def
+  // of a virtual register by an instruction which could be shortened.
+  DenseMap<unsigned, double> Weights;
+  double EntryFreq = MBFI.getEntryFreq();
+  for (MachineBasicBlock &MBB : MF) {
+    double Freq = MBFI.getBlockFreq(&MBB).getFrequency() / EntryFreq;
+    for (MachineInstr &MI : MBB) {
+      if (!AAPInstrInfo::hasShortForm(MI.getOpcode()))
+        continue;
+      for (const MachineOperand &MO : MI.operands()) {
+        if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+          continue;
+        Weights[MO.getReg()] += Freq;
+      }
+    }
+  }
+
+  double Threshold = ShortHintThreshold / 100.0;
+  bool Changed = false;
+  for (const auto &W : Weights) {
+    unsigned Reg = W.first;
+    if (W.second < Threshold)
+      continue;
+
+    // Registers already constrained to GR8 need no hint, and existing hints
+    // are left in place.
+    if (MRI.getRegClass(Reg) != &AAP::GR64RegClass ||
+        !MRI.getRegAllocationHints(Reg).second.empty())
+      continue;
+
+    LLVM_DEBUG(dbgs() << "Hinting " << printReg(Reg) << " to R0-R7, weight "
+                      << W.second << "\n");
+    MRI.setRegAllocationHint(Reg, AAPRI::RegHintShort, 0);
+    ++NumHinted;
+    Changed = true;
+  }
+  return Changed;
+}
+
+FunctionPass *llvm::createAAPShortRegHintsPass() {
+  return new AAPShortRegHints();
+}
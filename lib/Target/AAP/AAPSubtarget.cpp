@@ -12,6 +12,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "AAPSubtarget.h"
+#include "AAP.h"
+#include "AAPCallLowering.h"
+#include "AAPLegalizerInfo.h"
+#include "AAPRegisterBankInfo.h"
+#include "AAPTargetMachine.h"
 #include "llvm/Support/TargetRegistry.h"
 
 #define DEBUG_TYPE "aap-subtarget"
@@ -24,7 +29,44 @@ using namespace llvm;
 
 void AAPSubtarget::anchor() {}
 
+AAPSubtarget &AAPSubtarget::initializeSubtargetDependencies(StringRef CPU,
+                                                              StringRef FS) {
+  std::string CPUName = CPU;
+  if (CPUName.empty())
+    CPUName = "generic";
+
+  // The generated ParseSubtargetFeatures only selects the processor model
+  // when the target defines subtarget features, so select it here.
+  InitMCProcessorInfo(CPUName, FS);
+  ParseSubtargetFeatures(CPUName, FS);
+  return *this;
+}
+
 AAPSubtarget::AAPSubtarget(const Triple &TT, const std::string &CPU,
                            const std::string &FS, const TargetMachine &TM)
     : AAPGenSubtargetInfo(TT, CPU, FS), FrameLowering(), InstrInfo(), RegInfo(),
-      TLInfo(TM, *this), TSInfo() {}
+      TLInfo(TM, initializeSubtargetDependencies(CPU, FS)), TSInfo() {
+  CallLoweringInfo.reset(new AAPCallLowering(TLInfo));
+  Legalizer.reset(new AAPLegalizerInfo(*this));
+
+  auto *RBI = new AAPRegisterBankInfo(RegInfo);
+  RegBankInfo.reset(RBI);
+  InstSelector.reset(createAAPInstructionSelector(
+      static_cast<const AAPTargetMachine &>(TM), *this, *RBI));
+}
+
+const CallLowering *AAPSubtarget::getCallLowering() const {
+  return CallLoweringInfo.get();
+}
+
+const LegalizerInfo *AAPSubtarget::getLegalizerInfo() const {
+  return Legalizer.get();
+}
+
+const RegisterBankInfo *AAPSubtarget::getRegBankInfo() const {
+  return RegBankInfo.get();
+}
+
+const InstructionSelector *AAPSubtarget::getInstructionSelector() const {
+  return InstSelector.get();
+}
@@ -18,7 +18,11 @@
 #include "AAPISelLowering.h"
 #include "AAPInstrInfo.h"
 #include "AAPRegisterInfo.h"
-#include "llvm/CodeGen/SelectionDAGTargetInfo.h"
+#include "AAPSelectionDAGInfo.h"
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 
 #define GET_SUBTARGETINFO_HEADER
@@ -27,12 +31,26 @@
 namespace llvm {
 class AAPSubtarget : public AAPGenSubtargetInfo {
   virtual void anchor();
+  // Subtarget features, these must be declared before the members which are
+  // initialized with the parsed features.
+  bool EnableLinkerRelax = false;
+  bool HasMul = false;
+  bool HasDiv = false;
+  bool HasMAC = false;
+  bool UseSmallData = false;
+  bool EnableSaveRestore = false;
+
   AAPFrameLowering FrameLowering;
   AAPInstrInfo InstrInfo;
   AAPRegisterInfo RegInfo;
   AAPTargetLowering TLInfo;
-  SelectionDAGTargetInfo TSInfo;
+  AAPSelectionDAGInfo TSInfo;
 
+  // GlobalISel related APIs.
+  std::unique_ptr<CallLowering> CallLoweringInfo;
+  std::unique_ptr<LegalizerInfo> Legalizer;
+  std::unique_ptr<RegisterBankInfo> RegBankInfo;
+  std::unique_ptr<InstructionSelector> InstSelector;
 
 public:
   /// This constructor initializes the data members to match that
@@ -44,6 +62,19 @@ public:
   /// subtarget options.  Definition of function is auto generated by tblgen.
   void ParseSubtargetFeatures(StringRef CPU, StringRef FS);
 
+  /// initializeSubtargetDependencies - Selects the processor model and
+  /// parses the feature string, defaulting to the generic processor.
+  AAPSubtarget &initializeSubtargetDependencies(StringRef CPU, StringRef FS);
+
+  bool enableMachineScheduler() const override { return true; }
+
+  bool enableLinkerRelax() const { return EnableLinkerRelax; }
+  bool hasMul() const { return HasMul; }
+  bool hasDiv() const { return HasDiv; }
+  bool hasMAC() const { return HasMAC; }
+  bool useSmallData() const { return UseSmallData; }
+  bool enableSaveRestore() const { return EnableSaveRestore; }
+
   const AAPFrameLowering *getFrameLowering() const override {
     return &FrameLowering;
   }
@@ -54,9 +85,14 @@ public:
   const AAPTargetLowering *getTargetLowering() const override {
     return &TLInfo;
   }
-  const SelectionDAGTargetInfo *getSelectionDAGInfo() const override {
+  const AAPSelectionDAGInfo *getSelectionDAGInfo() const override {
     return &TSInfo;
   }
+
+  const CallLowering *getCallLowering() const override;
+  const LegalizerInfo *getLegalizerInfo() const override;
+  const RegisterBankInfo *getRegBankInfo() const override;
+  const InstructionSelector *getInstructionSelector() const override;
 };
 } // namespace llvm
 
@@ -13,16 +13,31 @@
 
 #include "AAP.h"
 #include "AAPTargetMachine.h"
+#include "AAPTargetObjectFile.h"
+#include "AAPTargetTransformInfo.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/GlobalISel/IRTranslator.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/CodeGen/GlobalISel/Legalizer.h"
+#include "llvm/CodeGen/GlobalISel/RegBankSelect.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/Support/TargetRegistry.h"
 using namespace llvm;
 
+static cl::opt<int> EnableGlobalISelAtO(
+    "aap-enable-global-isel-at-O", cl::Hidden,
+    cl::desc("Enable GlobalISel at or below an opt level (-1 to disable)"),
+    cl::init(1));
+
 extern "C" void LLVMInitializeAAPTarget() {
   // Register the target
   RegisterTargetMachine<AAPTargetMachine> X(getTheAAPTarget());
+
+  PassRegistry &PR = *PassRegistry::getPassRegistry();
+  initializeGlobalISel(PR);
 }
 
 static Reloc::Model getEffectiveRelocModel(Optional<Reloc::Model> RM) {
@@ -46,22 +61,46 @@ AAPTargetMachine::AAPTargetMachine(const Target &T, const Triple &TT,
     : LLVMTargetMachine(T, "e-m:e-p:16:16-i32:16-i64:16-f32:16-f64:16-n16", TT,
                         CPU, FS, Options, getEffectiveRelocModel(RM),
                         getEffectiveCodeModel(CM), OL),
-      TLOF(make_unique<TargetLoweringObjectFileELF>()),
+      TLOF(make_unique<AAPTargetObjectFile>()),
       Subtarget(TT, CPU, FS, *this) {
   initAsmInfo();
+
+  // Functions which GlobalISel cannot select, such as those using i32, fall
+  // back to SelectionDAG.
+  if (getOptLevel() <= EnableGlobalISelAtO)
+    setGlobalISel(true);
+
+  // Run the MachineOutliner on functions optimized for minimum size, or on
+  // all functions with -enable-machine-outliner.
+  setMachineOutliner(true);
+  setSupportsDefaultOutlining(true);
+}
+
+TargetTransformInfo
+AAPTargetMachine::getTargetTransformInfo(const Function &F) {
+  return TargetTransformInfo(AAPTTIImpl(this, F));
 }
 
 namespace {
 class AAPPassConfig : public TargetPassConfig {
 public:
   AAPPassConfig(AAPTargetMachine &TM, PassManagerBase &PM)
-      : TargetPassConfig(TM, PM) {}
+      : TargetPassConfig(TM, PM) {
+    // Use the MachineScheduler after register allocation as well, so that the
+    // same AAP machine model drives both the pre-RA and post-RA schedulers.
+    substitutePass(&PostRASchedulerID, &PostMachineSchedulerID);
+  }
 
   AAPTargetMachine &getAAPTargetMachine() const {
     return getTM<AAPTargetMachine>();
   }
 
   bool addInstSelector() override;
+  bool addIRTranslator() override;
+  bool addLegalizeMachineIR() override;
+  bool addRegBankSelect() override;
+  bool addGlobalInstructionSelect() override;
+  void addPreRegAlloc() override;
   void addPreEmitPass() override;
 };
 }
@@ -75,7 +114,34 @@ bool AAPPassConfig::addInstSelector() {
   return false;
 }
 
+bool AAPPassConfig::addIRTranslator() {
+  addPass(new IRTranslator());
+  return false;
+}
+
+bool AAPPassConfig::addLegalizeMachineIR() {
+  addPass(new Legalizer());
+  return false;
+}
+
+bool AAPPassConfig::addRegBankSelect() {
+  addPass(new RegBankSelect());
+  return false;
+}
+
+bool AAPPassConfig::addGlobalInstructionSelect() {
+  addPass(new InstructionSelect());
+  return false;
+}
+
+void AAPPassConfig::addPreRegAlloc() {
+  if (getOptLevel() != CodeGenOpt::None)
+    addPass(createAAPShortRegHintsPass());
+}
+
 void AAPPassConfig::addPreEmitPass() {
+  if (getOptLevel() != CodeGenOpt::None)
+    addPass(createAAPBranchPlacementPass());
   addPass(&BranchRelaxationPassID);
   addPass(createAAPShortInstrPeepholePass(getAAPTargetMachine()), false);
 }
@@ -34,12 +34,18 @@ public:
   const AAPSubtarget *getSubtargetImpl(const Function &F) const override {
     return &Subtarget;
   }
+  const AAPSubtarget *getSubtargetImpl() const { return &Subtarget; }
 
   TargetPassConfig *createPassConfig(PassManagerBase &PM) override;
 
+  TargetTransformInfo getTargetTransformInfo(const Function &F) override;
+
   TargetLoweringObjectFile *getObjFileLowering() const override {
     return TLOF.get();
   }
+
+  // Local functions only need to preserve the registers their callers use.
+  bool useIPRA() const override { return true; }
 }; // AAPTargetMachine
 } // end namespace llvm
 
@@ -0,0 +1,69 @@
+//===-- AAPTargetObjectFile.cpp - AAP Object Info -------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AAPTargetObjectFile.h"
+#include "AAPTargetMachine.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+static cl::opt<unsigned> SmallDataLimit(
+    "aap-small-data-limit", cl::Hidden,
+    cl::desc("Maximum size in bytes of globals placed in the small data "
+             "sections when small data is enabled (default=8)"),
+    cl::init(8));
+
+void AAPTargetObjectFile::Initialize(MCContext &Ctx, const TargetMachine &TM) {
+  TargetLoweringObjectFileELF::Initialize(Ctx, TM);
+  InitializeELF(TM.Options.UseInitArray);
+
+  SmallDataSection = getContext().getELFSection(
+      ".sdata", ELF::SHT_PROGBITS, ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallBSSSection = getContext().getELFSection(".sbss", ELF::SHT_NOBITS,
+                                               ELF::SHF_WRITE | ELF::SHF_ALLOC);
+}
+
+bool AAPTargetObjectFile::isGlobalInSmallSection(
+    const GlobalObject *GO, const TargetMachine &TM) const {
+  const AAPTargetMachine &AAPTM = static_cast<const AAPTargetMachine &>(TM);
+  if (!AAPTM.getSubtargetImpl()->useSmallData())
+    return false;
+
+  const auto *GVA = dyn_cast<GlobalVariable>(GO);
+  if (!GVA || GVA->isThreadLocal() || GVA->hasSection())
+    return false;
+
+  // Only a global which this object itself places in a small data section may
+  // be accessed from the global pointer. A declaration, or a definition which
+  // may be replaced at link time, could be placed anywhere.
+  if (!GVA->isStrongDefinitionForLinker())
+    return false;
+
+  SectionKind Kind = getKindForGlobal(GO, TM);
+  if (!Kind.isData() && !Kind.isBSS())
+    return false;
+
+  // Zero sized objects are never treated as small data, as in GCC.
+  uint64_t Size =
+      GVA->getParent()->getDataLayout().getTypeAllocSize(GVA->getValueType());
+  return Size > 0 && Size <= SmallDataLimit;
+}
+
+MCSection *AAPTargetObjectFile::SelectSectionForGlobal(
+    const GlobalObject *GO, SectionKind Kind, const TargetMachine &TM) const {
+  if (isGlobalInSmallSection(GO, TM))
+    return Kind.isBSS() ? SmallBSSSection : SmallDataSection;
+
+  return TargetLoweringObjectFileELF::SelectSectionForGlobal(GO, Kind, TM);
+}
@@ -0,0 +1,37 @@
+//===-- AAPTargetObjectFile.h - AAP Object Info -----------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_AAP_AAPTARGETOBJECTFILE_H
+#define LLVM_LIB_TARGET_AAP_AAPTARGETOBJECTFILE_H
+
+#include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
+
+namespace llvm {
+
+/// AAPTargetObjectFile - places small globals in the .sdata and .sbss
+/// sections when the small-data feature is enabled, so that they may be
+/// addressed relative to the global pointer.
+class AAPTargetObjectFile : public TargetLoweringObjectFileELF {
+  MCSection *SmallDataSection;
+  MCSection *SmallBSSSection;
+
+public:
+  void Initialize(MCContext &Ctx, const TargetMachine &TM) override;
+
+  /// Return true if this global is placed in a small data section, and so
+  /// may be accessed with an offset from the global pointer.
+  bool isGlobalInSmallSection(const GlobalObject *GO,
+                              const TargetMachine &TM) const;
+
+  MCSection *SelectSectionForGlobal(const GlobalObject *GO, SectionKind Kind,
+                                    const TargetMachine &TM) const override;
+};
+} // end namespace llvm
+
+#endif
@@ -0,0 +1,267 @@
+//===-- AAPTargetTransformInfo.cpp - AAP specific TTI ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AAPTargetTransformInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "aaptti"
+
+static cl::opt<unsigned> UnrollBytes(
+    "aap-unroll-bytes", cl::Hidden, cl::init(48),
+    cl::desc("Size in bytes up to which loop bodies are partially or runtime "
+             "unrolled"));
+
+// Approximate costs, in instructions executed, of the runtime library calls
+// made for operations the hardware does not implement. The routines are shift
+// and add (or shift and subtract) loops with one iteration per result bit.
+static const unsigned LibcallOverhead = 4;
+static const unsigned MulLibcallCost = LibcallOverhead + 16 * 3;
+static const unsigned DivLibcallCost = LibcallOverhead + 16 * 5;
+
+// Typical costs of the inline expansions of multiplies and divides by a
+// constant.
+static const unsigned ConstMulCost = 4;
+static const unsigned ConstDivCost = 32;
+
+// The unroller measures loop size in instructions. Roughly half of the
+// instructions in a typical loop body have 16-bit encodings, the remainder
+// have 32-bit encodings.
+static const unsigned AverageInstrBytes = 3;
+
+// Return true if the operation ISD is expanded rather than done in hardware.
+// Remainders are always expanded using the division of the same signedness,
+// so they are only done in hardware if that division is legal.
+static bool isExpandedMulDiv(const AAPTargetLowering *TLI, int ISD, MVT VT) {
+  switch (ISD) {
+  case ISD::SDIV:
+  case ISD::SREM:
+    return !TLI->isOperationLegal(ISD::SDIV, VT);
+  case ISD::UDIV:
+  case ISD::UREM:
+    return !TLI->isOperationLegal(ISD::UDIV, VT);
+  default:
+    return TLI->isOperationExpand(ISD, VT);
+  }
+}
+
+int AAPTTIImpl::getIntImmCost(const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0)
+    return ~0U;
+
+  // Every 16-bit part of an immediate is materialized by one MOVI, which has
+  // a short encoding for unsigned 6-bit values.
+  return TTI::TCC_Basic * ((BitSize + 15) / 16);
+}
+
+int AAPTTIImpl::getIntImmCost(unsigned Opcode, unsigned Idx, const APInt &Imm,
+                              Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  // Immediates wider than a register are split into parts which are each
+  // materialized separately.
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0 || BitSize > 16)
+    return AAPTTIImpl::getIntImmCost(Imm, Ty);
+
+  int64_t Val = Imm.getSExtValue();
+  switch (Opcode) {
+  default:
+    break;
+  case Instruction::GetElementPtr:
+    // Always hoist the base address of a GetElementPtr. Offsets fold into the
+    // signed 10-bit offset of a load or store, or into an ADDI or SUBI.
+    if (Idx == 0)
+      return 2 * TTI::TCC_Basic;
+    return TTI::TCC_Free;
+  case Instruction::Add:
+  case Instruction::Sub:
+    // ADDI and SUBI take an unsigned 10-bit immediate, adds of a negative
+    // immediate are selected as a SUBI.
+    if (Idx == 1 && (isUInt<10>(Val) || isUInt<10>(-Val)))
+      return TTI::TCC_Free;
+    break;
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+    // ANDI, ORI and XORI take an unsigned 9-bit immediate
+    if (isUInt<9>(Imm.getZExtValue()))
+      return TTI::TCC_Free;
+    break;
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+    // Shift amounts are always encoded in the instruction
+    if (Idx == 1)
+      return TTI::TCC_Free;
+    break;
+  case Instruction::Mul:
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::URem:
+  case Instruction::SRem:
+    // Operations by a constant are expanded into shifts and adds, and the
+    // constant itself is never materialized, unless there is hardware to do
+    // the operation.
+    if (Idx == 1 &&
+        isExpandedMulDiv(TLI, TLI->InstructionOpcodeToISD(Opcode), MVT::i16))
+      return TTI::TCC_Free;
+    break;
+  }
+
+  return AAPTTIImpl::getIntImmCost(Imm, Ty);
+}
+
+void AAPTTIImpl::getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                                         TTI::UnrollingPreferences &UP) {
+  // Unrolling a call saves nothing next to the cost of the call itself.
+  for (BasicBlock *BB : L->blocks())
+    for (Instruction &I : *BB)
+      if (isa<CallInst>(I) || isa<InvokeInst>(I)) {
+        ImmutableCallSite CS(&I);
+        if (const Function *F = CS.getCalledFunction())
+          if (!isLoweredToCall(F))
+            continue;
+        return;
+      }
+
+  // There is no loop buffer, so unrolling only saves the compare and taken
+  // branch of each iteration. Keep the unrolled loop small, as code size is
+  // usually at a premium.
+  unsigned Threshold = UnrollBytes / AverageInstrBytes;
+  UP.Partial = UP.Runtime = true;
+  UP.PartialThreshold = Threshold;
+  UP.Threshold = 2 * Threshold;
+  UP.MaxCount = 4;
+
+  // Avoid unrolling when optimizing for size.
+  UP.OptSizeThreshold = 0;
+  UP.PartialOptSizeThreshold = 0;
+
+  // The backedge is a compare and branch, and an increment which can often be
+  // folded into a post-increment load or store.
+  UP.BEInsns = 2;
+}
+
+unsigned AAPTTIImpl::getArithmeticInstrCost(
+    unsigned Opcode, Type *Ty, TTI::OperandValueKind Opd1Info,
+    TTI::OperandValueKind Opd2Info, TTI::OperandValueProperties Opd1PropInfo,
+    TTI::OperandValueProperties Opd2PropInfo, ArrayRef<const Value *> Args) {
+  std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, Ty);
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+
+  if (Ty->isVectorTy() || !LT.second.isInteger())
+    return BaseT::getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
+                                         Opd1PropInfo, Opd2PropInfo, Args);
+
+  bool ConstPow2 = Opd2Info == TTI::OK_UniformConstantValue &&
+                   Opd2PropInfo == TTI::OP_PowerOf2;
+
+  switch (ISD) {
+  default:
+    break;
+  case ISD::MUL:
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM: {
+    if (!isExpandedMulDiv(TLI, ISD, LT.second)) {
+      if (ISD != ISD::SREM && ISD != ISD::UREM)
+        break;
+
+      // A remainder uses the hardware divide, as X - (X / Y) * Y.
+      unsigned DivOpcode =
+          ISD == ISD::SREM ? Instruction::SDiv : Instruction::UDiv;
+      return getArithmeticInstrCost(DivOpcode, Ty, Opd1Info, Opd2Info,
+                                    Opd1PropInfo, Opd2PropInfo) +
+             getArithmeticInstrCost(Instruction::Mul, Ty, Opd1Info, Opd2Info,
+                                    Opd1PropInfo, Opd2PropInfo) +
+             getArithmeticInstrCost(Instruction::Sub, Ty);
+    }
+
+    // Unsigned operations by a power of two become a shift or a mask, signed
+    // divides also need the dividend rounding towards zero.
+    if (ConstPow2)
+      return LT.first * ((ISD == ISD::SDIV || ISD == ISD::SREM) ? 4 : 1);
+
+    // Multiplies by other constants are decomposed into a few shifts and
+    // adds. Divides by constants multiply by a magic number in 32 bits, see
+    // AAPTargetLowering::PerformDIVREMCombine.
+    if (Opd2Info == TTI::OK_UniformConstantValue && LT.first == 1)
+      return ISD == ISD::MUL ? ConstMulCost : ConstDivCost;
+
+    // The library routines loop over every bit of the wider type, and each
+    // iteration operates on every part.
+    unsigned Cost = ISD == ISD::MUL ? MulLibcallCost : DivLibcallCost;
+    return LT.first * LT.first * Cost;
+  }
+  case ISD::SHL:
+  case ISD::SRL:
+  case ISD::SRA:
+    // Shifts of types wider than a register combine the parts with further
+    // shifts, and for variable amounts select on whether the amount is wider
+    // than a part.
+    if (LT.first > 1)
+      return LT.first *
+             (Opd2Info == TTI::OK_UniformConstantValue ? 2 : 6);
+    break;
+  }
+
+  return BaseT::getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
+                                       Opd1PropInfo, Opd2PropInfo, Args);
+}
+
+unsigned AAPTTIImpl::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                        Type *CondTy, const Instruction *I) {
+  // There are no conditional moves, selects are expanded to a compare and
+  // branch around a move.
+  if (Opcode == Instruction::Select && !ValTy->isVectorTy()) {
+    std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, ValTy);
+    return LT.first * 3;
+  }
+  return BaseT::getCmpSelInstrCost(Opcode, ValTy, CondTy, I);
+}
+
+unsigned AAPTTIImpl::getIntrinsicInstrCost(Intrinsic::ID IID, Type *RetTy,
+                                           ArrayRef<Type *> Tys,
+                                           FastMathFlags FMF,
+                                           unsigned ScalarizationCostPassed) {
+  if (RetTy->isVectorTy() || !RetTy->isIntegerTy())
+    return BaseT::getIntrinsicInstrCost(IID, RetTy, Tys, FMF,
+                                        ScalarizationCostPassed);
+
+  // None of the bit manipulation operations are implemented in hardware, so
+  // they are expanded into sequences of shifts and logical operations on each
+  // part. Population counts sum the bytes with a multiply.
+  std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, RetTy);
+  const unsigned PopcntCost = 12 + MulLibcallCost;
+  switch (IID) {
+  default:
+    break;
+  case Intrinsic::bswap:
+    return LT.first * 3;
+  case Intrinsic::bitreverse:
+    return LT.first * (3 + 5 * 3);
+  case Intrinsic::ctpop:
+    return LT.first * PopcntCost;
+  case Intrinsic::ctlz:
+    return LT.first * (9 + PopcntCost);
+  case Intrinsic::cttz:
+    return LT.first * (3 + PopcntCost);
+  }
+  return BaseT::getIntrinsicInstrCost(IID, RetTy, Tys, FMF,
+                                      ScalarizationCostPassed);
+}
@@ -0,0 +1,91 @@
+//===-- AAPTargetTransformInfo.h - AAP specific TTI -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file a TargetTransformInfo::Concept conforming object specific to the
+// AAP target machine. It uses the target's detailed information to
+// provide more precise answers to certain TTI queries, while letting the
+// target independent and default TTI implementations handle the rest.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_AAP_AAPTARGETTRANSFORMINFO_H
+#define LLVM_LIB_TARGET_AAP_AAPTARGETTRANSFORMINFO_H
+
+#include "AAPSubtarget.h"
+#include "AAPTargetMachine.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/BasicTTIImpl.h"
+#include "llvm/CodeGen/TargetLowering.h"
+
+namespace llvm {
+class AAPTTIImpl : public BasicTTIImplBase<AAPTTIImpl> {
+  typedef BasicTTIImplBase<AAPTTIImpl> BaseT;
+  typedef TargetTransformInfo TTI;
+  friend BaseT;
+
+  const AAPSubtarget *ST;
+  const AAPTargetLowering *TLI;
+
+  const AAPSubtarget *getST() const { return ST; }
+  const AAPTargetLowering *getTLI() const { return TLI; }
+
+public:
+  explicit AAPTTIImpl(const AAPTargetMachine *TM, const Function &F)
+      : BaseT(TM, F.getParent()->getDataLayout()), ST(TM->getSubtargetImpl(F)),
+        TLI(ST->getTargetLowering()) {}
+
+  /// \name Scalar TTI Implementations
+  /// @{
+
+  TTI::PopcntSupportKind getPopcntSupport(unsigned TyWidth) {
+    return TTI::PSK_Software;
+  }
+
+  int getIntImmCost(const APInt &Imm, Type *Ty);
+  int getIntImmCost(unsigned Opcode, unsigned Idx, const APInt &Imm, Type *Ty);
+  using BaseT::getIntImmCost;
+
+  void getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                               TTI::UnrollingPreferences &UP);
+
+  // Loads and stores can post-increment their base register, so LSR should
+  // prefer to increment pointers after they are used.
+  bool shouldFavorPostInc() const { return true; }
+
+  /// @}
+
+  /// \name Vector TTI Implementations
+  /// @{
+
+  unsigned getNumberOfRegisters(bool Vector) { return Vector ? 0 : 62; }
+
+  unsigned getRegisterBitWidth(bool Vector) const { return Vector ? 0 : 16; }
+
+  /// @}
+
+  unsigned getArithmeticInstrCost(
+      unsigned Opcode, Type *Ty,
+      TTI::OperandValueKind Opd1Info = TTI::OK_AnyValue,
+      TTI::OperandValueKind Opd2Info = TTI::OK_AnyValue,
+      TTI::OperandValueProperties Opd1PropInfo = TTI::OP_None,
+      TTI::OperandValueProperties Opd2PropInfo = TTI::OP_None,
+      ArrayRef<const Value *> Args = ArrayRef<const Value *>());
+
+  unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy, Type *CondTy,
+                              const Instruction *I = nullptr);
+
+  unsigned getIntrinsicInstrCost(
+      Intrinsic::ID IID, Type *RetTy, ArrayRef<Type *> Tys, FastMathFlags FMF,
+      unsigned ScalarizationCostPassed = std::numeric_limits<unsigned>::max());
+  using BaseT::getIntrinsicInstrCost;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_TARGET_AAP_AAPTARGETTRANSFORMINFO_H
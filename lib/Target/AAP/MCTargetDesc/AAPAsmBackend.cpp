@@ -16,6 +16,7 @@
 #include "llvm/MC/MCFixupKindInfo.h"
 #include "llvm/MC/MCObjectWriter.h"
 #include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCValue.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
 
@@ -23,14 +24,27 @@ using namespace llvm;
 
 namespace {
 class AAPAsmBackend : public MCAsmBackend {
+  const MCSubtargetInfo &STI;
   uint8_t OSABI;
 
+  bool isLinkerRelaxEnabled() const {
+    return STI.getFeatureBits()[AAP::FeatureRelax];
+  }
+
 public:
-  AAPAsmBackend(uint8_t OSABI) : MCAsmBackend(support::little), OSABI(OSABI) {}
+  AAPAsmBackend(const MCSubtargetInfo &STI, uint8_t OSABI)
+      : MCAsmBackend(support::little), STI(STI), OSABI(OSABI) {}
 
   std::unique_ptr<MCObjectTargetWriter>
   createObjectTargetWriter() const override;
 
+  // When the linker may shrink instructions the distance between two symbols
+  // is not known until link time, so keep symbol differences symbolic by
+  // emitting them as a pair of ADD/SUB relocations.
+  bool requiresDiffExpressionRelocations() const override {
+    return isLinkerRelaxEnabled();
+  }
+
 //===-------------------------- Fixup processing --------------------------===//
 
   unsigned getNumFixupKinds() const override {
@@ -39,6 +53,17 @@ public:
 
   const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const override;
 
+  // With linker relaxation enabled, offsets within a section may change, so
+  // fixups against symbols are never resolved in the assembler. The global
+  // pointer is only known to the linker, so offsets from it are always left
+  // as relocations.
+  bool shouldForceRelocation(const MCAssembler &Asm, const MCFixup &Fixup,
+                             const MCValue &Target) override {
+    if ((unsigned)Fixup.getKind() == AAP::fixup_AAP_GPREL10)
+      return true;
+    return isLinkerRelaxEnabled() && Target.getSymA();
+  }
+
   void applyFixup(const MCAssembler &Asm, const MCFixup &Fixup,
                   const MCValue &Target, MutableArrayRef<char> Data,
                   uint64_t Value, bool IsResolved,
@@ -57,8 +82,8 @@ public:
                             const MCRelaxableFragment *DF,
                             const MCAsmLayout &Layout) const override {
     // We already generate the longest instruction necessary so there is
-    // no need to relax, and at the moment we should never see fixups for
-    // short instructions.
+    // no need to relax. Short branches are only selected when their target
+    // is known to be in range.
     switch ((unsigned)Fixup.getKind()) {
     case AAP::fixup_AAP_BR16:
     case AAP::fixup_AAP_BRCC16:
@@ -118,7 +143,9 @@ const MCFixupKindInfo &AAPAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
     {"fixup_AAP_ABS12",       0,    24,     0},
     {"fixup_AAP_ABS16",       0,    32,     0},
     {"fixup_AAP_SHIFT6",      0,    24,     0},
-    {"fixup_AAP_OFF10",       0,    32,     0}
+    {"fixup_AAP_OFF10",       0,    32,     0},
+    {"fixup_AAP_GPREL10",     0,    32,     0},
+    {"fixup_AAP_RELAX",       0,    0,      0}
   };
 
   if (Kind < FirstTargetFixupKind)
@@ -133,13 +160,16 @@ const MCFixupKindInfo &AAPAsmBackend::getFixupKindInfo(MCFixupKind Kind) const {
 static uint64_t adjustFixupValue(MCFixupKind FixupKind, uint64_t Value) {
   switch ((unsigned)FixupKind) {
   default:
-    // Fixups for short instructions are unimplemented as they are not selected.
+    // Fixups for short calls are unimplemented as they are not selected.
     llvm_unreachable("Unimplemented fixup kind");
   case FK_Data_1:
   case FK_Data_2:
   case FK_Data_4:
   case FK_Data_8:
     return Value;
+  case AAP::fixup_AAP_RELAX:
+    // Only a marker for the linker, there is no field to apply it to
+    return 0;
   case AAP::fixup_AAP_ABS6:
   case AAP::fixup_AAP_SHIFT6:
     // Inst_rr_i6
@@ -152,6 +182,7 @@ static uint64_t adjustFixupValue(MCFixupKind FixupKind, uint64_t Value) {
            (((Value >> 6) & 0x07) << 26);
   case AAP::fixup_AAP_ABS10:
   case AAP::fixup_AAP_OFF10:
+  case AAP::fixup_AAP_GPREL10:
     // Inst_rr_i10
     return (((Value >> 0) & 0x07) << 0) |
            (((Value >> 3) & 0x07) << 16) |
@@ -165,6 +196,9 @@ static uint64_t adjustFixupValue(MCFixupKind FixupKind, uint64_t Value) {
     return (((Value >> 0) & 0x3F) << 0) |
            (((Value >> 6) & 0x3F) << 16) |
            (((Value >> 12) & 0x0F) << 25);
+  case AAP::fixup_AAP_BRCC16:
+    // Inst_i3_rr_short
+    return Value & 0x07;
   case AAP::fixup_AAP_BRCC32:
     // Inst_i10_rr
     return (((Value >> 0) & 0x07) << 0) |
@@ -173,6 +207,9 @@ static uint64_t adjustFixupValue(MCFixupKind FixupKind, uint64_t Value) {
     // Inst_i16_r
     return (((Value >> 0) & 0x3F) << 0) |
            (((Value >> 6) & 0x03FF) << 19);
+  case AAP::fixup_AAP_BR16:
+    // Inst_i9_short
+    return Value & 0x01FF;
   case AAP::fixup_AAP_BR32:
     // Inst_i22
     return (((Value >> 0) & 0x01FF) << 0) |
@@ -203,7 +240,7 @@ void AAPAsmBackend::applyFixup(const MCAssembler &Asm, const MCFixup &Fixup,
 std::unique_ptr<MCObjectTargetWriter>
 AAPAsmBackend::createObjectTargetWriter() const {
   StringRef CPU("Default");
-  return createAAPELFObjectWriter(OSABI, CPU);
+  return createAAPELFObjectWriter(OSABI, CPU, isLinkerRelaxEnabled());
 }
 
 MCAsmBackend *llvm::createAAPAsmBackend(const Target &T,
@@ -212,5 +249,5 @@ MCAsmBackend *llvm::createAAPAsmBackend(const Target &T,
                                         const MCTargetOptions &Options) {
   uint8_t OSABI =
       MCELFObjectTargetWriter::getOSABI(Triple(STI.getTargetTriple()).getOS());
-  return new AAPAsmBackend(OSABI);
+  return new AAPAsmBackend(STI, OSABI);
 }
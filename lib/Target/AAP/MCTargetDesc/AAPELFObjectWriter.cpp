@@ -19,19 +19,27 @@ using namespace llvm;
 namespace {
 class AAPELFObjectWriter : public MCELFObjectTargetWriter {
   StringRef CPU;
+  bool Relax;
 
 public:
-  AAPELFObjectWriter(uint8_t OSABI, StringRef C);
+  AAPELFObjectWriter(uint8_t OSABI, StringRef C, bool Relax);
 
   unsigned getRelocType(MCContext &Ctx, const MCValue &Target,
                         const MCFixup &Fixup, bool IsPCRel) const override;
+
+  // Section offsets may change when the linker relaxes instructions, so
+  // relocations must refer to the symbol rather than to the section.
+  bool needsRelocateWithSymbol(const MCSymbol &Sym,
+                               unsigned Type) const override {
+    return Relax;
+  }
 };
 } // namespace
 
-AAPELFObjectWriter::AAPELFObjectWriter(uint8_t OSABI, StringRef C)
+AAPELFObjectWriter::AAPELFObjectWriter(uint8_t OSABI, StringRef C, bool Relax)
     : MCELFObjectTargetWriter(/*Is64bit*/ false, OSABI, ELF::EM_AAP,
                               /*HasRelocationAddend*/ true),
-      CPU(C) {}
+      CPU(C), Relax(Relax) {}
 
 unsigned AAPELFObjectWriter::getRelocType(MCContext & /*Ctx*/,
                                           const MCValue & /*Target*/,
@@ -41,7 +49,9 @@ unsigned AAPELFObjectWriter::getRelocType(MCContext & /*Ctx*/,
 
   switch ((unsigned)Kind) {
   case AAP::fixup_AAP_NONE:   return ELF::R_AAP_NONE;
+  case AAP::fixup_AAP_BR16:   return ELF::R_AAP_BR16;
   case AAP::fixup_AAP_BR32:   return ELF::R_AAP_BR32;
+  case AAP::fixup_AAP_BRCC16: return ELF::R_AAP_BRCC16;
   case AAP::fixup_AAP_BRCC32: return ELF::R_AAP_BRCC32;
   case AAP::fixup_AAP_BAL32:  return ELF::R_AAP_BAL32;
 
@@ -53,16 +63,27 @@ unsigned AAPELFObjectWriter::getRelocType(MCContext & /*Ctx*/,
 
   case AAP::fixup_AAP_SHIFT6: return ELF::R_AAP_SHIFT6;
   case AAP::fixup_AAP_OFF10:  return ELF::R_AAP_OFF10;
+  case AAP::fixup_AAP_GPREL10: return ELF::R_AAP_GPREL10;
+
+  case AAP::fixup_AAP_RELAX:  return ELF::R_AAP_RELAX;
 
   case FK_Data_1:             return ELF::R_AAP_8;
   case FK_Data_2:             return ELF::R_AAP_16;
   case FK_Data_4:             return ELF::R_AAP_32;
   case FK_Data_8:             return ELF::R_AAP_64;
 
-  // Instrs with these fixups should never be generated or parsed, so for now
-  // we should not be emitting relocations for them.
-  case AAP::fixup_AAP_BR16:
-  case AAP::fixup_AAP_BRCC16:
+  // Symbol differences which must be resolved by the linker
+  case FK_Data_Add_1:         return ELF::R_AAP_ADD8;
+  case FK_Data_Add_2:         return ELF::R_AAP_ADD16;
+  case FK_Data_Add_4:         return ELF::R_AAP_ADD32;
+  case FK_Data_Add_8:         return ELF::R_AAP_ADD64;
+  case FK_Data_Sub_1:         return ELF::R_AAP_SUB8;
+  case FK_Data_Sub_2:         return ELF::R_AAP_SUB16;
+  case FK_Data_Sub_4:         return ELF::R_AAP_SUB32;
+  case FK_Data_Sub_8:         return ELF::R_AAP_SUB64;
+
+  // Short calls are only generated for absolute targets, and are never
+  // parsed, so for now we should not be emitting relocations for them.
   case AAP::fixup_AAP_BAL16:
     llvm_unreachable("Cannot emit relocations for short instruction fixups!");
   default:
@@ -72,6 +93,6 @@ unsigned AAPELFObjectWriter::getRelocType(MCContext & /*Ctx*/,
 }
 
 std::unique_ptr<MCObjectTargetWriter>
-llvm::createAAPELFObjectWriter(uint8_t OSABI, StringRef CPU) {
-  return llvm::make_unique<AAPELFObjectWriter>(OSABI, CPU);
+llvm::createAAPELFObjectWriter(uint8_t OSABI, StringRef CPU, bool Relax) {
+  return llvm::make_unique<AAPELFObjectWriter>(OSABI, CPU, Relax);
 }
@@ -48,6 +48,13 @@ enum Fixups {
   fixup_AAP_SHIFT6,
   fixup_AAP_OFF10,
 
+  // Offset of a small data symbol from the global pointer
+  fixup_AAP_GPREL10,
+
+  // Results in R_AAP_RELAX, marking the preceding branch fixup at the same
+  // offset as one the linker may replace with a short instruction
+  fixup_AAP_RELAX,
+
   // Marker
   LastTargetFixupKind,
   NumTargetFixupKinds = LastTargetFixupKind - FirstTargetFixupKind
@@ -77,9 +77,24 @@ unsigned AAPMCCodeEmitter::getMachineOpValue(const MCInst &MI,
   Fixups.push_back(
       MCFixup::create(0, Expr, MCFixupKind(FixupKind), MI.getLoc()));
   ++MCNumFixups;
+  if (FixupKind == AAP::fixup_AAP_BAL32)
+    addRelaxFixup(MI, Expr, Fixups, STI);
   return 0;
 }
 
+// Calls and branches to symbols are emitted in their long form, as the
+// distance to the target is unknown. When linker relaxation is enabled, mark
+// them so that the linker may use the short form if the target is in range.
+void AAPMCCodeEmitter::addRelaxFixup(const MCInst &MI, const MCExpr *Expr,
+                                     SmallVectorImpl<MCFixup> &Fixups,
+                                     const MCSubtargetInfo &STI) const {
+  if (!STI.getFeatureBits()[AAP::FeatureRelax])
+    return;
+  Fixups.push_back(MCFixup::create(0, Expr, MCFixupKind(AAP::fixup_AAP_RELAX),
+                                   MI.getLoc()));
+  ++MCNumFixups;
+}
+
 // TODO: Better way than using LUTs?
 static const unsigned BRCCOpcodes[] = {
     AAP::BEQ_,       AAP::BNE_,       AAP::BLTS_,
@@ -135,6 +150,9 @@ AAPMCCodeEmitter::encodePCRelImmOperand(const MCInst &MI, unsigned Op,
   }
   Fixups.push_back(MCFixup::create(0, MO.getExpr(), (MCFixupKind)FixupKind));
   ++MCNumFixups;
+  if (FixupKind == AAP::fixup_AAP_BR32 || FixupKind == AAP::fixup_AAP_BRCC32 ||
+      FixupKind == AAP::fixup_AAP_BAL32)
+    addRelaxFixup(MI, MO.getExpr(), Fixups, STI);
   return 0;
 }
 
@@ -167,8 +185,18 @@ AAPMCCodeEmitter::encodeMemSrcOperand(const MCInst &MI, unsigned Op,
   assert(Desc.getSize() == 4 &&
          "Cannot encode an expression in a short memory+offset operand");
 
+  // Small data is addressed by its offset from the global pointer, written as
+  // sym@gprel, possibly with an addend.
+  const MCExpr *Expr = ImmOp.getExpr();
+  const MCExpr *SymExpr = Expr;
+  if (const auto *BE = dyn_cast<MCBinaryExpr>(Expr))
+    SymExpr = BE->getLHS();
+  const auto *SRE = dyn_cast<MCSymbolRefExpr>(SymExpr);
+
   AAP::Fixups FixupKind = AAP::fixup_AAP_OFF10;
-  Fixups.push_back(MCFixup::create(0, ImmOp.getExpr(), MCFixupKind(FixupKind)));
+  if (SRE && SRE->getKind() == MCSymbolRefExpr::VK_AAP_GPREL)
+    FixupKind = AAP::fixup_AAP_GPREL10;
+  Fixups.push_back(MCFixup::create(0, Expr, MCFixupKind(FixupKind)));
   ++MCNumFixups;
   return encoding;
 }
@@ -19,6 +19,7 @@
 #include "llvm/MC/MCInstrInfo.h"
 
 namespace llvm {
+class MCExpr;
 class MCFixup;
 class MCInst;
 class MCSubtargetInfo;
@@ -49,6 +50,12 @@ public:
 
 //===-------------------------- Operand encoding --------------------------===//
 
+  /// Add a relaxation marker for a branch or call fixup to \p Expr if
+  /// linker relaxation is enabled.
+  void addRelaxFixup(const MCInst &MI, const MCExpr *Expr,
+                     SmallVectorImpl<MCFixup> &Fixups,
+                     const MCSubtargetInfo &STI) const;
+
   unsigned encodePCRelImmOperand(const MCInst &MI, unsigned Op,
                                  SmallVectorImpl<MCFixup> &Fixups,
                                  const MCSubtargetInfo &STI) const;
@@ -15,6 +15,7 @@
 #include "AAPMCAsmInfo.h"
 #include "InstPrinter/AAPInstPrinter.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/MC/MCInstrAnalysis.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
@@ -53,7 +54,15 @@ static MCInstPrinter *createAAPMCInstPrinter(const Triple &T,
 
 static MCSubtargetInfo *createAAPMCSubtargetInfo(const Triple &TT,
                                                  StringRef CPU, StringRef FS) {
-  return createAAPMCSubtargetInfoImpl(TT, CPU, FS);
+  std::string CPUName = CPU;
+  if (CPUName.empty())
+    CPUName = "generic";
+
+  return createAAPMCSubtargetInfoImpl(TT, CPUName, FS);
+}
+
+static MCInstrAnalysis *createAAPInstrAnalysis(const MCInstrInfo *Info) {
+  return new MCInstrAnalysis(Info);
 }
 
 extern "C" void LLVMInitializeAAPTargetMC() {
@@ -66,6 +75,10 @@ extern "C" void LLVMInitializeAAPTargetMC() {
   // Register the MC register info.
   TargetRegistry::RegisterMCRegInfo(getTheAAPTarget(), createAAPMCRegisterInfo);
 
+  // Register the MC instruction analyzer, used by llvm-mca.
+  TargetRegistry::RegisterMCInstrAnalysis(getTheAAPTarget(),
+                                          createAAPInstrAnalysis);
+
   // Register the MC Code Emitter
   TargetRegistry::RegisterMCCodeEmitter(getTheAAPTarget(),
                                         createAAPMCCodeEmitter);
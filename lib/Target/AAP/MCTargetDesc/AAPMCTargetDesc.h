@@ -38,8 +38,8 @@ MCAsmBackend *createAAPAsmBackend(const Target &T, const MCSubtargetInfo &STI,
                                   const MCRegisterInfo &MRI,
                                   const MCTargetOptions &Options);
 
-std::unique_ptr<MCObjectTargetWriter> createAAPELFObjectWriter(uint8_t OSABI,
-                                                               StringRef CPU);
+std::unique_ptr<MCObjectTargetWriter>
+createAAPELFObjectWriter(uint8_t OSABI, StringRef CPU, bool Relax);
 
 } // namespace llvm
 
@@ -0,0 +1,79 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=aap | FileCheck %s
+; RUN: opt < %s -cost-model -analyze -mtriple=aap -mattr=+div \
+; RUN:     | FileCheck -check-prefix=DIV %s
+
+target datalayout = "e-m:e-p:16:16-i32:16-i64:16-f32:16-f64:16-n16"
+target triple = "aap"
+
+; Check the costs of operations which AAP expands into sequences of
+; instructions or runtime library calls.
+
+define void @arith(i16 %a, i16 %b, i32 %c, i32 %d) {
+; CHECK: cost of 1 for instruction:   %add = add i16
+  %add = add i16 %a, %b
+; CHECK: cost of 2 for instruction:   %add32 = add i32
+  %add32 = add i32 %c, %d
+; CHECK: cost of 52 for instruction:   %mul = mul i16
+  %mul = mul i16 %a, %b
+; CHECK: cost of 1 for instruction:   %mulpow2 = mul i16
+  %mulpow2 = mul i16 %a, 8
+; CHECK: cost of 4 for instruction:   %mulconst = mul i16
+  %mulconst = mul i16 %a, 10
+; CHECK: cost of 208 for instruction:   %mul32 = mul i32
+  %mul32 = mul i32 %c, %d
+; CHECK: cost of 84 for instruction:   %udiv = udiv i16
+  %udiv = udiv i16 %a, %b
+; CHECK: cost of 1 for instruction:   %udivpow2 = udiv i16
+  %udivpow2 = udiv i16 %a, 16
+; CHECK: cost of 32 for instruction:   %udivconst = udiv i16
+  %udivconst = udiv i16 %a, 10
+; CHECK: cost of 4 for instruction:   %sdivpow2 = sdiv i16
+  %sdivpow2 = sdiv i16 %a, 16
+; CHECK: cost of 84 for instruction:   %srem = srem i16
+  %srem = srem i16 %a, %b
+; CHECK: cost of 32 for instruction:   %sremconst = srem i16
+  %sremconst = srem i16 %a, 7
+; CHECK: cost of 1 for instruction:   %shl = shl i16
+  %shl = shl i16 %a, %b
+; CHECK: cost of 12 for instruction:   %shl32 = shl i32
+  %shl32 = shl i32 %c, %d
+; CHECK: cost of 4 for instruction:   %shl32c = shl i32
+  %shl32c = shl i32 %c, 3
+  ret void
+}
+
+; With a hardware divider, remainders are computed from the quotient with a
+; multiply and a subtract, whether or not the divisor is constant.
+define void @divrem(i16 %a, i16 %b) {
+; DIV: cost of 1 for instruction:   %sdiv = sdiv i16
+  %sdiv = sdiv i16 %a, %b
+; DIV: cost of 1 for instruction:   %sdivconst = sdiv i16
+  %sdivconst = sdiv i16 %a, 7
+; DIV: cost of 54 for instruction:   %srem = srem i16
+  %srem = srem i16 %a, %b
+; DIV: cost of 6 for instruction:   %sremconst = srem i16
+  %sremconst = srem i16 %a, 7
+; DIV: cost of 6 for instruction:   %uremconst = urem i16
+  %uremconst = urem i16 %a, 7
+  ret void
+}
+
+define void @select(i1 %c, i16 %a, i16 %b) {
+; CHECK: cost of 3 for instruction:   %sel = select i1
+  %sel = select i1 %c, i16 %a, i16 %b
+  ret void
+}
+
+declare i16 @llvm.ctpop.i16(i16)
+declare i16 @llvm.ctlz.i16(i16, i1)
+declare i16 @llvm.bswap.i16(i16)
+
+define void @bitops(i16 %a) {
+; CHECK: cost of 64 for instruction:   %ctpop = call i16 @llvm.ctpop.i16
+  %ctpop = call i16 @llvm.ctpop.i16(i16 %a)
+; CHECK: cost of 73 for instruction:   %ctlz = call i16 @llvm.ctlz.i16
+  %ctlz = call i16 @llvm.ctlz.i16(i16 %a, i1 false)
+; CHECK: cost of 3 for instruction:   %bswap = call i16 @llvm.bswap.i16
+  %bswap = call i16 @llvm.bswap.i16(i16 %a)
+  ret void
+}
@@ -0,0 +1,30 @@
+; RUN: not llc -march=aap -O0 -global-isel-abort=1 -verify-machineinstrs %s -o - 2>&1 | FileCheck %s --check-prefix=ERROR
+; RUN: llc -march=aap -O0 -global-isel-abort=2 -pass-remarks-missed='gisel*' -verify-machineinstrs %s -o %t.out 2> %t.err
+; RUN: FileCheck %s --check-prefix=FALLBACK-OUT < %t.out
+; RUN: FileCheck %s --check-prefix=FALLBACK-ERR < %t.err
+; RUN: not llc -march=aap -O1 -global-isel-abort=1 -verify-machineinstrs %s -o - 2>&1 | FileCheck %s --check-prefix=ERROR
+; RUN: llc -march=aap -O2 -global-isel-abort=1 -verify-machineinstrs %s -o /dev/null
+
+; Check that functions GlobalISel cannot handle, such as those using i32
+; arguments, fall back to SelectionDAG at -O0 and -O1. GlobalISel is not used
+; by default at -O2.
+
+; ERROR: unable to lower arguments: i32 (i32, i32)* (in function: add32)
+
+; FALLBACK-ERR: remark: <unknown>:0:0: unable to lower arguments: i32 (i32, i32)* (in function: add32)
+; FALLBACK-ERR: warning: Instruction selection used fallback path for add32
+; FALLBACK-OUT-LABEL: add32:
+; FALLBACK-OUT: add $r2, $r2, $r4
+; FALLBACK-OUT: addc $r3, $r3, $r5
+define i32 @add32(i32 %a, i32 %b) {
+  %1 = add i32 %a, %b
+  ret i32 %1
+}
+
+; FALLBACK-ERR-NOT: fallback path for add16
+; FALLBACK-OUT-LABEL: add16:
+; FALLBACK-OUT: add $r2, $r2, $r3
+define i16 @add16(i16 %a, i16 %b) {
+  %1 = add i16 %a, %b
+  ret i16 %1
+}
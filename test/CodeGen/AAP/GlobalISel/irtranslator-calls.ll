@@ -0,0 +1,51 @@
+; RUN: llc -march=aap -O0 -global-isel-abort=1 -stop-after=irtranslator -verify-machineinstrs %s -o - | FileCheck %s
+
+; Check the lowering of arguments, returns and calls to generic machine IR.
+
+declare i16 @callee(i16, i8, i16*)
+
+; CHECK-LABEL: name: args
+; CHECK: liveins: $r2, $r3, $r4
+; CHECK-DAG: [[A:%[0-9]+]]:_(s16) = COPY $r2
+; CHECK-DAG: [[B16:%[0-9]+]]:_(s16) = COPY $r3
+; CHECK-DAG: [[B:%[0-9]+]]:_(s8) = G_TRUNC [[B16]](s16)
+; CHECK-DAG: [[P:%[0-9]+]]:_(p0) = COPY $r4
+; CHECK: ADJCALLSTACKDOWN 0, 0
+; CHECK: $r2 = COPY [[A]](s16)
+; CHECK: [[BEXT:%[0-9]+]]:_(s16) = G_ANYEXT [[B]](s8)
+; CHECK: $r3 = COPY [[BEXT]](s16)
+; CHECK: $r4 = COPY [[P]](p0)
+; CHECK: BAL @callee, $r0, csr, implicit-def $r0, implicit $r1, implicit $r2, implicit $r3, implicit $r4, implicit-def $r2
+; CHECK: [[RET:%[0-9]+]]:_(s16) = COPY $r2
+; CHECK: ADJCALLSTACKUP 0, 0
+; CHECK: $r2 = COPY [[RET]](s16)
+; CHECK: PseudoRET implicit $r2
+define i16 @args(i16 %a, i8 %b, i16* %p) {
+  %1 = call i16 @callee(i16 %a, i8 %b, i16* %p)
+  ret i16 %1
+}
+
+; Arguments which do not fit in R2-R7 are passed on the stack.
+; CHECK-LABEL: name: stack_args
+; CHECK: fixedStack:
+; CHECK: G_FRAME_INDEX %fixed-stack
+; CHECK: G_LOAD {{.*}} :: (invariant load 2 from %fixed-stack
+; CHECK: ADJCALLSTACKDOWN 2, 0
+; CHECK: [[SP:%[0-9]+]]:_(p0) = COPY $r1
+; CHECK: [[OFF:%[0-9]+]]:_(s16) = G_CONSTANT i16 0
+; CHECK: [[ADDR:%[0-9]+]]:_(p0) = G_GEP [[SP]], [[OFF]](s16)
+; CHECK: G_STORE {{.*}}, [[ADDR]](p0) :: (store 2 into stack)
+; CHECK: ADJCALLSTACKUP 2, 0
+declare void @many(i16, i16, i16, i16, i16, i16, i16)
+define void @stack_args(i16 %a, i16 %b, i16 %c, i16 %d, i16 %e, i16 %f,
+                        i16 %g) {
+  call void @many(i16 %a, i16 %b, i16 %c, i16 %d, i16 %e, i16 %f, i16 %g)
+  ret void
+}
+
+; CHECK-LABEL: name: indirect
+; CHECK: JAL {{%[0-9]+}}(p0), $r0
+define void @indirect(void ()* %f) {
+  call void %f()
+  ret void
+}
@@ -0,0 +1,87 @@
+; RUN: llc -march=aap -O0 -global-isel-abort=1 -verify-machineinstrs < %s | FileCheck %s
+
+; Check that common 16-bit code is selected by GlobalISel end to end.
+
+define i16 @add_imm(i16 %a) {
+; CHECK-LABEL: add_imm:
+; CHECK: addi ${{r[0-9]+}}, ${{r[0-9]+}}, 5
+  %1 = add i16 %a, 5
+  ret i16 %1
+}
+
+define i16 @logic(i16 %a, i16 %b) {
+; CHECK-LABEL: logic:
+; CHECK: and
+; CHECK: or
+; CHECK: xor
+  %1 = and i16 %a, %b
+  %2 = or i16 %1, %a
+  %3 = xor i16 %2, %b
+  ret i16 %3
+}
+
+define i16 @mul(i16 %a, i16 %b) {
+; CHECK-LABEL: mul:
+; CHECK: bal __mulhi3, $r0
+  %1 = mul i16 %a, %b
+  ret i16 %1
+}
+
+define i16 @load_store(i16* %p, i8* %q) {
+; CHECK-LABEL: load_store:
+; CHECK: ldw ${{r[0-9]+}}, [${{r[0-9]+}}, 4]
+; CHECK: ldb ${{r[0-9]+}}, [${{r[0-9]+}}, 0]
+; CHECK: stb [${{r[0-9]+}}, 1], ${{r[0-9]+}}
+  %1 = getelementptr i16, i16* %p, i16 2
+  %2 = load i16, i16* %1
+  %3 = load i8, i8* %q
+  %4 = getelementptr i8, i8* %q, i16 1
+  store i8 %3, i8* %4
+  %5 = zext i8 %3 to i16
+  %6 = add i16 %2, %5
+  ret i16 %6
+}
+
+define i16 @branch(i16 %a, i16 %b) {
+; CHECK-LABEL: branch:
+; CHECK: blts
+  %1 = icmp sgt i16 %b, %a
+  br i1 %1, label %then, label %else
+then:
+  ret i16 %a
+else:
+  ret i16 %b
+}
+
+define i16 @select(i16 %a, i16 %b) {
+; CHECK-LABEL: select:
+; CHECK: bltu
+  %1 = icmp ult i16 %a, %b
+  %2 = select i1 %1, i16 %a, i16 %b
+  ret i16 %2
+}
+
+define i16 @sext(i8 %a) {
+; CHECK-LABEL: sext:
+; CHECK: lsli ${{r[0-9]+}}, ${{r[0-9]+}}, 8
+; CHECK: asri ${{r[0-9]+}}, ${{r[0-9]+}}, 8
+  %1 = sext i8 %a to i16
+  ret i16 %1
+}
+
+@g = global i16 0
+
+define void @global_store(i16 %a) {
+; CHECK-LABEL: global_store:
+; CHECK: movi ${{r[0-9]+}}, g
+; CHECK: stw [${{r[0-9]+}}, 0], ${{r[0-9]+}}
+  store i16 %a, i16* @g
+  ret void
+}
+
+define i16 @call(i16 %a) {
+; CHECK-LABEL: call:
+; CHECK: bal add_imm, $r0
+  %1 = call i16 @add_imm(i16 %a)
+  ret i16 %1
+}
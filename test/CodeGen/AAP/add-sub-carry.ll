@@ -22,8 +22,8 @@ define i32 @subcarry(i32 %a, i32 %b) {
 define i64 @addcarry64(i64 %a, i64 %b) {
 ; CHECK-LABEL: addcarry64:
 ; CHECK:         ldw $[[ARGB3:r[0-9]+]], [$r1, 0]
-; CHECK:         ldw $[[ARGB4:r[0-9]+]], [$r1, 2]
 ; CHECK:         add $r2, $r2, $r6
+; CHECK:         ldw $[[ARGB4:r[0-9]+]], [$r1, 2]
 ; CHECK:         addc $r3, $r3, $r7
 ; CHECK:         addc $r4, $r4, $[[ARGB3]]
 ; CHECK:         addc $r5, $r5, $[[ARGB4]]
@@ -34,8 +34,8 @@ define i64 @addcarry64(i64 %a, i64 %b) {
 define i64 @subcarry64(i64 %a, i64 %b) {
 ; CHECK-LABEL: subcarry64:
 ; CHECK:         ldw $[[ARGB3:r[0-9]+]], [$r1, 0]
-; CHECK:         ldw $[[ARGB4:r[0-9]+]], [$r1, 2]
 ; CHECK:         sub $r2, $r2, $r6
+; CHECK:         ldw $[[ARGB4:r[0-9]+]], [$r1, 2]
 ; CHECK:         subc $r3, $r3, $r7
 ; CHECK:         subc $r4, $r4, $[[ARGB3]]
 ; CHECK:         subc $r5, $r5, $[[ARGB4]]
@@ -13,10 +13,9 @@ declare void @test_false()
 
 define void @test_bcc_fallthrough_taken(i16 %in) nounwind {
 ; CHECK-LABEL: test_bcc_fallthrough_taken:
-; CHECK:         subi $r1, $r1, 2
-; CHECK:         stw [$r1, 0], $r0           ; 2-byte Folded Spill
+; CHECK:         stw [-$r1, 0], $r0           ; 2-byte Folded Spill
 ; CHECK:         movi $r10, 42
-; CHECK:         bne .LBB0_3, $r2, $r10
+; CHECK:         bne .LBB0_2, $r2, $r10
   %tst = icmp eq i16 %in, 42
   br i1 %tst, label %true, label %false, !prof !0
 
@@ -28,36 +27,33 @@ true:
 ; CHECK:         bal test_true, $r0
   call void @test_true()
 
-; CHECK:       .LBB0_2
-; CHECK:         ldw $r0, [$r1, 0]
-; CHECK:         addi $r1, $r1, 2
+; CHECK:         ldw $r0, [$r1+, 0]
   ret void ; CHECK: jmp   {{.*JMP}}
 
+; The epilogue is small enough to be duplicated into both returning blocks.
 false:
-; CHECK:       .LBB0_3
+; CHECK:       .LBB0_2
 ; CHECK:         bal test_false, $r0
-; CHECK:         bra .LBB0_2
+; CHECK:         ldw $r0, [$r1+, 0]
+; CHECK:         jmp $r0
   call void @test_false()
   ret void
 }
 
 define void @test_bcc_fallthrough_nottaken(i16 %in) nounwind {
 ; CHECK-LABEL: test_bcc_fallthrough_nottaken:
-; CHECK:         subi $r1, $r1, 2
-; CHECK:         stw [$r1, 0], $r0
+; CHECK:         stw [-$r1, 0], $r0
 ; CHECK:         movi $r10, 42
-; CHECK:         beq .LBB1_3, $r2, $r10
+; CHECK:         beq .LBB1_2, $r2, $r10
 ;
 ; CHECK:         bal test_false, $r0
-;
-; CHECK:       .LBB1_2:
-; CHECK:         ldw $r0, [$r1, 0]
-; CHECK:         addi $r1, $r1, 2
+; CHECK:         ldw $r0, [$r1+, 0]
 ; CHECK:         jmp $r0
 ;
-; CHECK:       .LBB1_3:
+; CHECK:       .LBB1_2:
 ; CHECK:         bal test_true, $r0
-; CHECK:         bra .LBB1_2
+; CHECK:         ldw $r0, [$r1+, 0]
+; CHECK:         jmp $r0
   %tst = icmp eq i16 %in, 42
   br i1 %tst, label %true, label %false, !prof !1
 
@@ -36,11 +36,10 @@ define i32 @test_bswap_i32(i32 %a) nounwind {
 
 define i16 @test_cttz_i16(i16 %a) nounwind {
 ; CHECK-LABEL: test_cttz_i16:
-; CHECK:         subi $r1, $r1, 4
-; CHECK:         stw [$r1, 2], $r0
-; CHECK:         stw [$r1, 0], $r3
 ; CHECK:         movi $[[REG1:r[0-9]+]], 0
-; CHECK:         beq .[[PRE:LBB[0-9]+_[0-9]+]], $r2, $[[REG1]]
+; CHECK:         beq .[[ZERO:LBB[0-9]+_[0-9]+]], $r2, $[[REG1]]
+; CHECK:         stw [-$r1, 0], $r0
+; CHECK:         stw [-$r1, 0], $r3
 ; CHECK:         movi $[[REG1]], -1
 ; CHECK:         xor $[[REG1]], $r2, $[[REG1]]
 ; CHECK:         subi $r2, $r2, 1
@@ -61,24 +60,21 @@ define i16 @test_cttz_i16(i16 %a) nounwind {
 ; CHECK:         movi $r3, 257
 ; CHECK:         bal __mulhi3, $r0
 ; CHECK:         lsri $r2, $r2, 8
-; CHECK:         bra .[[END:LBB[0-9]+_[0-9]+]]
-; CHECK:       .[[PRE]]
+; CHECK:         ldw $r3, [$r1+, 0]
+; CHECK:         ldw $r0, [$r1+, 0]
+; CHECK:         jmp $r0
+; CHECK:       .[[ZERO]]:
 ; CHECK:         movi $r2, 16
-; CHECK:       .[[END]]:
-; CHECK:         ldw $r3, [$r1, 0]
-; CHECK:         ldw $r0, [$r1, 2]
-; CHECK:         addi $r1, $r1, 4
   %tmp = call i16 @llvm.cttz.i16(i16 %a, i1 false)
   ret i16 %tmp ; CHECK: jmp   {{.*JMP}}
 }
 
 define i16 @test_ctlz_i16(i16 %a) nounwind {
 ; CHECK-LABEL: test_ctlz_i16:
-; CHECK:         subi $r1, $r1, 4
-; CHECK:         stw [$r1, 2], $r0
-; CHECK:         stw [$r1, 0], $r3
 ; CHECK:         movi $[[REG1:r[0-9]+]], 0
-; CHECK:         beq .[[PRE:LBB[0-9]+_[0-9]+]], $r2, $[[REG1]]
+; CHECK:         beq .[[ZERO:LBB[0-9]+_[0-9]+]], $r2, $[[REG1]]
+; CHECK:         stw [-$r1, 0], $r0
+; CHECK:         stw [-$r1, 0], $r3
 ; CHECK:         lsri $[[REG1]], $r2, 1
 ; CHECK:         or $r2, $r2, $[[REG1]]
 ; CHECK:         lsri $[[REG1]], $r2, 2
@@ -89,9 +85,9 @@ define i16 @test_ctlz_i16(i16 %a) nounwind {
 ; CHECK:         or $r2, $r2, $[[REG1]]
 ; CHECK:         movi $[[REG1]], -1
 ; CHECK:         xor $r2, $r2, $[[REG1]]
-; CHECK:         movi $[[REG1]], 21845
-; CHECK:         lsri $[[REG2:r[0-9]+]], $r2, 1
-; CHECK:         and $[[REG1]], $[[REG2]], $[[REG1]]
+; CHECK:         lsri $[[REG1]], $r2, 1
+; CHECK:         movi $[[REG2:r[0-9]+]], 21845
+; CHECK:         and $[[REG1]], $[[REG1]], $[[REG2]]
 ; CHECK:         sub $r2, $r2, $[[REG1]]
 ; CHECK:         movi $[[REG1]], 13107
 ; CHECK:         and $[[REG2]], $r2, $[[REG1]]
@@ -105,22 +101,19 @@ define i16 @test_ctlz_i16(i16 %a) nounwind {
 ; CHECK:         movi $r3, 257
 ; CHECK:         bal __mulhi3, $r0
 ; CHECK:         lsri $r2, $r2, 8
-; CHECK:         bra .[[END:LBB[0-9]+_[0-9]+]]
-; CHECK:       .[[PRE]]:
+; CHECK:         ldw $r3, [$r1+, 0]
+; CHECK:         ldw $r0, [$r1+, 0]
+; CHECK:         jmp $r0
+; CHECK:       .[[ZERO]]:
 ; CHECK:         movi $r2, 16
-; CHECK:       .[[END]]:
-; CHECK:         ldw $r3, [$r1, 0]
-; CHECK:         ldw $r0, [$r1, 2]
-; CHECK:         addi $r1, $r1, 4
   %tmp = call i16 @llvm.ctlz.i16(i16 %a, i1 false)
   ret i16 %tmp ; CHECK: jmp   {{.*JMP}}
 }
 
 define i16 @test_cttz_i16_zero_undef(i16 %a) nounwind {
 ; CHECK-LABEL: test_cttz_i16_zero_undef:
-; CHECK:         subi $r1, $r1, 4
-; CHECK:         stw [$r1, 2], $r0
-; CHECK:         stw [$r1, 0], $r3
+; CHECK:         stw [-$r1, 0], $r0
+; CHECK:         stw [-$r1, 0], $r3
 ; CHECK:         movi $[[REG1:r[0-9]+]], -1
 ; CHECK:         xor $[[REG1]], $r2, $[[REG1]]
 ; CHECK:         subi $r2, $r2, 1
@@ -141,18 +134,16 @@ define i16 @test_cttz_i16_zero_undef(i16 %a) nounwind {
 ; CHECK:         movi $r3, 257
 ; CHECK:         bal __mulhi3, $r0
 ; CHECK:         lsri $r2, $r2, 8
-; CHECK:         ldw $r3, [$r1, 0]
-; CHECK:         ldw $r0, [$r1, 2]
-; CHECK:         addi $r1, $r1, 4
+; CHECK:         ldw $r3, [$r1+, 0]
+; CHECK:         ldw $r0, [$r1+, 0]
   %tmp = call i16 @llvm.cttz.i16(i16 %a, i1 true)
   ret i16 %tmp ; CHECK: jmp   {{.*JMP}}
 }
 
 define i16 @test_ctlz_i16_zero_undef(i16 %a) nounwind {
 ; CHECK-LABEL: test_ctlz_i16_zero_undef:
-; CHECK:         subi $r1, $r1, 4
-; CHECK:         stw [$r1, 2], $r0
-; CHECK:         stw [$r1, 0], $r3
+; CHECK:         stw [-$r1, 0], $r0
+; CHECK:         stw [-$r1, 0], $r3
 ; CHECK:         lsri $[[REG1:r[0-9]+]], $r2, 1
 ; CHECK:         or $r2, $r2, $[[REG1]]
 ; CHECK:         lsri $[[REG1]], $r2, 2
@@ -163,9 +154,9 @@ define i16 @test_ctlz_i16_zero_undef(i16 %a) nounwind {
 ; CHECK:         or $r2, $r2, $[[REG1]]
 ; CHECK:         movi $[[REG1]], -1
 ; CHECK:         xor $r2, $r2, $[[REG1]]
-; CHECK:         movi $[[REG1]], 21845
-; CHECK:         lsri $[[REG2:r[0-9]+]], $r2, 1
-; CHECK:         and $[[REG1]], $[[REG2:r[0-9]+]], $[[REG1]]
+; CHECK:         lsri $[[REG1]], $r2, 1
+; CHECK:         movi $[[REG2:r[0-9]+]], 21845
+; CHECK:         and $[[REG1]], $[[REG1]], $[[REG2]]
 ; CHECK:         sub $r2, $r2, $[[REG1]]
 ; CHECK:         movi $[[REG1]], 13107
 ; CHECK:         and $[[REG2:r[0-9]+]], $r2, $[[REG1]]
@@ -179,18 +170,16 @@ define i16 @test_ctlz_i16_zero_undef(i16 %a) nounwind {
 ; CHECK:         movi $r3, 257
 ; CHECK:         bal __mulhi3, $r0
 ; CHECK:         lsri $r2, $r2, 8
-; CHECK:         ldw $r3, [$r1, 0]
-; CHECK:         ldw $r0, [$r1, 2]
-; CHECK:         addi $r1, $r1, 4
+; CHECK:         ldw $r3, [$r1+, 0]
+; CHECK:         ldw $r0, [$r1+, 0]
   %tmp = call i16 @llvm.ctlz.i16(i16 %a, i1 true)
   ret i16 %tmp ; CHECK: jmp   {{.*JMP}}
 }
 
 define i16 @test_ctpop_i16(i16 %a) nounwind {
 ; CHECK-LABEL: test_ctpop_i16:
-; CHECK:         subi $r1, $r1, 4
-; CHECK:         stw [$r1, 2], $r0
-; CHECK:         stw [$r1, 0], $r3
+; CHECK:         stw [-$r1, 0], $r0
+; CHECK:         stw [-$r1, 0], $r3
 ; CHECK:         lsri $r10, $r2, 1
 ; CHECK:         movi $r13, 21845
 ; CHECK:         and $r10, $r10, $r13
@@ -207,9 +196,8 @@ define i16 @test_ctpop_i16(i16 %a) nounwind {
 ; CHECK:         movi $r3, 257
 ; CHECK:         bal __mulhi3, $r0
 ; CHECK:         lsri $r2, $r2, 8
-; CHECK:         ldw $r3, [$r1, 0]
-; CHECK:         ldw $r0, [$r1, 2]
-; CHECK:         addi $r1, $r1, 4
+; CHECK:         ldw $r3, [$r1+, 0]
+; CHECK:         ldw $r0, [$r1+, 0]
   %1 = call i16 @llvm.ctpop.i16(i16 %a)
   ret i16 %1 ; CHECK: jmp   {{.*JMP}}
 }
@@ -0,0 +1,52 @@
+; RUN: llc -march=aap -asm-show-inst -aap-branch-placement < %s | FileCheck %s
+; RUN: llc -march=aap -asm-show-inst < %s | FileCheck %s -check-prefix=NOPLACE
+
+; Check that cold blocks are moved to the end of the function, out of the way
+; of the hot branches, when -aap-branch-placement is given, and that branches
+; to blocks in range use the short form. Blocks are not moved by default.
+
+declare void @report(i16)
+
+define void @cold_in_loop(i16* %p, i16 %n) nounwind {
+; CHECK-LABEL: cold_in_loop:
+; CHECK-NOT:   bra
+; CHECK:     [[LOOP:.LBB[0-9_]+]]: ; %loop
+; CHECK:       beq [[ERROR:.LBB[0-9_]+]],
+; CHECK:     [[LATCH:.LBB[0-9_]+]]: ; %latch
+; CHECK:       bne [[LOOP]],
+; CHECK:       jmp $r0
+; CHECK:     [[ERROR]]: ; %error
+; CHECK:       bal report, $r0
+; CHECK:       bra [[LATCH]]
+; CHECK-SAME:  BRA_short
+;
+; NOPLACE-LABEL: cold_in_loop:
+; NOPLACE:       bal report, $r0
+; NOPLACE:       jmp $r0
+entry:
+  br label %loop
+
+loop:
+  %i = phi i16 [ 0, %entry ], [ %inc, %latch ]
+  %v = load volatile i16, i16* %p
+  %bad = icmp eq i16 %v, 0
+  br i1 %bad, label %error, label %latch, !prof !0
+
+error:
+  call void @report(i16 %i)
+  call void @report(i16 %v)
+  call void @report(i16 %n)
+  br label %latch
+
+latch:
+  store volatile i16 %i, i16* %p
+  %inc = add i16 %i, 1
+  %done = icmp eq i16 %inc, %n
+  br i1 %done, label %exit, label %loop, !prof !1
+
+exit:
+  ret void
+}
+
+!0 = !{!"branch_weights", i32 1, i32 100000}
+!1 = !{!"branch_weights", i32 1, i32 1000}
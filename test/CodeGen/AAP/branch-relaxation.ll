@@ -15,12 +15,12 @@
 ;   bra after
 ; before:
 ;   ...
-define i32 @rel_beq(i32 %a) {
+define i32 @rel_beq(i16 %a) {
 entry:
 ;CHECK:     rel_beq:
 ;CHECK:       bne .LBB0_1, ${{r[0-9]+}}, ${{r[0-9]+}}
 ;CHECK:       bra .LBB0_2
-  %cmp = icmp eq i32 %a, 0
+  %cmp = icmp eq i16 %a, 0
   br i1 %cmp, label %return, label %if.end
 
 if.end:
@@ -47,12 +47,12 @@ return:
 ;   bra after
 ; before:
 ;   ...
-define i32 @rel_blts(i32 %a) {
+define i32 @rel_blts(i16 %a) {
 entry:
 ;CHECK:     rel_blts:
 ;CHECK:       blts .LBB1_3, ${{r[0-9]+}}, ${{r[0-9]+}}
 ;CHECK:       bra  .LBB1_1
-  %cmp = icmp slt i32 %a, 0
+  %cmp = icmp slt i16 %a, 0
   br i1 %cmp, label %return, label %if.end
 
 ;CHECK:     .LBB1_3:
@@ -0,0 +1,23 @@
+; RUN: llc -march=aap -show-mc-encoding < %s | FileCheck %s
+
+
+; Check that instructions which are only created after the short instruction
+; peephole has run still get the short encoding when emitted.
+
+
+; Returns are expanded to a jmp through the link register during emission.
+define void @ret_void() {
+entry:
+; CHECK-LABEL: ret_void:
+; CHECK: jmp $r0 {{.*}}encoding: [0x00,0x50]
+  ret void
+}
+
+define i16 @ret_value(i16 %a, i16 %b) {
+entry:
+; CHECK-LABEL: ret_value:
+; CHECK: add $r2, $r2, $r3 {{.*}}encoding: [0x93,0x02]
+; CHECK: jmp $r0 {{.*}}encoding: [0x00,0x50]
+  %0 = add i16 %a, %b
+  ret i16 %0
+}
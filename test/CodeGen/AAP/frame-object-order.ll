@@ -0,0 +1,79 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+; RUN: llc -march=aap -O0 < %s | FileCheck %s -check-prefix=CHECK-O0
+
+; Check that frequently accessed stack objects are allocated nearest the stack
+; pointer, where loads and stores can use the short encodings, and that large
+; frames use the frame pointer as a base for the top of the frame.
+
+declare void @use(i16*)
+
+define void @hot_scalar() nounwind {
+; CHECK-LABEL: hot_scalar:
+; CHECK:       addi $r2, $r1, 2
+; CHECK:       bal use, $r0
+; CHECK:       stw [$r1, 0], ${{r[0-9]+}}
+; CHECK:     .LBB0_1:
+; CHECK:       ldw ${{r[0-9]+}}, [$r1, 0]
+; CHECK:       stw [$r1, 0], ${{r[0-9]+}}
+;
+; CHECK-O0-LABEL: hot_scalar:
+; CHECK-O0:    addi $r2, $r1, 6
+; CHECK-O0:    bal use, $r0
+; CHECK-O0:    stw [$r1, 22], ${{r[0-9]+}}
+entry:
+  %hot = alloca i16
+  %cold = alloca [8 x i16]
+  %arr = getelementptr [8 x i16], [8 x i16]* %cold, i16 0, i16 0
+  call void @use(i16* %arr)
+  store volatile i16 0, i16* %hot
+  br label %loop
+
+loop:
+  %i = phi i16 [ 0, %entry ], [ %inc, %loop ]
+  %v = load volatile i16, i16* %hot
+  %add = add i16 %v, %i
+  store volatile i16 %add, i16* %hot
+  %inc = add i16 %i, 1
+  %cmp = icmp ult i16 %inc, 16
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+define void @large_frame() nounwind {
+; CHECK-LABEL: large_frame:
+; CHECK:       stw [-$r1, 0], $r8
+; CHECK:       addi $r8, $r1, 8
+; CHECK:       subi $r1, $r1, 924
+; CHECK:       addi $r2, $r1, 2
+; CHECK:       stw [$r8, -410], ${{r[0-9]+}}
+; CHECK:       bal use, $r0
+; CHECK:     .LBB1_1:
+; CHECK:       ldw ${{r[0-9]+}}, [$r1, 0]
+; CHECK:       stw [$r1, 0], ${{r[0-9]+}}
+; CHECK:       stw [$r1, 2], ${{r[0-9]+}}
+entry:
+  %hot = alloca i16
+  %top = alloca [200 x i16]
+  %bottom = alloca [260 x i16]
+  %arr1 = getelementptr [200 x i16], [200 x i16]* %top, i16 0, i16 0
+  store volatile i16 0, i16* %arr1
+  %arr2 = getelementptr [260 x i16], [260 x i16]* %bottom, i16 0, i16 0
+  call void @use(i16* %arr2)
+  store volatile i16 0, i16* %hot
+  br label %loop
+
+loop:
+  %i = phi i16 [ 0, %entry ], [ %inc, %loop ]
+  %v = load volatile i16, i16* %hot
+  %add = add i16 %v, %i
+  store volatile i16 %add, i16* %hot
+  store volatile i16 %i, i16* %arr2
+  %inc = add i16 %i, 1
+  %cmp = icmp ult i16 %inc, 16
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
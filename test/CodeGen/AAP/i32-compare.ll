@@ -0,0 +1,102 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+
+; Check that i32 comparisons are lowered to a carry chain over the two halves
+; followed by a single branch, rather than a branch on each half.
+
+declare void @f()
+
+define void @br_ult(i32 %a, i32 %b) {
+; CHECK-LABEL: br_ult:
+; CHECK:         add
+; CHECK:         addc
+; CHECK:         addc
+; CHECK-NOT:     b{{eq|ne|lt|ltu|le|leu}} .LBB
+; CHECK:         b{{eq|ne}} .LBB
+; CHECK-NOT:     b{{eq|ne|lt|ltu|le|leu}} .LBB
+; CHECK:         jmp $r0
+entry:
+  %cmp = icmp ult i32 %a, %b
+  br i1 %cmp, label %then, label %exit
+
+then:
+  call void @f()
+  br label %exit
+
+exit:
+  ret void
+}
+
+define void @br_sgt(i32 %a, i32 %b) {
+; CHECK-LABEL: br_sgt:
+; CHECK:         xor
+; CHECK:         add
+; CHECK:         addc
+; CHECK:         addc
+; CHECK:         b{{eq|ne}} .LBB
+; CHECK-NOT:     b{{eq|ne|lt|ltu|le|leu}} .LBB
+; CHECK:         jmp $r0
+entry:
+  %cmp = icmp sgt i32 %a, %b
+  br i1 %cmp, label %then, label %exit
+
+then:
+  call void @f()
+  br label %exit
+
+exit:
+  ret void
+}
+
+define void @br_eq(i32 %a, i32 %b) {
+; CHECK-LABEL: br_eq:
+; CHECK:         xor
+; CHECK:         xor
+; CHECK:         or
+; CHECK:         b{{eq|ne}} .LBB
+; CHECK-NOT:     b{{eq|ne|lt|ltu|le|leu}} .LBB
+; CHECK:         jmp $r0
+entry:
+  %cmp = icmp eq i32 %a, %b
+  br i1 %cmp, label %then, label %exit
+
+then:
+  call void @f()
+  br label %exit
+
+exit:
+  ret void
+}
+
+define i16 @setcc_uge(i32 %a, i32 %b) {
+; CHECK-LABEL: setcc_uge:
+; CHECK:         add
+; CHECK:         addc
+; CHECK:         addc
+; CHECK-NOT:     b{{eq|ne|lt|ltu|le|leu}} .LBB
+; CHECK:         jmp $r0
+  %cmp = icmp uge i32 %a, %b
+  %r = zext i1 %cmp to i16
+  ret i16 %r
+}
+
+define i16 @setcc_slt_zero(i32 %a) {
+; CHECK-LABEL: setcc_slt_zero:
+; CHECK:         lsri $r2, $r3, 15
+; CHECK-NEXT:    jmp $r0
+  %cmp = icmp slt i32 %a, 0
+  %r = zext i1 %cmp to i16
+  ret i16 %r
+}
+
+define i16 @select_ugt(i32 %a, i32 %b, i16 %x, i16 %y) {
+; CHECK-LABEL: select_ugt:
+; CHECK:         add
+; CHECK:         addc
+; CHECK:         addc
+; CHECK:         b{{eq|ne}} .LBB
+; CHECK-NOT:     b{{eq|ne|lt|ltu|le|leu}} .LBB
+; CHECK:         jmp $r0
+  %cmp = icmp ugt i32 %a, %b
+  %r = select i1 %cmp, i16 %x, i16 %y
+  ret i16 %r
+}
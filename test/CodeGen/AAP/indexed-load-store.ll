@@ -0,0 +1,87 @@
+; RUN: llc -asm-show-inst -march=aap < %s | FileCheck %s
+
+
+; Check that loads and stores which adjust their base pointer by the size of
+; the access are selected as post-increment and pre-decrement instructions.
+
+
+define i16* @ldw_postinc(i16* %p, i16* %out) {
+entry:
+;CHECK-LABEL: ldw_postinc:
+;CHECK: ldw ${{r[0-9]+}}, [$r2+, 0]          {{.*LDW_postinc(_short)?}}
+  %0 = load i16, i16* %p
+  store i16 %0, i16* %out
+  %1 = getelementptr i16, i16* %p, i16 1
+  ret i16* %1
+}
+
+define i8* @ldb_postinc(i8* %p, i8* %out) {
+entry:
+;CHECK-LABEL: ldb_postinc:
+;CHECK: ldb ${{r[0-9]+}}, [$r2+, 0]          {{.*LDB_postinc(_short)?}}
+  %0 = load i8, i8* %p
+  store i8 %0, i8* %out
+  %1 = getelementptr i8, i8* %p, i16 1
+  ret i8* %1
+}
+
+define i16* @stw_postinc(i16* %p, i16 %v) {
+entry:
+;CHECK-LABEL: stw_postinc:
+;CHECK: stw [$r2+, 0], $r3                  {{.*STW_postinc(_short)?}}
+;CHECK-NOT: add
+  store i16 %v, i16* %p
+  %0 = getelementptr i16, i16* %p, i16 1
+  ret i16* %0
+}
+
+define i8* @stb_postinc(i8* %p, i8 %v) {
+entry:
+;CHECK-LABEL: stb_postinc:
+;CHECK: stb [$r2+, 0], $r3                  {{.*STB_postinc(_short)?}}
+;CHECK-NOT: add
+  store i8 %v, i8* %p
+  %0 = getelementptr i8, i8* %p, i16 1
+  ret i8* %0
+}
+
+define i16* @ldw_predec(i16* %p, i16* %out) {
+entry:
+;CHECK-LABEL: ldw_predec:
+;CHECK: ldw ${{r[0-9]+}}, [-$r2, 0]          {{.*LDW_predec(_short)?}}
+  %0 = getelementptr i16, i16* %p, i16 -1
+  %1 = load i16, i16* %0
+  store i16 %1, i16* %out
+  ret i16* %0
+}
+
+define i16* @stw_predec(i16* %p, i16 %v) {
+entry:
+;CHECK-LABEL: stw_predec:
+;CHECK: stw [-$r2, 0], $r3                  {{.*STW_predec(_short)?}}
+;CHECK-NOT: sub
+  %0 = getelementptr i16, i16* %p, i16 -1
+  store i16 %v, i16* %0
+  ret i16* %0
+}
+
+define i8* @stb_predec(i8* %p, i8 %v) {
+entry:
+;CHECK-LABEL: stb_predec:
+;CHECK: stb [-$r2, 0], $r3                  {{.*STB_predec(_short)?}}
+;CHECK-NOT: sub
+  %0 = getelementptr i8, i8* %p, i16 -1
+  store i8 %v, i8* %0
+  ret i8* %0
+}
+
+; Adjustments which do not match the access size keep the plain addressing mode
+define i16* @ldw_no_postinc(i16* %p, i16* %out) {
+entry:
+;CHECK-LABEL: ldw_no_postinc:
+;CHECK: ldw ${{r[0-9]+}}, [$r2, 0]          {{.*LDW}}
+  %0 = load i16, i16* %p
+  store i16 %0, i16* %out
+  %1 = getelementptr i16, i16* %p, i16 2
+  ret i16* %1
+}
@@ -0,0 +1,65 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+; RUN: llc -march=aap -enable-ipra=false < %s | FileCheck %s --check-prefix=NOIPRA
+
+; Check that interprocedural register allocation and the fastcc and coldcc
+; callee saved register splits reduce the registers saved around calls.
+
+declare void @ext()
+
+; A local helper only preserves what its callers need, so it saves nothing.
+; Under the fastcc split R3 is clobbered by the call, so without IPRA the
+; caller moves %b into a register which the helper preserves.
+
+define internal fastcc i16 @helper(i16 %a) noinline nounwind {
+; CHECK-LABEL: helper:
+; CHECK-NOT:     stw
+; CHECK:         addi $r2, $r2, 1
+  %1 = add i16 %a, 1
+  ret i16 %1
+}
+
+define i16 @call_helper(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: call_helper:
+; CHECK-NOT:     $r3
+; CHECK:         bal helper, $r0
+; CHECK:         add $r2, $r2, $r3
+; NOIPRA-LABEL:  call_helper:
+; NOIPRA:        mov [[SAVE:\$r[0-9]+]], $r3
+; NOIPRA:        bal helper, $r0
+; NOIPRA:        add $r2, $r2, [[SAVE]]
+  %1 = call fastcc i16 @helper(i16 %a)
+  %2 = add i16 %1, %b
+  ret i16 %2
+}
+
+; The link register is still saved by local functions which make calls.
+
+define internal void @local_calls() noinline nounwind {
+; CHECK-LABEL: local_calls:
+; CHECK:         stw [-$r1, 0], $r0
+; CHECK:         bal ext, $r0
+; CHECK:         ldw $r0, [$r1+, 0]
+  call void @ext()
+  ret void
+}
+
+define void @call_local_calls() nounwind {
+  call void @local_calls()
+  ret void
+}
+
+; Cold functions preserve every allocatable register, so values are kept in
+; caller saved registers across calls to them.
+
+declare coldcc void @cold()
+
+define i16 @call_cold(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: call_cold:
+; CHECK-NOT:     mov
+; CHECK:         bal cold, $r0
+; CHECK-NOT:     mov
+; CHECK:         add $r2, $r2, $r3
+  call coldcc void @cold()
+  %1 = add i16 %a, %b
+  ret i16 %1
+}
@@ -0,0 +1,54 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+; RUN: llc -march=aap -aap-min-jump-table-entries=16 < %s \
+; RUN:     | FileCheck %s --check-prefix=NOTABLE
+
+
+; Check that dense switches are lowered to a load from a table of 16-bit
+; block addresses followed by an indirect jump.
+
+
+define i16 @dense(i16 %x) {
+entry:
+;CHECK-LABEL: dense:
+;CHECK: movi $[[TABLE:r[0-9]+]], .LJTI0_0
+;CHECK: ldw $[[TARGET:r[0-9]+]], [${{r[0-9]+}}, 0]
+;CHECK: jmp $[[TARGET]]
+
+;NOTABLE-LABEL: dense:
+;NOTABLE-NOT: .LJTI
+;NOTABLE-NOT: .rodata
+  switch i16 %x, label %default [
+    i16 0, label %bb0
+    i16 1, label %bb1
+    i16 2, label %bb2
+    i16 3, label %bb3
+    i16 4, label %bb4
+    i16 5, label %bb5
+    i16 6, label %bb6
+    i16 7, label %bb7
+    i16 8, label %bb8
+  ]
+
+bb0: ret i16 10
+bb1: ret i16 11
+bb2: ret i16 12
+bb3: ret i16 13
+bb4: ret i16 14
+bb5: ret i16 15
+bb6: ret i16 16
+bb7: ret i16 17
+bb8: ret i16 18
+default: ret i16 0
+}
+
+;CHECK: .section .rodata
+;CHECK: .LJTI0_0:
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
+;CHECK-NEXT: .short .LBB0_{{[0-9]+}}
@@ -0,0 +1,98 @@
+; RUN: llc -march=aap -enable-machine-outliner < %s | FileCheck %s
+; RUN: llc -march=aap < %s | FileCheck %s --check-prefix=DEFAULT
+
+; Check that repeated sequences are outlined, and that outlining is done by
+; default only for functions optimized for minimum size.
+
+@a = global i16 0
+@b = global i16 0
+@c = global i16 0
+@d = global i16 0
+
+declare void @ext(i16)
+declare void @done1()
+declare void @done2()
+
+; Sequences ending in a return are branched to.
+
+; CHECK-LABEL: tail1:
+; CHECK:         bra [[TAIL:OUTLINED_FUNCTION_[0-9]+]]
+; DEFAULT-LABEL: tail1:
+; DEFAULT-NOT:   OUTLINED_FUNCTION
+define void @tail1() {
+  store i16 1, i16* @a
+  store i16 2, i16* @b
+  store i16 3, i16* @c
+  ret void
+}
+
+; CHECK-LABEL: tail2:
+; CHECK:         bra [[TAIL]]
+; DEFAULT-LABEL: tail2:
+; DEFAULT-NOT:   OUTLINED_FUNCTION
+define void @tail2() {
+  store i16 1, i16* @a
+  store i16 2, i16* @b
+  store i16 3, i16* @c
+  ret void
+}
+
+; Sequences which end in a call tail call it from the outlined function.
+
+; CHECK-LABEL: thunk1:
+; CHECK:         bal [[THUNK:OUTLINED_FUNCTION_[0-9]+]], $r0
+; DEFAULT-LABEL: thunk1:
+; DEFAULT:       bal OUTLINED_FUNCTION
+define void @thunk1(i16 %x) minsize {
+  store volatile i16 %x, i16* @a
+  store volatile i16 %x, i16* @b
+  call void @ext(i16 %x)
+  call void @done1()
+  ret void
+}
+
+; CHECK-LABEL: thunk2:
+; CHECK:         bal [[THUNK]], $r0
+; DEFAULT-LABEL: thunk2:
+; DEFAULT:       bal OUTLINED_FUNCTION
+define void @thunk2(i16 %x) minsize {
+  store volatile i16 %x, i16* @a
+  store volatile i16 %x, i16* @b
+  call void @ext(i16 %x)
+  call void @done2()
+  ret void
+}
+
+; In leaf functions the link register is live, and is preserved in a free
+; register around the call.
+
+; CHECK-LABEL: leaf1:
+; CHECK:         mov [[SAVE:\$r[0-9]+]], $r0
+; CHECK-NEXT:    bal [[LEAF:OUTLINED_FUNCTION_[0-9]+]], $r0
+; CHECK-NEXT:    mov $r0, [[SAVE]]
+; CHECK-NEXT:    add $r2, ${{r[0-9]+}}, $r2
+define i16 @leaf1(i16 %x) {
+  store i16 5, i16* @a
+  store i16 6, i16* @b
+  store i16 7, i16* @c
+  %1 = load volatile i16, i16* @d
+  %2 = add i16 %1, %x
+  ret i16 %2
+}
+
+; CHECK-LABEL: leaf2:
+; CHECK:         mov [[SAVE:\$r[0-9]+]], $r0
+; CHECK-NEXT:    bal [[LEAF]], $r0
+; CHECK-NEXT:    mov $r0, [[SAVE]]
+define i16 @leaf2(i16 %x) {
+  store i16 5, i16* @a
+  store i16 6, i16* @b
+  store i16 7, i16* @c
+  %1 = load volatile i16, i16* @d
+  %2 = sub i16 %1, %x
+  ret i16 %2
+}
+
+; CHECK-DAG: [[TAIL]]:
+; CHECK-DAG: [[THUNK]]:
+; CHECK-DAG: [[LEAF]]:
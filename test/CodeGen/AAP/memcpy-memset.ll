@@ -0,0 +1,104 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+
+; Check that small copies and sets are unrolled, and larger or variable sized
+; ones become loops of post-increment loads and stores instead of calls.
+
+declare void @llvm.memcpy.p0i8.p0i8.i16(i8* nocapture, i8* nocapture readonly, i16, i1)
+declare void @llvm.memset.p0i8.i16(i8* nocapture, i8, i16, i1)
+
+define void @memcpy_small(i8* align 2 %dst, i8* align 2 %src) nounwind {
+; CHECK-LABEL: memcpy_small:
+; CHECK-NOT:     bal
+; CHECK:         ldw
+; CHECK:         stw
+; CHECK:         jmp
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* align 2 %dst, i8* align 2 %src, i16 8, i1 false)
+  ret void
+}
+
+define void @memcpy_large(i8* align 2 %dst, i8* align 2 %src) nounwind {
+; CHECK-LABEL: memcpy_large:
+; CHECK-NOT:     bal
+; CHECK:       [[LOOP:\.LBB[0-9_]+]]:
+; CHECK:         ldw [[VAL:\$r[0-9]+]], [$r{{[0-9]+}}+, 0]
+; CHECK:         subi [[COUNT:\$r[0-9]+]], [[COUNT]], 1
+; CHECK:         stw [$r{{[0-9]+}}+, 0], [[VAL]]
+; CHECK:         bne [[LOOP]], [[COUNT]], $r{{[0-9]+}}
+; CHECK-NOT:     ldb
+; CHECK:         jmp
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* align 2 %dst, i8* align 2 %src, i16 64, i1 false)
+  ret void
+}
+
+; A known odd size copies the last byte after the loop
+define void @memcpy_large_odd(i8* align 2 %dst, i8* align 2 %src) nounwind {
+; CHECK-LABEL: memcpy_large_odd:
+; CHECK-NOT:     bal
+; CHECK:         ldw {{.*}}+
+; CHECK:         stw {{.*}}+
+; CHECK:         bne
+; CHECK:         ldb [[BYTE:\$r[0-9]+]]
+; CHECK:         stb [{{.*}}], [[BYTE]]
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* align 2 %dst, i8* align 2 %src, i16 65, i1 false)
+  ret void
+}
+
+; A variable size checks for an empty loop and a trailing byte
+define void @memcpy_variable(i8* align 2 %dst, i8* align 2 %src, i16 %n) nounwind {
+; CHECK-LABEL: memcpy_variable:
+; CHECK-NOT:     bal
+; CHECK:         lsri [[COUNT:\$r[0-9]+]], $r4, 1
+; CHECK:         beq
+; CHECK:         ldw {{.*}}+
+; CHECK:         stw {{.*}}+
+; CHECK:         bne
+; CHECK:         andi {{.*}}, $r4, 1
+; CHECK:         beq
+; CHECK:         ldb
+; CHECK:         stb
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* align 2 %dst, i8* align 2 %src, i16 %n, i1 false)
+  ret void
+}
+
+; Unaligned copies use a byte loop
+define void @memcpy_unaligned(i8* %dst, i8* %src, i16 %n) nounwind {
+; CHECK-LABEL: memcpy_unaligned:
+; CHECK-NOT:     bal
+; CHECK:         ldb {{.*}}+
+; CHECK:         stb {{.*}}+
+; CHECK:         bne
+; CHECK-NOT:     andi
+; CHECK:         jmp
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* %dst, i8* %src, i16 %n, i1 false)
+  ret void
+}
+
+define void @memset_large(i8* align 2 %dst, i8 %val) nounwind {
+; CHECK-LABEL: memset_large:
+; CHECK-NOT:     bal
+; CHECK:         lsli
+; CHECK:         or [[SPLAT:\$r[0-9]+]]
+; CHECK:       [[LOOP:\.LBB[0-9_]+]]:
+; CHECK:         stw [$r{{[0-9]+}}+, 0], [[SPLAT]]
+; CHECK:         bne [[LOOP]]
+  call void @llvm.memset.p0i8.i16(i8* align 2 %dst, i8 %val, i16 64, i1 false)
+  ret void
+}
+
+define void @memset_zero_variable(i8* align 2 %dst, i16 %n) nounwind {
+; CHECK-LABEL: memset_zero_variable:
+; CHECK-NOT:     bal
+; CHECK:         stw {{.*}}+
+; CHECK:         bne
+; CHECK:         stb
+  call void @llvm.memset.p0i8.i16(i8* align 2 %dst, i8 0, i16 %n, i1 false)
+  ret void
+}
+
+; At minsize a call is smaller than a loop
+define void @memcpy_minsize(i8* align 2 %dst, i8* align 2 %src, i16 %n) minsize nounwind {
+; CHECK-LABEL: memcpy_minsize:
+; CHECK:         bal memcpy
+  call void @llvm.memcpy.p0i8.p0i8.i16(i8* align 2 %dst, i8* align 2 %src, i16 %n, i1 false)
+  ret void
+}
@@ -0,0 +1,338 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+; RUN: llc -march=aap -mattr=+mul < %s | FileCheck -check-prefix=MUL %s
+
+; Check that multiplies, divides and remainders by constants are expanded
+; inline instead of calling the runtime library, unless optimizing for size.
+; Without a multiplier the magic numbers are multiplied by shifts and adds, so
+; the shift amounts below encode them. With +mul they are materialized whole.
+
+define i16 @mul_neg(i16 %a) nounwind {
+; CHECK-LABEL: mul_neg:
+; CHECK:      lsli $r10, $r2, 2
+; CHECK-NEXT: sub $r2, $r2, $r10
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: mul_neg:
+; MUL:      movi $r10, -3
+; MUL-NEXT: mul $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = mul i16 %a, -3
+  ret i16 %1
+}
+
+define i16 @mul_many_ops(i16 %a) nounwind {
+; CHECK-LABEL: mul_many_ops:
+; CHECK:      stw [-$r1, 0], $r0
+; CHECK-NEXT: stw [-$r1, 0], $r3
+; CHECK-NEXT: movi $r3, 21845
+; CHECK-NEXT: bal __mulhi3, $r0
+; CHECK-NEXT: ldw $r3, [$r1+, 0]
+; CHECK-NEXT: ldw $r0, [$r1+, 0]
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: mul_many_ops:
+; MUL:      movi $r10, 21845
+; MUL-NEXT: mul $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = mul i16 %a, 21845
+  ret i16 %1
+}
+
+define i16 @udiv_pre_shift(i16 %a) nounwind {
+; CHECK-LABEL: udiv_pre_shift:
+; CHECK:      stw [-$r1, 0], $r3
+; CHECK-NEXT: lsri $r3, $r2, 1
+; CHECK-NEXT: lsli $r13, $r3, 2
+; CHECK-NEXT: lsri $r10, $r2, 15
+; CHECK-NEXT: movi $r16, 0
+; CHECK-NEXT: add $r13, $r3, $r13
+; CHECK-NEXT: addc $r10, $r10, $r16
+; CHECK-NEXT: lsli $r19, $r3, 5
+; CHECK-NEXT: lsri $r16, $r2, 12
+; CHECK-NEXT: add $r13, $r13, $r19
+; CHECK-NEXT: addc $r10, $r10, $r16
+; CHECK-NEXT: lsli $r19, $r3, 8
+; CHECK-NEXT: lsri $r16, $r2, 9
+; CHECK-NEXT: add $r13, $r13, $r19
+; CHECK-NEXT: addc $r10, $r10, $r16
+; CHECK-NEXT: lsli $r19, $r3, 11
+; CHECK-NEXT: lsri $r16, $r2, 6
+; CHECK-NEXT: add $r13, $r13, $r19
+; CHECK-NEXT: addc $r10, $r10, $r16
+; CHECK-NEXT: lsli $r16, $r3, 14
+; CHECK-NEXT: lsri $r2, $r2, 3
+; CHECK-NEXT: add $r13, $r13, $r16
+; CHECK-NEXT: addc $r2, $r10, $r2
+; CHECK-NEXT: lsri $r2, $r2, 1
+; CHECK-NEXT: ldw $r3, [$r1+, 0]
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: udiv_pre_shift:
+; MUL:      lsri $r2, $r2, 1
+; MUL-NEXT: movi $r10, 18725
+; MUL-NEXT: mulhu $r2, $r2, $r10
+; MUL-NEXT: lsri $r2, $r2, 1
+; MUL-NEXT: jmp $r0
+  %1 = udiv i16 %a, 14
+  ret i16 %1
+}
+
+define i16 @udiv_npq(i16 %a) nounwind {
+; CHECK-LABEL: udiv_npq:
+; CHECK:      lsli $r10, $r2, 4
+; CHECK-NEXT: lsli $r13, $r2, 2
+; CHECK-NEXT: lsri $r16, $r2, 12
+; CHECK-NEXT: lsri $r19, $r2, 14
+; CHECK-NEXT: add $r10, $r13, $r10
+; CHECK-NEXT: addc $r13, $r19, $r16
+; CHECK-NEXT: lsli $r16, $r2, 7
+; CHECK-NEXT: lsri $r19, $r2, 9
+; CHECK-NEXT: add $r10, $r10, $r16
+; CHECK-NEXT: addc $r13, $r13, $r19
+; CHECK-NEXT: lsli $r16, $r2, 10
+; CHECK-NEXT: lsri $r19, $r2, 6
+; CHECK-NEXT: add $r10, $r10, $r16
+; CHECK-NEXT: addc $r13, $r13, $r19
+; CHECK-NEXT: lsli $r16, $r2, 13
+; CHECK-NEXT: lsri $r19, $r2, 3
+; CHECK-NEXT: add $r10, $r10, $r16
+; CHECK-NEXT: addc $r13, $r13, $r19
+; CHECK-NEXT: movi $r16, 0
+; CHECK-NEXT: sub $r10, $r10, $r2
+; CHECK-NEXT: subc $r10, $r13, $r16
+; CHECK-NEXT: sub $r2, $r2, $r10
+; CHECK-NEXT: lsri $r2, $r2, 1
+; CHECK-NEXT: add $r2, $r2, $r10
+; CHECK-NEXT: lsri $r2, $r2, 2
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: udiv_npq:
+; MUL:      movi $r10, 9363
+; MUL-NEXT: mulhu $r10, $r2, $r10
+; MUL-NEXT: sub $r2, $r2, $r10
+; MUL-NEXT: lsri $r2, $r2, 1
+; MUL-NEXT: add $r2, $r2, $r10
+; MUL-NEXT: lsri $r2, $r2, 2
+; MUL-NEXT: jmp $r0
+  %1 = udiv i16 %a, 7
+  ret i16 %1
+}
+
+define i16 @sdiv_neg(i16 %a) nounwind {
+; CHECK-LABEL: sdiv_neg:
+; CHECK:      stw [-$r1, 0], $r3
+; CHECK-NEXT: asri $r3, $r2, 15
+; CHECK-NEXT: movi $r10, 0
+; CHECK-NEXT: sub $r13, $r10, $r2
+; CHECK-NEXT: lsri $r16, $r2, 14
+; CHECK-NEXT: lsli $r19, $r3, 2
+; CHECK-NEXT: subc $r10, $r10, $r3
+; CHECK-NEXT: or $r16, $r19, $r16
+; CHECK-NEXT: lsli $r19, $r2, 2
+; CHECK-NEXT: sub $r13, $r13, $r19
+; CHECK-NEXT: subc $r10, $r10, $r16
+; CHECK-NEXT: lsri $r16, $r2, 11
+; CHECK-NEXT: lsli $r19, $r3, 5
+; CHECK-NEXT: or $r16, $r19, $r16
+; CHECK-NEXT: lsli $r19, $r2, 5
+; CHECK-NEXT: sub $r13, $r13, $r19
+; CHECK-NEXT: subc $r10, $r10, $r16
+; CHECK-NEXT: lsri $r16, $r2, 8
+; CHECK-NEXT: lsli $r19, $r3, 8
+; CHECK-NEXT: or $r16, $r19, $r16
+; CHECK-NEXT: lsli $r19, $r2, 8
+; CHECK-NEXT: sub $r13, $r13, $r19
+; CHECK-NEXT: subc $r10, $r10, $r16
+; CHECK-NEXT: lsri $r16, $r2, 5
+; CHECK-NEXT: lsli $r19, $r3, 11
+; CHECK-NEXT: or $r16, $r19, $r16
+; CHECK-NEXT: lsli $r19, $r2, 11
+; CHECK-NEXT: sub $r13, $r13, $r19
+; CHECK-NEXT: subc $r10, $r10, $r16
+; CHECK-NEXT: lsri $r16, $r2, 2
+; CHECK-NEXT: lsli $r19, $r3, 14
+; CHECK-NEXT: lsli $r2, $r2, 14
+; CHECK-NEXT: or $r16, $r19, $r16
+; CHECK-NEXT: sub $r2, $r13, $r2
+; CHECK-NEXT: subc $r2, $r10, $r16
+; CHECK-NEXT: lsri $r10, $r2, 15
+; CHECK-NEXT: asri $r2, $r2, 1
+; CHECK-NEXT: add $r2, $r2, $r10
+; CHECK-NEXT: ldw $r3, [$r1+, 0]
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: sdiv_neg:
+; MUL:      movi $r10, -18725
+; MUL-NEXT: mulhs $r2, $r2, $r10
+; MUL-NEXT: lsri $r10, $r2, 15
+; MUL-NEXT: asri $r2, $r2, 1
+; MUL-NEXT: add $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = sdiv i16 %a, -7
+  ret i16 %1
+}
+
+define i16 @urem_const(i16 %a) nounwind {
+; CHECK-LABEL: urem_const:
+; CHECK:      lsli $r10, $r2, 4
+; CHECK-NEXT: lsri $r13, $r2, 12
+; CHECK-NEXT: movi $r16, 0
+; CHECK-NEXT: add $r10, $r2, $r10
+; CHECK-NEXT: addc $r13, $r13, $r16
+; CHECK-NEXT: lsli $r16, $r2, 8
+; CHECK-NEXT: lsri $r19, $r2, 8
+; CHECK-NEXT: add $r10, $r10, $r16
+; CHECK-NEXT: addc $r13, $r13, $r19
+; CHECK-NEXT: lsli $r16, $r2, 12
+; CHECK-NEXT: lsri $r19, $r2, 4
+; CHECK-NEXT: add $r10, $r10, $r16
+; CHECK-NEXT: addc $r13, $r13, $r19
+; CHECK-NEXT: add $r13, $r13, $r2
+; CHECK-NEXT: lsli $r16, $r2, 2
+; CHECK-NEXT: lsri $r19, $r2, 14
+; CHECK-NEXT: sub $r10, $r10, $r16
+; CHECK-NEXT: subc $r13, $r13, $r19
+; CHECK-NEXT: lsli $r16, $r2, 6
+; CHECK-NEXT: lsri $r19, $r2, 10
+; CHECK-NEXT: sub $r10, $r10, $r16
+; CHECK-NEXT: subc $r13, $r13, $r19
+; CHECK-NEXT: lsli $r16, $r2, 10
+; CHECK-NEXT: lsri $r19, $r2, 6
+; CHECK-NEXT: sub $r10, $r10, $r16
+; CHECK-NEXT: subc $r13, $r13, $r19
+; CHECK-NEXT: lsli $r16, $r2, 14
+; CHECK-NEXT: lsri $r19, $r2, 2
+; CHECK-NEXT: sub $r10, $r10, $r16
+; CHECK-NEXT: subc $r10, $r13, $r19
+; CHECK-NEXT: lsri $r10, $r10, 3
+; CHECK-NEXT: lsli $r13, $r10, 3
+; CHECK-NEXT: lsli $r10, $r10, 1
+; CHECK-NEXT: add $r10, $r10, $r13
+; CHECK-NEXT: sub $r2, $r2, $r10
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: urem_const:
+; MUL:      movi $r10, -13107
+; MUL-NEXT: mulhu $r10, $r2, $r10
+; MUL-NEXT: movi $r13, 10
+; MUL-NEXT: lsri $r10, $r10, 3
+; MUL-NEXT: mul $r10, $r10, $r13
+; MUL-NEXT: sub $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = urem i16 %a, 10
+  ret i16 %1
+}
+
+define i16 @srem_const(i16 %a) nounwind {
+; CHECK-LABEL: srem_const:
+; CHECK:      stw [-$r1, 0], $r3
+; CHECK-NEXT: movi $r10, -32768
+; CHECK-NEXT: and $r10, $r2, $r10
+; CHECK-NEXT: lsri $r13, $r2, 1
+; CHECK-NEXT: asri $r3, $r2, 15
+; CHECK-NEXT: or $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 15
+; CHECK-NEXT: lsli $r16, $r3, 1
+; CHECK-NEXT: or $r13, $r16, $r13
+; CHECK-NEXT: lsli $r16, $r2, 1
+; CHECK-NEXT: lsli $r19, $r2, 15
+; CHECK-NEXT: sub $r16, $r19, $r16
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 13
+; CHECK-NEXT: lsli $r19, $r3, 3
+; CHECK-NEXT: or $r13, $r19, $r13
+; CHECK-NEXT: lsli $r19, $r2, 3
+; CHECK-NEXT: sub $r16, $r16, $r19
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 11
+; CHECK-NEXT: lsli $r19, $r3, 5
+; CHECK-NEXT: or $r13, $r19, $r13
+; CHECK-NEXT: lsli $r19, $r2, 5
+; CHECK-NEXT: sub $r16, $r16, $r19
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 9
+; CHECK-NEXT: lsli $r19, $r3, 7
+; CHECK-NEXT: or $r13, $r19, $r13
+; CHECK-NEXT: lsli $r19, $r2, 7
+; CHECK-NEXT: sub $r16, $r16, $r19
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 7
+; CHECK-NEXT: lsli $r19, $r3, 9
+; CHECK-NEXT: or $r13, $r19, $r13
+; CHECK-NEXT: lsli $r19, $r2, 9
+; CHECK-NEXT: sub $r16, $r16, $r19
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 5
+; CHECK-NEXT: lsli $r19, $r3, 11
+; CHECK-NEXT: or $r13, $r19, $r13
+; CHECK-NEXT: lsli $r19, $r2, 11
+; CHECK-NEXT: sub $r16, $r16, $r19
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r2, 3
+; CHECK-NEXT: lsli $r19, $r3, 13
+; CHECK-NEXT: or $r13, $r19, $r13
+; CHECK-NEXT: lsli $r19, $r2, 13
+; CHECK-NEXT: sub $r16, $r16, $r19
+; CHECK-NEXT: subc $r10, $r10, $r13
+; CHECK-NEXT: lsri $r13, $r10, 15
+; CHECK-NEXT: add $r10, $r10, $r13
+; CHECK-NEXT: lsli $r13, $r10, 2
+; CHECK-NEXT: sub $r10, $r10, $r13
+; CHECK-NEXT: add $r2, $r2, $r10
+; CHECK-NEXT: ldw $r3, [$r1+, 0]
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: srem_const:
+; MUL:      movi $r10, 21846
+; MUL-NEXT: mulhs $r10, $r2, $r10
+; MUL-NEXT: lsri $r13, $r10, 15
+; MUL-NEXT: add $r10, $r10, $r13
+; MUL-NEXT: movi $r13, 3
+; MUL-NEXT: mul $r10, $r10, $r13
+; MUL-NEXT: sub $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = srem i16 %a, 3
+  ret i16 %1
+}
+
+define i16 @mul_optsize(i16 %a) nounwind optsize {
+; CHECK-LABEL: mul_optsize:
+; CHECK:      lsli $r10, $r2, 3
+; CHECK-NEXT: lsli $r2, $r2, 1
+; CHECK-NEXT: add $r2, $r2, $r10
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: mul_optsize:
+; MUL:      movi $r10, 10
+; MUL-NEXT: mul $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = mul i16 %a, 10
+  ret i16 %1
+}
+
+define i16 @mul_optsize_libcall(i16 %a) nounwind optsize {
+; CHECK-LABEL: mul_optsize_libcall:
+; CHECK:      stw [-$r1, 0], $r0
+; CHECK-NEXT: stw [-$r1, 0], $r3
+; CHECK-NEXT: movi $r3, 171
+; CHECK-NEXT: bal __mulhi3, $r0
+; CHECK-NEXT: ldw $r3, [$r1+, 0]
+; CHECK-NEXT: ldw $r0, [$r1+, 0]
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: mul_optsize_libcall:
+; MUL:      movi $r10, 171
+; MUL-NEXT: mul $r2, $r2, $r10
+; MUL-NEXT: jmp $r0
+  %1 = mul i16 %a, 171
+  ret i16 %1
+}
+
+define i16 @udiv_optsize(i16 %a) nounwind optsize {
+; CHECK-LABEL: udiv_optsize:
+; CHECK:      stw [-$r1, 0], $r0
+; CHECK-NEXT: stw [-$r1, 0], $r3
+; CHECK-NEXT: movi $r3, 10
+; CHECK-NEXT: bal __udivhi3, $r0
+; CHECK-NEXT: ldw $r3, [$r1+, 0]
+; CHECK-NEXT: ldw $r0, [$r1+, 0]
+; CHECK-NEXT: jmp $r0
+; MUL-LABEL: udiv_optsize:
+; MUL:      movi $r10, -13107
+; MUL-NEXT: mulhu $r2, $r2, $r10
+; MUL-NEXT: lsri $r2, $r2, 3
+; MUL-NEXT: jmp $r0
+  %1 = udiv i16 %a, 10
+  ret i16 %1
+}
@@ -0,0 +1,118 @@
+; RUN: llc -march=aap -mattr=+mul,+div < %s | FileCheck %s
+; RUN: llc -march=aap -mattr=+div < %s | FileCheck -check-prefix=DIV %s
+; RUN: llc -march=aap -mattr=+mac < %s | FileCheck -check-prefix=MAC %s
+; RUN: llc -march=aap -mcpu=aap-dsp < %s | FileCheck -check-prefix=MAC %s
+; RUN: llc -march=aap -mattr=+mul,+div -global-isel -global-isel-abort=2 < %s \
+; RUN:     | FileCheck -check-prefix=GISEL %s
+
+; Check that the hardware multiplier and divider are used when available,
+; instead of calls to the runtime library.
+
+define i16 @mul(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: mul:
+; CHECK-NOT:     bal
+; CHECK:         mul $r2, $r2, $r3
+; GISEL-LABEL: mul:
+; GISEL-NOT:     bal
+; GISEL:         mul
+  %1 = mul i16 %a, %b
+  ret i16 %1
+}
+
+define i16 @mulhu(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: mulhu:
+; CHECK-NOT:     bal
+; CHECK:         mulhu $r2, $r2, $r3
+  %1 = zext i16 %a to i32
+  %2 = zext i16 %b to i32
+  %3 = mul i32 %1, %2
+  %4 = lshr i32 %3, 16
+  %5 = trunc i32 %4 to i16
+  ret i16 %5
+}
+
+define i16 @mulhs(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: mulhs:
+; CHECK-NOT:     bal
+; CHECK:         mulhs $r2, $r2, $r3
+  %1 = sext i16 %a to i32
+  %2 = sext i16 %b to i32
+  %3 = mul i32 %1, %2
+  %4 = lshr i32 %3, 16
+  %5 = trunc i32 %4 to i16
+  ret i16 %5
+}
+
+define i32 @mul32(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: mul32:
+; CHECK-NOT:     bal
+; CHECK-DAG:     mulhu
+; CHECK-DAG:     mul
+; CHECK:         jmp
+  %1 = mul i32 %a, %b
+  ret i32 %1
+}
+
+define i16 @sdiv(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: sdiv:
+; CHECK-NOT:     bal
+; CHECK:         divs $r2, $r2, $r3
+; GISEL-LABEL: sdiv:
+; GISEL-NOT:     bal
+; GISEL:         divs
+  %1 = sdiv i16 %a, %b
+  ret i16 %1
+}
+
+define i16 @udiv(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: udiv:
+; CHECK-NOT:     bal
+; CHECK:         divu $r2, $r2, $r3
+  %1 = udiv i16 %a, %b
+  ret i16 %1
+}
+
+; Remainders are computed from the quotient
+define i16 @urem(i16 %a, i16 %b) nounwind {
+; CHECK-LABEL: urem:
+; CHECK-NOT:     bal
+; CHECK:         divu [[Q:\$r[0-9]+]], $r2, $r3
+; CHECK:         mul [[P:\$r[0-9]+]], [[Q]], $r3
+; CHECK:         sub $r2, $r2, [[P]]
+  %1 = urem i16 %a, %b
+  ret i16 %1
+}
+
+; Without a hardware multiplier, remainders by a constant use the divider and
+; multiply the quotient by the constant with shifts and adds
+define i16 @sremconst(i16 %a) nounwind {
+; DIV-LABEL: sremconst:
+; DIV-NOT:       bal
+; DIV:           movi [[C:\$r[0-9]+]], 7
+; DIV-NEXT:      divs {{\$r[0-9]+}}, $r2, [[C]]
+; DIV-NOT:       bal
+; DIV:           jmp $r0
+  %1 = srem i16 %a, 7
+  ret i16 %1
+}
+
+define i16 @uremconst(i16 %a) nounwind {
+; DIV-LABEL: uremconst:
+; DIV-NOT:       bal
+; DIV:           movi [[C:\$r[0-9]+]], 7
+; DIV-NEXT:      divu {{\$r[0-9]+}}, $r2, [[C]]
+; DIV-NOT:       bal
+; DIV:           jmp $r0
+  %1 = urem i16 %a, 7
+  ret i16 %1
+}
+
+; A multiply feeding an add is a single multiply-accumulate
+define i16 @mac(i16 %a, i16 %b, i16 %c) nounwind {
+; MAC-LABEL: mac:
+; MAC-NOT:       bal
+; MAC:           mac $r2, $r3, $r4
+  %1 = mul i16 %b, %c
+  %2 = add i16 %a, %1
+  ret i16 %2
+}
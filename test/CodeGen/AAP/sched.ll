@@ -0,0 +1,21 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+
+
+; Check that the machine scheduler uses the AAP machine model to hide the
+; latency of loads behind independent instructions.
+
+define i16 @load_use(i16* %a, i16* %b, i16 %c, i16 %d) nounwind {
+entry:
+; CHECK-LABEL: load_use:
+; CHECK:         ldw [[A:\$r[0-9]+]], [$r2, 0]
+; CHECK-NEXT:    ldw [[B:\$r[0-9]+]], [$r3, 0]
+; CHECK-NEXT:    xor [[A]], [[A]], $r4
+; CHECK-NEXT:    or [[B]], [[B]], $r5
+; CHECK-NEXT:    and $r2, [[A]], [[B]]
+  %0 = load i16, i16* %a
+  %1 = xor i16 %0, %c
+  %2 = load i16, i16* %b
+  %3 = or i16 %2, %d
+  %4 = and i16 %1, %3
+  ret i16 %4
+}
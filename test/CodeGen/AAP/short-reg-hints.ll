@@ -0,0 +1,35 @@
+; RUN: llc -asm-show-inst -march=aap < %s | FileCheck %s
+; RUN: llc -march=aap -stats < %s 2>&1 | FileCheck %s --check-prefix=STATS
+; REQUIRES: asserts
+
+
+; Check that values used in a loop by instructions with short forms are
+; allocated to R0-R7, so that the loop body uses 16-bit encodings.
+
+
+define i16 @sum(i16* %p, i16 %n) {
+entry:
+;CHECK-LABEL: sum:
+;CHECK: [[LOOP:.LBB[0-9_]+]]:
+;CHECK-DAG: ldw $r{{[0-7]}}, [$r{{[0-7]}}+, 0]    {{.*LDW_postinc_short}}
+;CHECK-DAG: add $r{{[0-7]}}, $r{{[0-7]}}, $r{{[0-7]}} {{.*ADD_r_short}}
+;CHECK: {{b[a-z]+}} [[LOOP]]
+  br label %loop
+
+loop:
+  %i = phi i16 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i16 [ 0, %entry ], [ %acc.next, %loop ]
+  %ptr = phi i16* [ %p, %entry ], [ %ptr.next, %loop ]
+  %v = load i16, i16* %ptr
+  %acc.next = add i16 %acc, %v
+  %ptr.next = getelementptr i16, i16* %ptr, i16 1
+  %i.next = add i16 %i, 1
+  %cmp = icmp ne i16 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret i16 %acc.next
+}
+
+;STATS: {{[0-9]+}} aap-short-instr-peephole - Number of instructions replaced with a short form
+;STATS: {{[0-9]+}} aap-short-reg-hints      - Number of virtual registers hinted to R0-R7
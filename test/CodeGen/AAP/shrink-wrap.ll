@@ -0,0 +1,80 @@
+; RUN: llc -march=aap < %s | FileCheck %s
+; RUN: llc -march=aap -mattr=+save-restore < %s \
+; RUN:   | FileCheck %s -check-prefix=SAVE-RESTORE
+
+; Check that the prologue and epilogue are shrink-wrapped around the path
+; which needs a frame, and that callee saved registers are pushed and popped
+; with pre-decrement and post-increment accesses to the stack pointer.
+
+declare i16 @g(i16)
+
+define i16 @early_exit(i16 %a) nounwind {
+; CHECK-LABEL: early_exit:
+; CHECK-NOT:   stw
+; CHECK:       beq .LBB0_2
+; CHECK:       stw [-$r1, 0], $r0
+; CHECK:       bal g, $r0
+; CHECK:       ldw $r0, [$r1+, 0]
+; CHECK:     .LBB0_2:
+; CHECK-NEXT:  jmp $r0
+entry:
+  %cmp = icmp eq i16 %a, 0
+  br i1 %cmp, label %exit, label %call
+
+call:
+  %r = call i16 @g(i16 %a)
+  br label %exit
+
+exit:
+  %v = phi i16 [ %r, %call ], [ 0, %entry ]
+  ret i16 %v
+}
+
+; Enough callee saved registers are needed here for a call to the shared save
+; and restore routines to be smaller than the pushes and pops. The routines are
+; only used when optimizing for size.
+
+define i16 @many_saved(i16 %a) nounwind {
+; CHECK-LABEL: many_saved:
+; CHECK:       stw [-$r1, 0], $r0
+; CHECK-NEXT:  stw [-$r1, 0], $r3
+; CHECK-NEXT:  stw [-$r1, 0], $r4
+; CHECK-NEXT:  stw [-$r1, 0], $r5
+; CHECK:       bal g, $r0
+; CHECK:       ldw $r5, [$r1+, 0]
+; CHECK-NEXT:  ldw $r4, [$r1+, 0]
+; CHECK-NEXT:  ldw $r3, [$r1+, 0]
+; CHECK-NEXT:  ldw $r0, [$r1+, 0]
+; CHECK-NEXT:  jmp $r0
+;
+; SAVE-RESTORE-LABEL: many_saved:
+; SAVE-RESTORE:       stw [-$r1, 0], $r0
+; SAVE-RESTORE:       ldw $r0, [$r1+, 0]
+entry:
+  %r1 = call i16 @g(i16 %a)
+  %r2 = call i16 @g(i16 %r1)
+  %r3 = call i16 @g(i16 %r2)
+  %r4 = call i16 @g(i16 %r3)
+  %s1 = add i16 %r1, %r2
+  %s2 = add i16 %s1, %r3
+  %s3 = add i16 %s2, %r4
+  ret i16 %s3
+}
+
+define i16 @many_saved_optsize(i16 %a) nounwind optsize {
+; SAVE-RESTORE-LABEL: many_saved_optsize:
+; SAVE-RESTORE-NOT:   stw [-$r1
+; SAVE-RESTORE:       bal __aap_save_7, $r10
+; SAVE-RESTORE:       bal g, $r0
+; SAVE-RESTORE:       bal __aap_restore_7, $r10
+; SAVE-RESTORE-NEXT:  jmp $r0
+entry:
+  %r1 = call i16 @g(i16 %a)
+  %r2 = call i16 @g(i16 %r1)
+  %r3 = call i16 @g(i16 %r2)
+  %r4 = call i16 @g(i16 %r3)
+  %s1 = add i16 %r1, %r2
+  %s2 = add i16 %s1, %r3
+  %s3 = add i16 %s2, %r4
+  ret i16 %s3
+}
@@ -0,0 +1,59 @@
+; RUN: llc -march=aap -mattr=+small-data < %s | FileCheck %s
+; RUN: llc -march=aap < %s | FileCheck %s -check-prefix=NOSDATA
+
+; Check that small globals defined in this module are placed in .sdata and
+; .sbss and accessed relative to the global pointer, $r9.
+
+@counter = global i16 0
+@state = global [2 x i16] [i16 1, i16 2]
+@big = global [8 x i16] zeroinitializer
+@weak = weak global i16 0
+@ext = external global i16
+
+; CHECK-LABEL: load_small:
+; CHECK:       ldw $r2, [$r9, counter@gprel]
+; NOSDATA-LABEL: load_small:
+; NOSDATA:     movi $[[REG:r[0-9]+]], counter
+; NOSDATA:     ldw $r2, [$[[REG]], 0]
+define i16 @load_small() nounwind {
+  %1 = load i16, i16* @counter
+  ret i16 %1
+}
+
+; CHECK-LABEL: store_element:
+; CHECK:       stw [$r9, state@gprel+2], $r2
+define void @store_element(i16 %v) nounwind {
+  store i16 %v, i16* getelementptr ([2 x i16], [2 x i16]* @state, i16 0, i16 1)
+  ret void
+}
+
+; Large globals, declarations and definitions which may be replaced at link
+; time keep absolute addresses.
+; CHECK-LABEL: load_other:
+; CHECK:       movi $[[R1:r[0-9]+]], big
+; CHECK:       movi $[[R2:r[0-9]+]], weak
+; CHECK:       movi $[[R3:r[0-9]+]], ext
+define i16 @load_other() nounwind {
+  %1 = load i16, i16* getelementptr ([8 x i16], [8 x i16]* @big, i16 0, i16 0)
+  %2 = load i16, i16* @weak
+  %3 = load i16, i16* @ext
+  %4 = add i16 %1, %2
+  %5 = add i16 %4, %3
+  ret i16 %5
+}
+
+; The address of a small global is still available as an absolute value.
+; CHECK-LABEL: address_small:
+; CHECK:       movi $r2, counter
+define i16* @address_small() nounwind {
+  ret i16* @counter
+}
+
+; CHECK:       .section .sbss
+; CHECK:     counter:
+; CHECK:       .section .sdata
+; CHECK:     state:
+; CHECK:       .bss
+; CHECK:     big:
+; NOSDATA-NOT: .sdata
+; NOSDATA-NOT: .sbss
@@ -0,0 +1,111 @@
+; RUN: llc -asm-show-inst -march=aap < %s | FileCheck %s
+
+
+; Check that calls in tail position are lowered to a branch or jump to the
+; callee when the arguments are passed in registers which are not restored by
+; the epilogue.
+
+
+declare i16 @callee1(i16)
+declare i16 @callee2(i16, i16)
+declare i16 @callee7(i16, i16, i16, i16, i16, i16, i16)
+declare i16 @noargs()
+declare extern_weak i16 @weak(i16)
+
+; The first argument is passed in the register the caller returns its value in
+define i16 @sibcall(i16 %a) {
+entry:
+;CHECK-LABEL: sibcall:
+;CHECK-NOT: bal
+;CHECK: bra callee1                      {{.*BRA}}
+;CHECK-NOT: jmp
+  %0 = add i16 %a, 1
+  %1 = tail call i16 @callee1(i16 %0)
+  ret i16 %1
+}
+
+; An incoming argument may be passed on unmodified in its callee saved register
+define i16 @sibcall_passthrough(i16 %a, i16 %b) {
+entry:
+;CHECK-LABEL: sibcall_passthrough:
+;CHECK-NOT: bal
+;CHECK: bra callee2                      {{.*BRA}}
+  %0 = add i16 %a, 3
+  %1 = tail call i16 @callee2(i16 %0, i16 %b)
+  ret i16 %1
+}
+
+; A modified value in a callee saved argument register would be clobbered by
+; the epilogue
+define i16 @no_sibcall_csr(i16 %a, i16 %b) {
+entry:
+;CHECK-LABEL: no_sibcall_csr:
+;CHECK: bal callee2, $r0                 {{.*BAL}}
+;CHECK: jmp $r0                          {{.*JMP}}
+  %0 = add i16 %b, 1
+  %1 = tail call i16 @callee2(i16 %a, i16 %0)
+  ret i16 %1
+}
+
+; Arguments passed on the stack would overwrite the caller's incoming arguments
+define i16 @no_sibcall_stack(i16 %a, i16 %b, i16 %c, i16 %d, i16 %e, i16 %f,
+                             i16 %g) {
+entry:
+;CHECK-LABEL: no_sibcall_stack:
+;CHECK: bal callee7, $r0                 {{.*BAL}}
+  %0 = tail call i16 @callee7(i16 %a, i16 %b, i16 %c, i16 %d, i16 %e, i16 %f,
+                              i16 %g)
+  ret i16 %0
+}
+
+; The callee's result would clobber a register the caller must preserve
+define void @no_sibcall_result() {
+entry:
+;CHECK-LABEL: no_sibcall_result:
+;CHECK: bal noargs, $r0                  {{.*BAL}}
+  %0 = tail call i16 @noargs()
+  ret void
+}
+
+define i16 @no_sibcall_weak(i16 %a) {
+entry:
+;CHECK-LABEL: no_sibcall_weak:
+;CHECK: bal weak, $r0                    {{.*BAL}}
+  %0 = tail call i16 @weak(i16 %a)
+  ret i16 %0
+}
+
+; Indirect tail calls jump through a register which is not callee saved
+define void @indirect(void ()* %f) {
+entry:
+;CHECK-LABEL: indirect:
+;CHECK-NOT: jal
+;CHECK: jmp ${{r(10|13|16|19|22|25|28|31|33|35|37|39)}} {{.*JMP}}
+  tail call void %f()
+  ret void
+}
+
+; A coldcc caller saves the registers an indirect tail call target is held in,
+; so the epilogue would restore over the target
+define coldcc void @no_sibcall_indirect_cold(void ()* %f) {
+entry:
+;CHECK-LABEL: no_sibcall_indirect_cold:
+;CHECK: jal ${{r[0-9]+}}, $r0            {{.*JAL}}
+;CHECK: jmp $r0                          {{.*JMP}}
+  tail call coldcc void %f()
+  ret void
+}
+
+; Frame teardown happens before the tail call
+define i16 @sibcall_frame(i16 %a) {
+entry:
+;CHECK-LABEL: sibcall_frame:
+;CHECK: subi $r1, $r1, [[SIZE:[0-9]+]]
+;CHECK: addi $r1, $r1, [[SIZE]]
+;CHECK: bra callee1                      {{.*BRA}}
+  %p = alloca i16
+  store volatile i16 %a, i16* %p
+  %0 = load volatile i16, i16* %p
+  %1 = tail call i16 @callee1(i16 %0)
+  ret i16 %1
+}
@@ -0,0 +1,78 @@
+; RUN: llvm-mc -triple=aap -show-encoding -show-inst %s | FileCheck %s
+
+; Check that instructions are assembled to their short forms when every
+; operand fits in the short encoding, and to the long forms otherwise. These
+; are the same forms the AsmPrinter compresses to, see CompressPat.
+
+; CHECK: mov $r7, $r6 ; encoding: [0xf0,0x13]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} MOV_r_short{{$}}
+; CHECK: mov $r8, $r6 ; encoding: [0x30,0x92,0x40,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} MOV_r{{$}}
+mov $r7, $r6
+mov $r8, $r6
+
+; CHECK: movi $r1, 63 ; encoding: [0x7f,0x1e]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} MOVI_i6_short{{$}}
+; CHECK: movi $r1, 64 ; encoding: [0x40,0x9e,0x01,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} MOVI_i16{{$}}
+movi $r1, 63
+movi $r1, 64
+
+; CHECK: nop $r1, 63 ; encoding: [0x7f,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} NOP_short{{$}}
+; CHECK: nop $r1, 64 ; encoding: [0x40,0x80,0x01,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} NOP{{$}}
+nop $r1, 63
+nop $r1, 64
+
+; CHECK: add $r1, $r2, $r7 ; encoding: [0x57,0x02]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} ADD_r_short{{$}}
+; CHECK: add $r1, $r2, $r8 ; encoding: [0x50,0x82,0x01,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} ADD_r{{$}}
+add $r1, $r2, $r7
+add $r1, $r2, $r8
+
+; CHECK: addi $r1, $r2, 7 ; encoding: [0x57,0x14]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} ADDI_i3_short{{$}}
+; CHECK: addi $r1, $r2, 8 ; encoding: [0x50,0x94,0x01,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} ADDI_i10{{$}}
+addi $r1, $r2, 7
+addi $r1, $r2, 8
+
+; CHECK: subi $r1, $r2, 7 ; encoding: [0x57,0x16]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} SUBI_i3_short{{$}}
+; CHECK: subi $r9, $r2, 7 ; encoding: [0x57,0x96,0x40,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} SUBI_i10{{$}}
+subi $r1, $r2, 7
+subi $r9, $r2, 7
+
+; CHECK: lsli $r1, $r2, 8 ; encoding: [0x57,0x1a]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} LSLI_i3_short{{$}}
+; CHECK: lsli $r1, $r2, 9 ; encoding: [0x50,0x9a,0x01,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} LSLI_i6{{$}}
+lsli $r1, $r2, 8
+lsli $r1, $r2, 9
+
+; CHECK: ldw $r1, [$r2, -4] ; encoding: [0x54,0x28]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} LDW_short{{$}}
+; CHECK: ldw $r1, [$r2, 4] ; encoding: [0x54,0xa8,0x00,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} LDW{{$}}
+; CHECK: ldw $r1, [$r9, 0] ; encoding: [0x48,0xa8,0x08,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} LDW{{$}}
+ldw $r1, [$r2, -4]
+ldw $r1, [$r2, 4]
+ldw $r1, [$r9, 0]
+
+; CHECK: stw [-$r2, 3], $r1 ; encoding: [0x8b,0x3c]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} STW_predec_short{{$}}
+; CHECK: stw [-$r2, 4], $r1 ; encoding: [0x8c,0xbc,0x00,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} STW_predec{{$}}
+stw [-$r2, 3], $r1
+stw [-$r2, 4], $r1
+
+; CHECK: jmp $r7 ; encoding: [0xc0,0x51]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} JMP_short{{$}}
+; CHECK: jmp $r8 ; encoding: [0x00,0xd0,0x40,0x00]
+; CHECK-NEXT: <MCInst #{{[0-9]+}} JMP{{$}}
+jmp $r7
+jmp $r8
@@ -0,0 +1,20 @@
+; RUN: llvm-mc -filetype=obj -triple=aap < %s | llvm-readobj -r \
+; RUN:     | FileCheck %s
+
+; Checks that data fixups against code labels, such as jump table entries,
+; are emitted as relocations
+
+  .text
+target0:
+  nop $r0, 1
+target1:
+  nop $r0, 1
+
+  .section .rodata
+; CHECK: Section ({{[0-9]+}}) .rela.rodata {
+; CHECK-NEXT: 0x0 R_AAP_16 .text 0x0
+; CHECK-NEXT: 0x2 R_AAP_16 .text 0x2
+; CHECK-NEXT: 0x4 R_AAP_32 .text 0x2
+  .short target0
+  .short target1
+  .long target1
@@ -0,0 +1,30 @@
+; RUN: llvm-mc -triple=aap < %s -show-encoding \
+; RUN:     | FileCheck -check-prefix=CHECK-FIXUP %s
+; RUN: llvm-mc -filetype=obj -triple=aap < %s \
+; RUN:     | llvm-readobj -r | FileCheck -check-prefix=CHECK-RELOC %s
+
+; Checks that offsets from the global pointer are always left to the linker,
+; even for symbols defined in the same object
+
+; CHECK-FIXUP: ldw $r2, [$r9, x@gprel]
+; CHECK-FIXUP: fixup A - offset: 0, value: x@gprel, kind: fixup_AAP_GPREL10
+ldw $r2, [$r9, x@gprel]
+; CHECK-FIXUP: stw [$r9, y@gprel+2], $r3
+; CHECK-FIXUP: fixup A - offset: 0, value: y@gprel+2, kind: fixup_AAP_GPREL10
+stw [$r9, y@gprel+2], $r3
+; CHECK-FIXUP: ldb $r4, [$r9, x@gprel+1]
+; CHECK-FIXUP: fixup A - offset: 0, value: x@gprel+1, kind: fixup_AAP_GPREL10
+ldb $r4, [$r9, x@gprel+1]
+
+; CHECK-RELOC:      Section ({{[0-9]+}}) .rela.text {
+; CHECK-RELOC-NEXT:   0x0 R_AAP_GPREL10 .sdata 0x0
+; CHECK-RELOC-NEXT:   0x4 R_AAP_GPREL10 y 0x2
+; CHECK-RELOC-NEXT:   0x8 R_AAP_GPREL10 .sdata 0x1
+; CHECK-RELOC-NEXT: }
+
+  .section .sdata
+x:
+  .short 1
+  .globl y
+y:
+  .long 2
@@ -0,0 +1,23 @@
+; RUN: llvm-mc -triple=aap -mattr=+mul,+div,+mac -show-encoding %s \
+; RUN:     | FileCheck %s
+; RUN: not llvm-mc -triple=aap %s 2>&1 | FileCheck -check-prefix=NOHW %s
+; RUN: not llvm-mc -triple=aap -mattr=+mul %s 2>&1 \
+; RUN:     | FileCheck -check-prefix=MULONLY %s
+
+; Multiply, divide and multiply-accumulate are only available with the
+; matching subtarget features, and have no short forms.
+
+; NOHW:    error: Use of this instruction requires: mul
+mul   $r2,  $r3,  $r4   ;CHECK: mul   $r2, $r3,  $r4  ; encoding: [0x9c,0x8c,0x00,0x02]
+mul   $r9,  $r17, $r63  ;CHECK: mul   $r9, $r17, $r63 ; encoding: [0x4f,0x8c,0x57,0x02]
+mulhs $r2,  $r3,  $r4   ;CHECK: mulhs $r2, $r3,  $r4  ; encoding: [0x9c,0x8e,0x00,0x02]
+mulhu $r9,  $r17, $r63  ;CHECK: mulhu $r9, $r17, $r63 ; encoding: [0x4f,0x90,0x57,0x02]
+
+; NOHW:    error: Use of this instruction requires: div
+; MULONLY: error: Use of this instruction requires: div
+divs  $r2,  $r3,  $r4   ;CHECK: divs  $r2, $r3,  $r4  ; encoding: [0x9c,0x92,0x00,0x02]
+divu  $r9,  $r17, $r63  ;CHECK: divu  $r9, $r17, $r63 ; encoding: [0x4f,0x98,0x57,0x02]
+
+; NOHW:    error: Use of this instruction requires: mac
+; MULONLY: error: Use of this instruction requires: mac
+mac   $r2,  $r3,  $r4   ;CHECK: mac   $r2, $r3,  $r4  ; encoding: [0x9c,0x9a,0x00,0x02]
@@ -0,0 +1,25 @@
+; RUN: llvm-mc -filetype=obj -triple=aap < %s -o %t.incremental
+; RUN: llvm-mc -filetype=obj -triple=aap -mc-incremental-relaxation=false \
+; RUN:     < %s -o %t.full
+; RUN: cmp %t.incremental %t.full
+; RUN: llvm-objdump -s -j .data %t.incremental | FileCheck %s
+
+; Checks that incremental relaxation reaches the same layout as relaxing every
+; fragment on each pass, when a fragment only needs relaxing once a fragment
+; after it has grown. The first LEB only needs two bytes once the last one
+; does.
+
+  .data
+start:
+  .uleb128 end - start
+  .fill 60, 1, 0
+  .uleb128 end - mid
+mid:
+  .fill 64, 1, 0
+  .uleb128 last - end
+end:
+  .fill 128, 1, 0
+last:
+
+; CHECK:      Contents of section .data:
+; CHECK-NEXT: 0000 81010000
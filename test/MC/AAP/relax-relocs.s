@@ -0,0 +1,37 @@
+; RUN: llvm-mc -filetype=obj -triple=aap -mattr=+relax < %s \
+; RUN:     | llvm-readobj -r | FileCheck -check-prefix=RELAX %s
+; RUN: llvm-mc -filetype=obj -triple=aap < %s \
+; RUN:     | llvm-readobj -r | FileCheck -check-prefix=NORELAX %s
+
+; Checks that with linker relaxation enabled branches are followed by a
+; R_AAP_RELAX marker and differences between code labels are kept symbolic
+
+  .text
+start:
+  bra target
+  beq target, $r2, $r3
+  bal func, $r0
+target:
+  nop $r0, 1
+
+; RELAX:      Section ({{[0-9]+}}) .rela.text {
+; RELAX-NEXT:   0x0 R_AAP_BR32 {{[^ ]+}} 0x{{[0-9A-F]+}}
+; RELAX-NEXT:   0x0 R_AAP_RELAX {{[^ ]+}} 0x{{[0-9A-F]+}}
+; RELAX-NEXT:   0x4 R_AAP_BRCC32 {{[^ ]+}} 0x{{[0-9A-F]+}}
+; RELAX-NEXT:   0x4 R_AAP_RELAX {{[^ ]+}} 0x{{[0-9A-F]+}}
+; RELAX-NEXT:   0x8 R_AAP_BAL32 func 0x0
+; RELAX-NEXT:   0x8 R_AAP_RELAX func 0x0
+; RELAX-NEXT: }
+
+; NORELAX:      Section ({{[0-9]+}}) .rela.text {
+; NORELAX-NOT:    R_AAP_RELAX
+; NORELAX:      }
+
+  .section .rodata
+; RELAX:      Section ({{[0-9]+}}) .rela.rodata {
+; RELAX-NEXT:   0x0 R_AAP_ADD16 target 0x0
+; RELAX-NEXT:   0x0 R_AAP_SUB16 start 0x0
+; RELAX-NEXT: }
+
+; NORELAX-NOT: .rela.rodata
+  .short target - start
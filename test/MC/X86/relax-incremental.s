@@ -0,0 +1,76 @@
+# RUN: llvm-mc -filetype=obj -triple=x86_64-pc-linux-gnu %s -o %t.incremental
+# RUN: llvm-mc -filetype=obj -triple=x86_64-pc-linux-gnu \
+# RUN:     -mc-incremental-relaxation=false %s -o %t.full
+# RUN: cmp %t.incremental %t.full
+# RUN: llvm-objdump -d %t.incremental | FileCheck %s
+
+# Check that incremental relaxation follows chains of branches, each of which
+# only goes out of short range once a branch between it and its target has
+# been relaxed, and reaches the same layout as relaxing every fragment on
+# each pass.
+
+# RUN: llvm-mc -filetype=obj -triple=x86_64-pc-linux-gnu -stats %s \
+# RUN:     -o /dev/null 2>&1 | FileCheck -check-prefix=STATS %s
+# REQUIRES: asserts
+
+# The incremental pass relaxes all six branches, so that the pass over every
+# fragment which follows it finds nothing left to relax. After the first
+# round only the branches spanning a relaxed one are examined again, not
+# every instruction in the section.
+# STATS: 17 assembler - Number of fragments examined for relaxation incrementally
+# STATS: 1 assembler - Number of assembler layout and relaxation steps
+# STATS: 6 assembler - Number of relaxed instructions
+
+  .text
+# Forward: f3 is always out of range. f2 only is once f3 has grown, and f1
+# only once both have.
+# CHECK-LABEL: {{^}}f1:
+# CHECK-NEXT:  e9 {{.*}} jmp
+f1:
+  jmp .Lf1_target
+  .fill 40, 1, 0x90
+# CHECK-LABEL: {{^}}f2:
+# CHECK-NEXT:  0f 85 {{.*}} jne
+f2:
+  jne .Lf2_target
+  .fill 40, 1, 0x90
+# CHECK-LABEL: {{^}}f3:
+# CHECK-NEXT:  e9 {{.*}} jmp
+f3:
+  jmp .Lf3_target
+  .fill 37, 1, 0x90
+.Lf1_target:
+  .fill 47, 1, 0x90
+.Lf2_target:
+  .fill 200, 1, 0x90
+.Lf3_target:
+  nop
+
+# Backward, mirroring the above: b3 is always out of range. b2 only is once
+# b3 has grown, and b1 only once both have.
+.Lb3_target:
+  .fill 200, 1, 0x90
+.Lb2_target:
+  .fill 47, 1, 0x90
+.Lb1_target:
+  .fill 37, 1, 0x90
+# CHECK-LABEL: {{^}}b3:
+# CHECK-NEXT:  e9 {{.*}} jmp
+b3:
+  jmp .Lb3_target
+  .fill 38, 1, 0x90
+# CHECK-LABEL: {{^}}b2:
+# CHECK-NEXT:  0f 84 {{.*}} je
+b2:
+  je .Lb2_target
+  .fill 42, 1, 0x90
+# CHECK-LABEL: {{^}}b1:
+# CHECK-NEXT:  e9 {{.*}} jmp
+b1:
+  jmp .Lb1_target
+
+# A branch which stays in range is not relaxed.
+# CHECK-LABEL: {{^}}short:
+# CHECK-NEXT:  eb {{.*}} jmp
+short:
+  jmp b1
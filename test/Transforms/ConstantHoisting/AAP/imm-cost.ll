@@ -0,0 +1,40 @@
+; RUN: opt -mtriple=aap -consthoist -S < %s | FileCheck %s
+
+target datalayout = "e-m:e-p:16:16-i32:16-i64:16-f32:16-f64:16-n16"
+
+; A 16-bit immediate is a single MOVI wherever it is used, so it is never
+; worth hoisting.
+define i16 @no_hoist_i16(i16 %a, i16 %b) {
+; CHECK-LABEL: @no_hoist_i16
+; CHECK-NOT: bitcast
+; CHECK: and i16 %a, 4660
+; CHECK: and i16 %b, 4660
+  %1 = and i16 %a, 4660
+  %2 = and i16 %b, 4660
+  %3 = add i16 %1, %2
+  ret i16 %3
+}
+
+; Immediates which fold into ADDI and ANDI stay in place
+define i16 @foldable(i16 %a, i16 %b) {
+; CHECK-LABEL: @foldable
+; CHECK-NOT: bitcast
+; CHECK: add i16 %a, 1000
+; CHECK: and i16 %b, 500
+  %1 = add i16 %a, 1000
+  %2 = and i16 %b, 500
+  %3 = add i16 %1, %2
+  ret i16 %3
+}
+
+; A 32-bit immediate needs a MOVI for each half, so is hoisted
+define i32 @hoist_i32(i32 %a, i32 %b) {
+; CHECK-LABEL: @hoist_i32
+; CHECK: %const = bitcast i32 305419896 to i32
+; CHECK: and i32 %a, %const
+; CHECK: and i32 %b, %const
+  %1 = and i32 %a, 305419896
+  %2 = and i32 %b, 305419896
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
@@ -0,0 +1,26 @@
+# RUN: llvm-mca -mtriple=aap -mcpu=generic -instruction-tables < %s | FileCheck %s
+
+# llvm-mca only simulates out-of-order models, so check the latencies and
+# resources that the in-order AAP model gives each instruction.
+
+ldw   $r2, [$r3, 0]
+add   $r4, $r2, $r5
+stw   [$r3, 2], $r4
+addi  $r3, $r3, 4
+jmp   $r0
+
+# CHECK:      [1]    [2]    [3]    [4]    [5]    [6]    Instructions:
+# CHECK-NEXT:  1      2     1.00    *                   ldw $r2, [$r3, 0]
+# CHECK-NEXT:  1      1     1.00                        add $r4, $r2, $r5
+# CHECK-NEXT:  1      1     1.00           *            stw [$r3, 2], $r4
+# CHECK-NEXT:  1      1     1.00                        addi $r3, $r3, 4
+# CHECK-NEXT:  1      1     2.00                        jmp $r0
+
+# CHECK:      Resources:
+# CHECK-NEXT: [0]   - AAPUnitALU
+# CHECK-NEXT: [1]   - AAPUnitBranch
+# CHECK-NEXT: [2]   - AAPUnitLdSt
+
+# CHECK:      Resource pressure per iteration:
+# CHECK-NEXT: [0]    [1]    [2]
+# CHECK-NEXT: 2.00   2.00   2.00
@@ -0,0 +1,107 @@
+; RUN: llvm-mc -filetype=obj -triple=aap -mattr=+relax %s -o %t.o
+; RUN: llvm-objcopy --relax-branches %t.o %t2.o
+; RUN: llvm-objdump -d -r -t %t2.o | FileCheck %s
+
+; Checks that branches and calls in the output of the assembler are shrunk
+; when their target is in range, and that functions keep their alignment:
+; the padding after f is kept because f shrinks by 4 bytes, 2 bytes of
+; padding are added after h because it shrinks by 2, and the padding after m
+; is removed because it shrinks by 2.
+
+  .text
+  .p2align 2
+  .globl f
+  .type f,@function
+f:
+  bal h, $r0
+  bra .Lf_exit
+  beq .Lf_exit, $r2, $r3
+  bal ext, $r0
+.Lf_exit:
+  jmp $r0
+.Lf_end:
+  .size f, .Lf_end-f
+
+  .p2align 2
+  .globl h
+  .type h,@function
+h:
+  bra .Lh_exit
+  nop $r0, 1
+.Lh_exit:
+  jmp $r0
+.Lh_end:
+  .size h, .Lh_end-h
+
+  .p2align 2
+  .globl k
+  .type k,@function
+k:
+  bal f, $r0
+  jmp $r0
+.Lk_end:
+  .size k, .Lk_end-k
+
+  .p2align 2
+  .globl m
+  .type m,@function
+m:
+  bal k, $r0
+  jmp $r0
+.Lm_end:
+  .size m, .Lm_end-m
+
+  .p2align 2
+  .globl n
+  .type n,@function
+n:
+  jmp $r0
+.Ln_end:
+  .size n, .Ln_end-n
+
+; The short forms are not known to the disassembler.
+; CHECK-LABEL: f:
+; CHECK-NEXT:    0: 00 42 <unknown>
+; CHECK-NEXT:         00000000: R_AAP_BAL16 h
+; CHECK-NEXT:    2: 00 40 <unknown>
+; CHECK-NEXT:         00000002: R_AAP_BR16 .Lf_exit
+; The target of the conditional branch is out of reach of the short form, and
+; the target of the last call is not in this object.
+; CHECK-NEXT:    4: 13 c4 00 00 beq 0, $r2, $r3
+; CHECK-NEXT:         00000004: R_AAP_BRCC32 .Lf_exit
+; CHECK-NEXT:         00000004: R_AAP_RELAX .Lf_exit
+; CHECK-NEXT:    8: 00 c2 00 00 bal 0, $r0
+; CHECK-NEXT:         00000008: R_AAP_BAL32 ext
+; CHECK-NEXT:         00000008: R_AAP_RELAX ext
+; CHECK-LABEL: .Lf_exit:
+; CHECK-NEXT:    c: 00 50 jmp $r0
+; CHECK-NEXT:    e: 00 01 nop $r4, 0
+
+; CHECK-LABEL: h:
+; CHECK-NEXT:   10: 00 40 <unknown>
+; CHECK-NEXT:         00000010: R_AAP_BR16 .Lh_exit
+; CHECK-NEXT:   12: 01 00 nop $r0, 1
+; CHECK-LABEL: .Lh_exit:
+; CHECK-NEXT:   14: 00 50 jmp $r0
+; CHECK-NEXT:   16: 00 01 nop $r4, 0
+
+; CHECK-LABEL: k:
+; CHECK-NEXT:   18: 00 42 <unknown>
+; CHECK-NEXT:         00000018: R_AAP_BAL16 f
+; CHECK-NEXT:   1a: 00 50 jmp $r0
+
+; CHECK-LABEL: m:
+; CHECK-NEXT:   1c: 00 42 <unknown>
+; CHECK-NEXT:         0000001c: R_AAP_BAL16 k
+; CHECK-NEXT:   1e: 00 50 jmp $r0
+; CHECK-LABEL: n:
+; CHECK-NEXT:   20: 00 50 jmp $r0
+
+; CHECK-LABEL: SYMBOL TABLE:
+; CHECK-DAG: 0000000c .text 00000000 .Lf_exit
+; CHECK-DAG: 00000014 .text 00000000 .Lh_exit
+; CHECK-DAG: 00000000 g F .text 0000000e f
+; CHECK-DAG: 00000010 g F .text 00000006 h
+; CHECK-DAG: 00000018 g F .text 00000004 k
+; CHECK-DAG: 0000001c g F .text 00000004 m
+; CHECK-DAG: 00000020 g F .text 00000002 n
@@ -0,0 +1,34 @@
+; RUN: llvm-mc -filetype=obj -triple=aap %s -o %t.o
+; RUN: llvm-objdump -d -r %t.o > %t.seq
+; RUN: llvm-objdump -d -r -threads=4 %t.o > %t.par
+; RUN: cmp %t.seq %t.par
+; RUN: FileCheck %s < %t.par
+
+; Check that disassembling symbols in parallel gives the same output as
+; disassembling them in order, with the inline relocations in place.
+
+; CHECK:      Disassembly of section .text:
+; CHECK:      f1:
+; CHECK-NEXT: movi $r2, 0
+; CHECK-NEXT: R_AAP_ABS16 g
+; CHECK:      f2:
+; CHECK:      f3:
+; CHECK-NEXT: movi $r2, 0
+; CHECK-NEXT: R_AAP_ABS16 g+1
+; CHECK:      f4:
+; CHECK-NOT:  {{^f[0-9]}}:
+
+  .text
+f1:
+  movi $r2, g
+  addi $r2, $r2, 1
+  nop $r0, 0
+f2:
+  jmp $r0
+  nop $r0, 0
+f3:
+  movi $r2, g+1
+  nop $r0, 0
+f4:
+  addi $r2, $r2, 2
+  jmp $r0
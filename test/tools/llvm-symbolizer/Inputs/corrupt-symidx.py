@@ -0,0 +1,37 @@
+# Corrupts the symbolizer index given as the second argument in place.
+#
+#   lines   changes the line of every frame, leaving the checksum stale.
+#   frames  points every range at a frame which does not exist, and updates
+#           the checksum to match.
+
+import struct
+import sys
+import zlib
+
+HEADER_SIZE = 48
+CHECKSUM_OFFSET = 40
+RANGE_SIZE = 24
+FRAME_SIZE = 24
+
+mode, path = sys.argv[1], sys.argv[2]
+with open(path, 'rb') as f:
+  data = bytearray(f.read())
+
+build_id_size, num_ranges, num_frames = struct.unpack_from('<III', data, 20)
+ranges = HEADER_SIZE + (build_id_size + 7) // 8 * 8
+frames = ranges + num_ranges * RANGE_SIZE
+
+if mode == 'lines':
+  for i in range(num_frames):
+    data[frames + i * FRAME_SIZE + 8] ^= 1
+elif mode == 'frames':
+  for i in range(num_ranges):
+    struct.pack_into('<I', data, ranges + i * RANGE_SIZE + 8, num_frames)
+  # The checksum is a CRC-32 without the final inversion.
+  checksum = ~zlib.crc32(bytes(data[HEADER_SIZE:])) & 0xffffffff
+  struct.pack_into('<I', data, CHECKSUM_OFFSET, checksum)
+else:
+  sys.exit('unknown mode ' + mode)
+
+with open(path, 'wb') as f:
+  f.write(data)
@@ -192,15 +192,47 @@ static void printDatum(raw_ostream &OS, const char *Key, uint64_t Value) {
 /// over time to identify trends in newer compiler versions and gauge the effect
 /// of particular optimizations. The raw numbers themselves are not particularly
 /// useful, only the delta between compiling the same program with different
-/// compilers is.
+/// compilers is. The units are spread over \p Threads threads, which gives
+/// the same numbers.
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS) {
+                               Twine Filename, raw_ostream &OS,
+                               unsigned Threads) {
   StringRef FormatName = Obj.getFileFormatName();
   GlobalStats GlobalStats;
   StringMap<PerFunctionStats> Statistics;
-  for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
-    if (DWARFDie CUDie = CU->getUnitDIE(false))
-      collectStatsRecursive(CUDie, "/", 0, 0, Statistics, GlobalStats);
+  if (Threads <= 1) {
+    for (const auto &CU : static_cast<DWARFContext *>(&DICtx)->compile_units())
+      if (DWARFDie CUDie = CU->getUnitDIE(false))
+        collectStatsRecursive(CUDie, "/", 0, 0, Statistics, GlobalStats);
+  } else {
+    // Collect the statistics of each run of units separately, then merge
+    // them. The location lists are parsed up front, as they are shared.
+    DICtx.getDebugLoc();
+    std::vector<StringMap<PerFunctionStats>> RunStatistics(Threads);
+    std::vector<struct GlobalStats> RunGlobalStats(Threads);
+    const DWARFSection &InfoSection = DICtx.getDWARFObj().getInfoSection();
+    DICtx.forEachNormalUnitInParallel(Threads, [&](unsigned Run, DWARFUnit &U) {
+      if (&U.getInfoSection() == &InfoSection)
+        if (DWARFDie CUDie = U.getUnitDIE(false))
+          collectStatsRecursive(CUDie, "/", 0, 0, RunStatistics[Run],
+                                RunGlobalStats[Run]);
+    });
+    for (unsigned Run = 0; Run != Threads; ++Run) {
+      for (auto &Entry : RunStatistics[Run]) {
+        PerFunctionStats &From = Entry.getValue();
+        PerFunctionStats &To = Statistics[Entry.getKey()];
+        To.NumFnInlined += From.NumFnInlined;
+        To.TotalVarWithLoc += From.TotalVarWithLoc;
+        To.ConstantMembers += From.ConstantMembers;
+        To.VarsInFunction.insert(From.VarsInFunction.begin(),
+                                 From.VarsInFunction.end());
+        To.IsFunction |= From.IsFunction;
+      }
+      GlobalStats.ScopeBytesCovered += RunGlobalStats[Run].ScopeBytesCovered;
+      GlobalStats.ScopeBytesFromFirstDefinition +=
+          RunGlobalStats[Run].ScopeBytesFromFirstDefinition;
+    }
+  }
 
   /// The version number should be increased every time the algorithm is changed
   /// (including bug fixes). New metrics may be added without increasing the
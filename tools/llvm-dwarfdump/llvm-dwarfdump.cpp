@@ -211,6 +211,11 @@ static opt<bool> Verify("verify", desc("Verify the DWARF debug info."),
                         cat(DwarfDumpCategory));
 static opt<bool> Quiet("quiet", desc("Use with -verify to not emit to STDOUT."),
                        cat(DwarfDumpCategory));
+static opt<unsigned>
+    Threads("threads",
+            desc("Use up to N threads to read the units for -statistics "
+                 "and to check them for -verify."),
+            cat(DwarfDumpCategory), init(1), value_desc("N"));
 static opt<bool> DumpUUID("uuid", desc("Show the UUID for each architecture."),
                           cat(DwarfDumpCategory));
 static alias DumpUUIDAlias("u", desc("Alias for -uuid."), aliasopt(DumpUUID));
@@ -389,7 +394,13 @@ static bool lookup(DWARFContext &DICtx, uint64_t Address, raw_ostream &OS) {
 }
 
 bool collectStatsForObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
-                               Twine Filename, raw_ostream &OS);
+                               Twine Filename, raw_ostream &OS,
+                               unsigned Threads);
+
+static bool collectStats(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
+                         raw_ostream &OS) {
+  return collectStatsForObjectFile(Obj, DICtx, Filename, OS, Threads);
+}
 
 static bool dumpObjectFile(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
                            raw_ostream &OS) {
@@ -432,7 +443,12 @@ static bool verifyObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
   raw_ostream &stream = Quiet ? nulls() : OS;
   stream << "Verifying " << Filename.str() << ":\tfile format "
   << Obj.getFileFormatName() << "\n";
-  bool Result = DICtx.verify(stream, getDumpOpts());
+  // The verifier reads each unit again to check its contents, but the
+  // references and accelerator tables it checks next are looked up in the
+  // units of the context.
+  if (Threads > 1)
+    DICtx.extractNormalUnitDIEs(Threads);
+  bool Result = DICtx.verify(stream, getDumpOpts(), Threads);
   if (Result)
     stream << "No errors.\n";
   else
@@ -617,7 +633,7 @@ int main(int argc, char **argv) {
       exit(1);
   } else if (Statistics)
     for (auto Object : Objects)
-      handleFile(Object, collectStatsForObjectFile, OS);
+      handleFile(Object, collectStats, OS);
   else
     for (auto Object : Objects)
       handleFile(Object, dumpObjectFile, OS);
@@ -129,6 +129,12 @@ void SectionWriter::visit(const Section &Sec) {
 
 void Section::accept(SectionVisitor &Visitor) const { Visitor.visit(*this); }
 
+void Section::setContents(std::vector<uint8_t> &&Data) {
+  OwnedContents = std::move(Data);
+  Contents = OwnedContents;
+  Size = OwnedContents.size();
+}
+
 void SectionWriter::visit(const OwnedDataSection &Sec) {
   uint8_t *Buf = Out.getBufferStart() + Sec.Offset;
   std::copy(std::begin(Sec.Data), std::end(Sec.Data), Buf);
@@ -435,6 +441,14 @@ void RelocationSection::removeSymbols(
             "' because it is named in a relocation");
 }
 
+void RelocationSection::removeRelocations(
+    function_ref<bool(const Relocation &)> ToRemove) {
+  Relocations.erase(
+      std::remove_if(std::begin(Relocations), std::end(Relocations), ToRemove),
+      std::end(Relocations));
+  Size = Relocations.size() * EntrySize;
+}
+
 void RelocationSection::markSymbols() {
   for (const Relocation &Reloc : Relocations)
     Reloc.RelocSymbol->Referenced = true;
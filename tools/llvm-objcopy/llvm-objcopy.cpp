@@ -31,9 +31,11 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Memory.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
@@ -167,6 +169,7 @@ struct CopyConfig {
   bool LocalizeHidden = false;
   bool OnlyKeepDebug = false;
   bool PreserveDates = false;
+  bool RelaxBranches = false;
   bool StripAll = false;
   bool StripAllGNU = false;
   bool StripDWO = false;
@@ -405,6 +408,208 @@ static Error dumpSectionToFile(StringRef SecName, StringRef Filename,
                                  object_error::parse_failed);
 }
 
+// Insert Delta bytes of nops at Offset in Sec, or remove -Delta bytes from
+// there, and update the symbols and relocations which refer to the rest of
+// the section.
+static void resizeAAPSection(Object &Obj, Section &Sec, uint64_t Offset,
+                             int64_t Delta) {
+  std::vector<uint8_t> Data(Sec.getContents().begin(),
+                            Sec.getContents().end());
+  if (Delta < 0) {
+    Data.erase(Data.begin() + Offset, Data.begin() + Offset - Delta);
+  } else {
+    // 0x0100 is the nop which the assembler pads code with.
+    std::vector<uint8_t> Nops;
+    for (int64_t I = 0; I < Delta; I += 2) {
+      Nops.push_back(0x00);
+      Nops.push_back(0x01);
+    }
+    Data.insert(Data.begin() + Offset, Nops.begin(), Nops.end());
+  }
+  Sec.setContents(std::move(Data));
+
+  // Anything at or after the end of the removed bytes moves, and anything
+  // which spans them changes size.
+  uint64_t MovedFrom = Delta < 0 ? Offset - Delta : Offset;
+  Obj.SymbolTable->updateSymbols([&](Symbol &Sym) {
+    if (Sym.DefinedIn != &Sec)
+      return;
+    if (Sym.Value >= MovedFrom)
+      Sym.Value += Delta;
+    else if (Sym.Value < Offset && Sym.Value + Sym.Size > Offset)
+      Sym.Size += Delta;
+  });
+
+  for (auto &RelSec : Obj.sections()) {
+    auto *Relocs = dyn_cast<RelocationSection>(&RelSec);
+    if (!Relocs)
+      continue;
+    for (Relocation &R : Relocs->relocations()) {
+      if (Relocs->getSection() == &Sec && R.Offset >= MovedFrom)
+        R.Offset += Delta;
+      // References to the section symbol carry the offset in the addend.
+      if (R.RelocSymbol && R.RelocSymbol->Type == STT_SECTION &&
+          R.RelocSymbol->DefinedIn == &Sec &&
+          R.Addend >= static_cast<int64_t>(MovedFrom))
+        R.Addend += Delta;
+    }
+  }
+}
+
+// Replace the 4 byte instruction at Offset in Sec with the 2 byte Insn.
+static void shrinkAAPInstr(Object &Obj, Section &Sec, uint64_t Offset,
+                           uint16_t Insn) {
+  std::vector<uint8_t> Data(Sec.getContents().begin(),
+                            Sec.getContents().end());
+  support::endian::write16le(Data.data() + Offset, Insn);
+  Sec.setContents(std::move(Data));
+  resizeAAPSection(Obj, Sec, Offset + 2, -2);
+}
+
+namespace {
+// The start of a function, whose offset must stay a multiple of Align.
+struct AlignPoint {
+  Symbol *Sym;
+  uint64_t Align;
+};
+} // end anonymous namespace
+
+// Removing bytes from a section aligned to more than an instruction moves
+// the functions after them off their alignment. The assembler does not record
+// where it aligned code, but the compiler only aligns functions, so put the
+// start of each function after Offset back on its original alignment by
+// growing or shrinking the padding before it. Code inside a function never
+// moves apart, and the padding before each function stays below its
+// alignment.
+static void realignAAPSection(Object &Obj, Section &Sec,
+                              ArrayRef<AlignPoint> Points, uint64_t Offset) {
+  for (const AlignPoint &P : Points) {
+    uint64_t Start = P.Sym->Value;
+    if (Start <= Offset || Start % P.Align == 0)
+      continue;
+    uint64_t End = 0;
+    for (const AlignPoint &Prev : Points)
+      if (Prev.Sym->Value < Start)
+        End = std::max(End, Prev.Sym->Value + Prev.Sym->Size);
+    // Only nops after the end of the previous function, and after the
+    // instruction which was shrunk, are known to be padding.
+    End = std::min(std::max(End, Offset + 2), Start);
+    for (uint64_t I = End; I < Start; I += 2)
+      if (support::endian::read16le(Sec.getContents().data() + I) != 0x0100)
+        End = I + 2;
+    uint64_t NewStart = alignTo(End, P.Align);
+    if (NewStart < Start)
+      resizeAAPSection(Obj, Sec, End, -static_cast<int64_t>(Start - NewStart));
+    else
+      resizeAAPSection(Obj, Sec, Start, NewStart - Start);
+  }
+}
+
+// Shrink long branches and calls marked with R_AAP_RELAX whose target is in
+// the same section and within reach of the short form of the instruction.
+// Other than padding, which is allowed for, shrinking only ever reduces
+// distances, so repeat until no more fit.
+static void relaxAAPBranches(Object &Obj) {
+  if (Obj.Machine != EM_AAP || Obj.Type != ET_REL || !Obj.SymbolTable)
+    error("--relax-branches is only supported for AAP relocatable objects");
+
+  for (auto &RelSec : Obj.sections()) {
+    auto *Relocs = dyn_cast<RelocationSection>(&RelSec);
+    if (!Relocs || Relocs->Type != SHT_RELA)
+      continue;
+    // Sections read from the input with contents are always plain Sections.
+    const SectionBase *Target = Relocs->getSection();
+    if (!Target || Target->Type != SHT_PROGBITS ||
+        !(Target->Flags & SHF_EXECINSTR))
+      continue;
+    Section *Sec = nullptr;
+    for (auto &S : Obj.sections())
+      if (&S == Target)
+        Sec = static_cast<Section *>(&S);
+
+    // Every function keeps the alignment it was given, up to that of the
+    // section.
+    std::vector<AlignPoint> Points;
+    if (Sec->Align > 2) {
+      Obj.SymbolTable->updateSymbols([&](Symbol &Sym) {
+        if (Sym.DefinedIn == Sec && Sym.Type == STT_FUNC)
+          Points.push_back({&Sym, MinAlign(Sec->Align, Sym.Value)});
+      });
+      llvm::sort(Points.begin(), Points.end(),
+                 [](const AlignPoint &A, const AlignPoint &B) {
+                   return A.Sym->Value < B.Sym->Value;
+                 });
+    }
+
+    bool Changed;
+    do {
+      Changed = false;
+      MutableArrayRef<Relocation> Rels = Relocs->relocations();
+      for (size_t I = 0, E = Rels.size(); I != E; ++I) {
+        Relocation &R = Rels[I];
+        if (R.Type != R_AAP_BR32 && R.Type != R_AAP_BRCC32 &&
+            R.Type != R_AAP_BAL32)
+          continue;
+        // The marker is emitted immediately alongside the branch fixup.
+        Relocation *Relax = nullptr;
+        for (size_t J : {I - 1, I + 1})
+          if (J < E && Rels[J].Type == R_AAP_RELAX &&
+              Rels[J].Offset == R.Offset)
+            Relax = &Rels[J];
+        if (!Relax || !R.RelocSymbol || R.RelocSymbol->DefinedIn != Sec ||
+            R.Offset + 4 > Sec->getContents().size())
+          continue;
+
+        int64_t Disp = static_cast<int64_t>(R.RelocSymbol->Value + R.Addend -
+                                            R.Offset);
+        uint32_t Insn =
+            support::endian::read32le(Sec->getContents().data() + R.Offset);
+        // The short form is the low half of the long form, which is only
+        // valid if every bit of the high half other than the immediate is
+        // zero, i.e. the registers are in the short register class.
+        uint32_t HighImmMask, LowImmMask;
+        unsigned ShortBits;
+        switch (R.Type) {
+        case R_AAP_BR32:
+          HighImmMask = 0x1fff, LowImmMask = 0x01ff, ShortBits = 9;
+          break;
+        case R_AAP_BRCC32:
+          HighImmMask = 0x1fc0, LowImmMask = 0x01c0, ShortBits = 3;
+          break;
+        default:
+          HighImmMask = 0x1ff8, LowImmMask = 0x01f8, ShortBits = 6;
+          break;
+        }
+        if ((Insn >> 16) & ~HighImmMask)
+          continue;
+        // The padding before each function between the branch and its target
+        // may yet grow to Align - 2 bytes.
+        uint64_t Lo = std::min<uint64_t>(R.Offset, R.Offset + Disp);
+        uint64_t Hi = std::max<uint64_t>(R.Offset, R.Offset + Disp);
+        int64_t Margin = 0;
+        for (const AlignPoint &P : Points)
+          if (P.Sym->Value > Lo && P.Sym->Value <= Hi)
+            Margin += P.Align - 2;
+        if (!isIntN(ShortBits, Disp < 0 ? Disp - Margin : Disp + Margin))
+          continue;
+
+        shrinkAAPInstr(Obj, *Sec, R.Offset, Insn & 0x7fff & ~LowImmMask);
+        realignAAPSection(Obj, *Sec, Points, R.Offset);
+
+        R.Type = R.Type == R_AAP_BR32
+                     ? R_AAP_BR16
+                     : R.Type == R_AAP_BRCC32 ? R_AAP_BRCC16 : R_AAP_BAL16;
+        Relax->Type = R_AAP_NONE;
+        Relax->RelocSymbol = nullptr;
+        Changed = true;
+      }
+    } while (Changed);
+    Relocs->removeRelocations([](const Relocation &R) {
+      return R.Type == R_AAP_NONE && !R.RelocSymbol;
+    });
+  }
+}
+
 // This function handles the high level operations of GNU objcopy including
 // handling command line options. It's important to outline certain properties
 // we expect to hold of the command line operations. Any operation that "keeps"
@@ -415,6 +620,11 @@ static Error dumpSectionToFile(StringRef SecName, StringRef Filename,
 static void handleArgs(const CopyConfig &Config, Object &Obj,
                        const Reader &Reader, ElfType OutputElfType) {
 
+  // Relax before any sections are added, so that every code section is one
+  // read from the input.
+  if (Config.RelaxBranches)
+    relaxAAPBranches(Obj);
+
   if (!Config.SplitDWO.empty()) {
     splitDWOToFile(Config, Reader, Config.SplitDWO, OutputElfType);
   }
@@ -917,6 +1127,7 @@ static CopyConfig parseObjcopyOptions(ArrayRef<const char *> ArgsArr) {
     Config.SymbolsToKeep.push_back(Arg->getValue());
 
   Config.PreserveDates = InputArgs.hasArg(OBJCOPY_preserve_dates);
+  Config.RelaxBranches = InputArgs.hasArg(OBJCOPY_relax_branches);
 
   return Config;
 }
@@ -59,6 +59,7 @@
 #include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
@@ -256,6 +257,11 @@ cl::opt<unsigned long long>
 cl::opt<unsigned long long>
     StopAddress("stop-address", cl::desc("Stop disassembly at address"),
                 cl::value_desc("address"), cl::init(UINT64_MAX));
+
+static cl::opt<unsigned> DisassembleThreads(
+    "threads",
+    cl::desc("Number of threads to use when disassembling (default = 1)"),
+    cl::init(1));
 static StringRef ToolName;
 
 typedef std::vector<std::tuple<uint64_t, StringRef, uint8_t>> SectionSymbolsTy;
@@ -1491,53 +1497,52 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                           Section.isText() ? ELF::STT_FUNC : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     StringRef BytesStr;
     error(Section.getContents(BytesStr));
     ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
                             BytesStr.size());
 
-    uint64_t Size;
-    uint64_t Index;
-    bool PrintedSection = false;
-
     std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
     std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
-      uint64_t Start = std::get<0>(Symbols[si]) - SectionAddr;
-      // The end is either the section end or the beginning of the next
-      // symbol.
-      uint64_t End =
-          (si == se - 1) ? SectSize : std::get<0>(Symbols[si + 1]) - SectionAddr;
-      // Don't try to disassemble beyond the end of section contents.
-      if (End > SectSize)
-        End = SectSize;
-      // If this symbol has the same address as the next symbol, then skip it.
-      if (Start >= End)
-        continue;
-
-      // Check if we need to skip symbol
-      // Skip if the symbol's data is not between StartAddress and StopAddress
-      if (End + SectionAddr < StartAddress ||
-          Start + SectionAddr > StopAddress) {
-        continue;
-      }
 
-      /// Skip if user requested specific symbols and this is not in the list
-      if (!DisasmFuncsSet.empty() &&
-          !DisasmFuncsSet.count(std::get<1>(Symbols[si])))
-        continue;
+    // Print the relocations which apply to the instruction at Index.
+    auto PrintInstRelocations = [&](uint64_t Index, uint64_t Size) {
+      // Hexagon does this in pretty printer
+      if (Obj->getArch() == Triple::hexagon)
+        return;
+      while (rel_cur != rel_end) {
+        bool hidden = getHidden(*rel_cur);
+        uint64_t addr = rel_cur->getOffset();
+        SmallString<16> name;
+        SmallString<32> val;
+
+        // If this relocation is hidden, skip it.
+        if (hidden || ((SectionAddr + addr) < StartAddress)) {
+          ++rel_cur;
+          continue;
+        }
 
-      if (!PrintedSection) {
-        PrintedSection = true;
-        outs() << "Disassembly of section ";
-        if (!SegmentName.empty())
-          outs() << SegmentName << ",";
-        outs() << SectionName << ':';
+        // Stop when rel_cur's address is past the current instruction.
+        if (addr >= Index + Size) break;
+        rel_cur->getTypeName(name);
+        error(getRelocationValueString(*rel_cur, val));
+        outs() << format(Fmt.data(), SectionAddr + addr) << name
+               << "\t" << val << "\n";
+        ++rel_cur;
       }
+    };
+
+    // Disassemble the symbol Symbols[si], covering [Start, End) of the
+    // section, to OS. AfterInst is called with the offset and size of each
+    // instruction once it has been printed.
+    auto DisassembleSymbol = [&](unsigned si, uint64_t Start, uint64_t End,
+                                 MCDisassembler &DA, MCInstPrinter &Printer,
+                                 raw_ostream &OS, raw_ostream &DebugOut,
+                                 function_ref<void(uint64_t, uint64_t)>
+                                     AfterInst) {
+      unsigned se = Symbols.size();
+      uint64_t Size;
+      uint64_t Index;
 
       // Stop disassembly at the stop address specified
       if (End + SectionAddr > StopAddress)
@@ -1560,8 +1565,8 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         }
       }
 
-      auto PrintSymbol = [](StringRef Name) {
-        outs() << '\n' << Name << ":\n";
+      auto PrintSymbol = [&](StringRef Name) {
+        OS << '\n' << Name << ":\n";
       };
       StringRef SymbolName = std::get<1>(Symbols[si]);
       if (Demangle) {
@@ -1588,15 +1593,12 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
       // Don't print raw contents of a virtual section. A virtual section
       // doesn't have any contents in the file.
       if (Section.isVirtual()) {
-        outs() << "...\n";
-        continue;
+        OS << "...\n";
+        return;
       }
 
-#ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
-#else
-      raw_ostream &DebugOut = nulls();
-#endif
+      SmallString<40> Comments;
+      raw_svector_ostream CommentStream(Comments);
 
       for (Index = Start; Index < End; Index += Size) {
         MCInst Inst;
@@ -1620,12 +1622,12 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
           if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
             // Switch to data.
             while (Index < End) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
+              OS << format("%8" PRIx64 ":", SectionAddr + Index);
+              OS << "\t";
               if (Index + 4 <= End) {
                 Stride = 4;
-                dumpBytes(Bytes.slice(Index, 4), outs());
-                outs() << "\t.word\t";
+                dumpBytes(Bytes.slice(Index, 4), OS);
+                OS << "\t.word\t";
                 uint32_t Data = 0;
                 if (Obj->isLittleEndian()) {
                   const auto Word =
@@ -1637,11 +1639,11 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                       Bytes.data() + Index);
                   Data = *Word;
                 }
-                outs() << "0x" << format("%08" PRIx32, Data);
+                OS << "0x" << format("%08" PRIx32, Data);
               } else if (Index + 2 <= End) {
                 Stride = 2;
-                dumpBytes(Bytes.slice(Index, 2), outs());
-                outs() << "\t\t.short\t";
+                dumpBytes(Bytes.slice(Index, 2), OS);
+                OS << "\t\t.short\t";
                 uint16_t Data = 0;
                 if (Obj->isLittleEndian()) {
                   const auto Short =
@@ -1654,15 +1656,15 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                                                                   Index);
                   Data = *Short;
                 }
-                outs() << "0x" << format("%04" PRIx16, Data);
+                OS << "0x" << format("%04" PRIx16, Data);
               } else {
                 Stride = 1;
-                dumpBytes(Bytes.slice(Index, 1), outs());
-                outs() << "\t\t.byte\t";
-                outs() << "0x" << format("%02" PRIx8, Bytes.slice(Index, 1)[0]);
+                dumpBytes(Bytes.slice(Index, 1), OS);
+                OS << "\t\t.byte\t";
+                OS << "0x" << format("%02" PRIx8, Bytes.slice(Index, 1)[0]);
               }
               Index += Stride;
-              outs() << "\n";
+              OS << "\n";
               auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
                                           TextMappingSymsAddr.end(), Index);
               if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
@@ -1687,11 +1689,11 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                 ((SectionAddr + Index) > StopAddress))
               continue;
             if (NumBytes == 0) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
+              OS << format("%8" PRIx64 ":", SectionAddr + Index);
+              OS << "\t";
             }
             Byte = Bytes.slice(Index)[0];
-            outs() << format(" %02x", Byte);
+            OS << format(" %02x", Byte);
             AsciiData[NumBytes] = isPrint(Byte) ? Byte : '.';
 
             uint8_t IndentOffset = 0;
@@ -1706,9 +1708,9 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
             }
             if (NumBytes == 8) {
               AsciiData[8] = '\0';
-              outs() << std::string(IndentOffset, ' ') << "         ";
-              outs() << reinterpret_cast<char *>(AsciiData);
-              outs() << '\n';
+              OS << std::string(IndentOffset, ' ') << "         ";
+              OS << reinterpret_cast<char *>(AsciiData);
+              OS << '\n';
               NumBytes = 0;
             }
           }
@@ -1718,16 +1720,16 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
         // Disassemble a real instruction or a data when disassemble all is
         // provided
-        bool Disassembled = DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
-                                                   SectionAddr + Index, DebugOut,
-                                                   CommentStream);
+        bool Disassembled = DA.getInstruction(Inst, Size, Bytes.slice(Index),
+                                              SectionAddr + Index, DebugOut,
+                                              CommentStream);
         if (Size == 0)
           Size = 1;
 
-        PIP.printInst(*IP, Disassembled ? &Inst : nullptr,
-                      Bytes.slice(Index, Size), SectionAddr + Index, outs(), "",
+        PIP.printInst(Printer, Disassembled ? &Inst : nullptr,
+                      Bytes.slice(Index, Size), SectionAddr + Index, OS, "",
                       *STI, &SP, &Rels);
-        outs() << CommentStream.str();
+        OS << CommentStream.str();
         Comments.clear();
 
         // Try to resolve the target of a call, tail call, etc. to a specific
@@ -1743,6 +1745,9 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
             // In a non-relocatable object, the target may be in any section.
             //
             // N.B. We don't walk the relocations in the relocatable case yet.
+            //
+            // AllSymbols is only read here, as this may run on several
+            // threads at once.
             auto *TargetSectionSymbols = &Symbols;
             if (!Obj->isRelocatableObject()) {
               auto SectionAddress = std::upper_bound(
@@ -1751,11 +1756,12 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                       const std::pair<uint64_t, SectionRef> &RHS) {
                     return LHS < RHS.first;
                   });
+              TargetSectionSymbols = &AbsoluteSymbols;
               if (SectionAddress != SectionAddresses.begin()) {
                 --SectionAddress;
-                TargetSectionSymbols = &AllSymbols[SectionAddress->second];
-              } else {
-                TargetSectionSymbols = &AbsoluteSymbols;
+                auto SecSyms = AllSymbols.find(SectionAddress->second);
+                if (SecSyms != AllSymbols.end())
+                  TargetSectionSymbols = &SecSyms->second;
               }
             }
 
@@ -1781,40 +1787,156 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
               --TargetSym;
               uint64_t TargetAddress = std::get<0>(*TargetSym);
               StringRef TargetName = std::get<1>(*TargetSym);
-              outs() << " <" << TargetName;
+              OS << " <" << TargetName;
               uint64_t Disp = Target - TargetAddress;
               if (Disp)
-                outs() << "+0x" << Twine::utohexstr(Disp);
-              outs() << '>';
+                OS << "+0x" << Twine::utohexstr(Disp);
+              OS << '>';
             }
           }
         }
-        outs() << "\n";
-
-        // Hexagon does this in pretty printer
-        if (Obj->getArch() != Triple::hexagon)
-          // Print relocation for instruction.
-          while (rel_cur != rel_end) {
-            bool hidden = getHidden(*rel_cur);
-            uint64_t addr = rel_cur->getOffset();
-            SmallString<16> name;
-            SmallString<32> val;
-
-            // If this relocation is hidden, skip it.
-            if (hidden || ((SectionAddr + addr) < StartAddress)) {
-              ++rel_cur;
-              continue;
-            }
+        OS << "\n";
 
-            // Stop when rel_cur's address is past the current instruction.
-            if (addr >= Index + Size) break;
-            rel_cur->getTypeName(name);
-            error(getRelocationValueString(*rel_cur, val));
-            outs() << format(Fmt.data(), SectionAddr + addr) << name
-                   << "\t" << val << "\n";
-            ++rel_cur;
-          }
+        // Print relocation for instruction.
+        AfterInst(Index, Size);
+      }
+    };
+
+    // Find the symbols to disassemble, with the range of the section which
+    // each covers.
+    std::vector<std::tuple<unsigned, uint64_t, uint64_t>> SymbolRanges;
+    uint64_t TotalBytes = 0;
+    for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
+      uint64_t Start = std::get<0>(Symbols[si]) - SectionAddr;
+      // The end is either the section end or the beginning of the next
+      // symbol.
+      uint64_t End =
+          (si == se - 1) ? SectSize : std::get<0>(Symbols[si + 1]) - SectionAddr;
+      // Don't try to disassemble beyond the end of section contents.
+      if (End > SectSize)
+        End = SectSize;
+      // If this symbol has the same address as the next symbol, then skip it.
+      if (Start >= End)
+        continue;
+
+      // Check if we need to skip symbol
+      // Skip if the symbol's data is not between StartAddress and StopAddress
+      if (End + SectionAddr < StartAddress ||
+          Start + SectionAddr > StopAddress) {
+        continue;
+      }
+
+      /// Skip if user requested specific symbols and this is not in the list
+      if (!DisasmFuncsSet.empty() &&
+          !DisasmFuncsSet.count(std::get<1>(Symbols[si])))
+        continue;
+
+      SymbolRanges.emplace_back(si, Start, End);
+      TotalBytes += End - Start;
+    }
+    if (SymbolRanges.empty())
+      continue;
+
+    outs() << "Disassembly of section ";
+    if (!SegmentName.empty())
+      outs() << SegmentName << ",";
+    outs() << SectionName << ':';
+
+    // Source and line printing keep state from one instruction to the next,
+    // and the Hexagon and AMDGPU printers and symbolizers are shared with the
+    // rest of the section, so these are always disassembled sequentially.
+    bool Parallel = DisassembleThreads > 1 && SymbolRanges.size() > 1 &&
+                    !PrintSource && !PrintLines &&
+                    Obj->getArch() != Triple::hexagon &&
+                    Obj->getArch() != Triple::amdgcn;
+    if (!Parallel) {
+#ifndef NDEBUG
+      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+#else
+      raw_ostream &DebugOut = nulls();
+#endif
+      for (const auto &Range : SymbolRanges)
+        DisassembleSymbol(std::get<0>(Range), std::get<1>(Range),
+                          std::get<2>(Range), *DisAsm, *IP, outs(), DebugOut,
+                          PrintInstRelocations);
+      continue;
+    }
+
+    // Split the symbols into chunks of about the same number of bytes, a few
+    // per thread so that the threads stay busy when symbol sizes vary. Each
+    // chunk is disassembled with its own disassembler and printer into its
+    // own buffers for the text and the debug output, recording where each
+    // instruction ends so that the inline relocations can be interleaved when
+    // the buffers are printed in order.
+    struct Chunk {
+      unsigned Begin, End;
+      std::string Text, DebugText;
+      std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> Insts;
+      bool Failed = false;
+    };
+    std::vector<Chunk> Chunks;
+    uint64_t ChunkBytes = std::max<uint64_t>(
+        TotalBytes / (DisassembleThreads * 8), 1);
+    for (unsigned I = 0, E = SymbolRanges.size(); I != E;) {
+      Chunk C;
+      C.Begin = I;
+      uint64_t Size = 0;
+      while (I != E && Size < ChunkBytes) {
+        Size += std::get<2>(SymbolRanges[I]) - std::get<1>(SymbolRanges[I]);
+        ++I;
+      }
+      C.End = I;
+      Chunks.push_back(std::move(C));
+    }
+
+    ThreadPool Pool(DisassembleThreads);
+    for (Chunk &C : Chunks) {
+      Pool.async([&] {
+        MCObjectFileInfo ChunkMOFI;
+        MCContext ChunkCtx(AsmInfo.get(), MRI.get(), &ChunkMOFI);
+        ChunkMOFI.InitMCObjectFileInfo(Triple(TripleName), false, ChunkCtx);
+        std::unique_ptr<MCDisassembler> ChunkDisAsm(
+            TheTarget->createMCDisassembler(*STI, ChunkCtx));
+        std::unique_ptr<MCInstPrinter> ChunkIP(TheTarget->createMCInstPrinter(
+            Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
+        if (!ChunkDisAsm || !ChunkIP) {
+          C.Failed = true;
+          return;
+        }
+        ChunkIP->setPrintImmHex(PrintImmHex);
+
+        raw_string_ostream OS(C.Text);
+        raw_string_ostream DebugOut(C.DebugText);
+        for (unsigned I = C.Begin; I != C.End; ++I)
+          DisassembleSymbol(std::get<0>(SymbolRanges[I]),
+                            std::get<1>(SymbolRanges[I]),
+                            std::get<2>(SymbolRanges[I]), *ChunkDisAsm,
+                            *ChunkIP, OS, DebugOut,
+                            [&](uint64_t Index, uint64_t Size) {
+                              C.Insts.emplace_back(OS.tell(), Index, Size);
+                            });
+        OS.flush();
+        DebugOut.flush();
+      });
+    }
+    Pool.wait();
+
+    for (const Chunk &C : Chunks) {
+      if (C.Failed)
+        report_error(Obj->getFileName(),
+                     "no disassembler for target " + TripleName);
+#ifndef NDEBUG
+      if (DebugFlag)
+        dbgs() << C.DebugText;
+#endif
+      StringRef Text = C.Text;
+      uint64_t Printed = 0;
+      for (const auto &Inst : C.Insts) {
+        outs() << Text.slice(Printed, std::get<0>(Inst));
+        Printed = std::get<0>(Inst);
+        PrintInstRelocations(std::get<1>(Inst), std::get<2>(Inst));
       }
+      outs() << Text.substr(Printed);
     }
   }
 }
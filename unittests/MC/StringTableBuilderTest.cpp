@@ -9,9 +9,14 @@
 
 #include "llvm/MC/StringTableBuilder.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Endian.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <string>
+#include <vector>
 
 using namespace llvm;
 
@@ -104,4 +109,88 @@ TEST(StringTableBuilderTest, ELFInOrder) {
   EXPECT_EQ(9U, B.getOffset("foobar"));
 }
 
+// Sets the number of strings from which string tables are sorted in
+// parallel, and restores it on destruction.
+class ParallelSortThreshold {
+  cl::opt<unsigned> &Opt;
+  unsigned Saved;
+
+  static cl::opt<unsigned> &getOption() {
+    return *static_cast<cl::opt<unsigned> *>(
+        cl::getRegisteredOptions()["string-table-parallel-sort-threshold"]);
+  }
+
+public:
+  ParallelSortThreshold() : Opt(getOption()), Saved(Opt) {}
+  ~ParallelSortThreshold() { Opt = Saved; }
+
+  unsigned get() const { return Opt; }
+  void set(unsigned Threshold) { Opt = Threshold; }
+};
+
+static std::string writeTable(StringTableBuilder &B) {
+  SmallString<64> Data;
+  raw_svector_ostream OS(Data);
+  B.write(OS);
+  return Data.str();
+}
+
+TEST(StringTableBuilderTest, LargeELF) {
+  // Enough distinct short strings over a small alphabet that many of them are
+  // suffixes of others, and that the table is sorted in parallel.
+  std::vector<std::string> Strings;
+  uint32_t Seed = 1;
+  for (unsigned I = 0; I != 200000; ++I) {
+    std::string S;
+    Seed = Seed * 1103515245 + 12345;
+    for (unsigned Len = (Seed >> 16) % 12; Len; --Len) {
+      Seed = Seed * 1103515245 + 12345;
+      S += "abcxyz_E"[(Seed >> 16) % 8];
+    }
+    Strings.push_back(S);
+  }
+
+  // The table is laid out in descending order of the reversed strings, with
+  // each string which is a suffix of the one before it merged into it.
+  std::vector<std::string> Reversed;
+  for (const std::string &S : Strings)
+    Reversed.emplace_back(S.rbegin(), S.rend());
+  std::sort(Reversed.begin(), Reversed.end(), std::greater<std::string>());
+  Reversed.erase(std::unique(Reversed.begin(), Reversed.end()),
+                 Reversed.end());
+
+  std::string Expected(1, '\x00');
+  std::string Previous;
+  for (const std::string &R : Reversed) {
+    std::string S(R.rbegin(), R.rend());
+    if (StringRef(Previous).endswith(S))
+      continue;
+    Expected += S;
+    Expected += '\x00';
+    Previous = S;
+  }
+
+  ParallelSortThreshold Threshold;
+  ASSERT_GE(Reversed.size(), Threshold.get());
+  StringTableBuilder B(StringTableBuilder::ELF);
+  for (const std::string &S : Strings)
+    B.add(S);
+  B.finalize();
+  std::string Data = writeTable(B);
+
+  // The same table, sorted on one thread.
+  Threshold.set(std::numeric_limits<unsigned>::max());
+  StringTableBuilder Sequential(StringTableBuilder::ELF);
+  for (const std::string &S : Strings)
+    Sequential.add(S);
+  Sequential.finalize();
+
+  EXPECT_EQ(Expected, Data);
+  EXPECT_EQ(writeTable(Sequential), Data);
+  for (const std::string &S : Strings) {
+    EXPECT_EQ(S, Data.substr(B.getOffset(S), S.size()));
+    EXPECT_EQ(Sequential.getOffset(S), B.getOffset(S));
+  }
+}
+
 }
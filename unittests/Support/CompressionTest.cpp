@@ -16,6 +16,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -66,6 +67,35 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+TEST(CompressionTest, ZlibParallel) {
+  std::string Input;
+  for (size_t i = 0; i < 100000; ++i)
+    Input += "abcdefgh"[(i * 7 + i / 13) % 8];
+
+  // An input of a single chunk is compressed as by zlib::compress.
+  SmallString<32> Single, Parallel;
+  EXPECT_THAT_ERROR(zlib::compress(Input, Single), Succeeded());
+  EXPECT_THAT_ERROR(zlib::compressParallel(Input, Parallel, 4, Input.size()),
+                    Succeeded());
+  EXPECT_EQ(Single, Parallel);
+
+  // Otherwise the chunks form a single stream, which does not depend on the
+  // number of threads.
+  for (int Level : {zlib::NoCompression, zlib::BestSpeedCompression,
+                    zlib::DefaultCompression, zlib::BestSizeCompression}) {
+    SmallString<32> Serial, Uncompressed;
+    EXPECT_THAT_ERROR(zlib::compressParallel(Input, Serial, 1, 4096, Level),
+                      Succeeded());
+    EXPECT_THAT_ERROR(zlib::compressParallel(Input, Parallel, 4, 4096, Level),
+                      Succeeded());
+    EXPECT_EQ(Serial, Parallel);
+
+    EXPECT_THAT_ERROR(zlib::uncompress(Parallel, Uncompressed, Input.size()),
+                      Succeeded());
+    EXPECT_EQ(Input, Uncompressed);
+  }
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
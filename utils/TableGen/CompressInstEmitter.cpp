@@ -1,18 +1,19 @@
-//===- RISCVCompressInstEmitter.cpp - Generator for RISCV Compression -===//
+//===- CompressInstEmitter.cpp - Generator for Instruction Compression ----===//
 //
 //                     The LLVM Compiler Infrastructure
 //
 // This file is distributed under the University of Illinois Open Source
 // License. See LICENSE.TXT for details.
 //
-// RISCVCompressInstEmitter implements a tablegen-driven CompressPat based
-// RISCV Instruction Compression mechanism.
+// CompressInstEmitter implements a tablegen-driven CompressPat based
+// Instruction Compression mechanism.
 //
-//===--------------------------------------------------------------===//
+//===----------------------------------------------------------------------===//
 //
-// RISCVCompressInstEmitter implements a tablegen-driven CompressPat Instruction
-// Compression mechanism for generating RISCV compressed instructions
-// (C ISA Extension) from the expanded instruction form.
+// CompressInstEmitter implements a tablegen-driven CompressPat Instruction
+// Compression mechanism for generating short (compressed) instructions, such
+// as the RISCV C ISA Extension or the AAP 16-bit instructions, from the
+// expanded instruction form.
 
 // This tablegen backend processes CompressPat declarations in a
 // td file and generates all the required checks to validate the pattern
@@ -21,20 +22,19 @@
 // operands; register operands, immediate operands, fixed register and fixed
 // immediate inputs.
 //
-// Example:
-// class CompressPat<dag input, dag output> {
-//   dag Input  = input;
-//   dag Output    = output;
-//   list<Predicate> Predicates = [];
-// }
+// The CompressPat class is defined in include/llvm/Target/Target.td. The
+// output instruction of a pattern must have a smaller Size than the input
+// instruction. Operands with sub-operands (MIOperandInfo), such as memory
+// operands, are mapped sub-operand by sub-operand.
 //
+// Example:
 // let Predicates = [HasStdExtC] in {
 // def : CompressPat<(ADD GPRNoX0:$rs1, GPRNoX0:$rs1, GPRNoX0:$rs2),
 //                   (C_ADD GPRNoX0:$rs1, GPRNoX0:$rs2)>;
 // }
 //
 // The result is an auto-generated header file
-// 'RISCVGenCompressInstEmitter.inc' which exports two functions for
+// '<Target>GenCompressInstEmitter.inc' which exports two functions for
 // compressing/uncompressing MCInst instructions, plus
 // some helper functions:
 //
@@ -71,7 +71,7 @@ using namespace llvm;
 #define DEBUG_TYPE "compress-inst-emitter"
 
 namespace {
-class RISCVCompressInstEmitter {
+class CompressInstEmitter {
   struct OpData {
     enum MapKind { Operand, Imm, Reg };
     MapKind Kind;
@@ -123,13 +123,13 @@ class RISCVCompressInstEmitter {
                                 CodeGenInstruction &DestInst);
 
 public:
-  RISCVCompressInstEmitter(RecordKeeper &R) : Records(R), Target(R) {}
+  CompressInstEmitter(RecordKeeper &R) : Records(R), Target(R) {}
 
   void run(raw_ostream &o);
 };
 } // End anonymous namespace.
 
-bool RISCVCompressInstEmitter::validateRegister(Record *Reg, Record *RegClass) {
+bool CompressInstEmitter::validateRegister(Record *Reg, Record *RegClass) {
   assert(Reg->isSubClassOf("Register") && "Reg record should be a Register\n");
   assert(RegClass->isSubClassOf("RegisterClass") && "RegClass record should be"
                                                     " a RegisterClass\n");
@@ -140,9 +140,9 @@ bool RISCVCompressInstEmitter::validateRegister(Record *Reg, Record *RegClass) {
   return RC.contains(R);
 }
 
-bool RISCVCompressInstEmitter::validateTypes(Record *DagOpType,
-                                             Record *InstOpType,
-                                             bool IsSourceInst) {
+bool CompressInstEmitter::validateTypes(Record *DagOpType,
+                                        Record *InstOpType,
+                                        bool IsSourceInst) {
   if (DagOpType == InstOpType)
     return true;
   // Only source instruction operands are allowed to not match Input Dag
@@ -172,6 +172,15 @@ bool RISCVCompressInstEmitter::validateTypes(Record *DagOpType,
   return true;
 }
 
+/// Return the number of MachineInstr operands the operand type \p OpType
+/// expands to.
+static unsigned getNumSubOperands(Record *OpType) {
+  if (!OpType->isSubClassOf("Operand"))
+    return 1;
+  DagInit *MIOpInfo = OpType->getValueAsDag("MIOperandInfo");
+  return MIOpInfo->getNumArgs() ? MIOpInfo->getNumArgs() : 1;
+}
+
 /// The patterns in the Dag contain different types of operands:
 /// Register operands, e.g.: GPRC:$rs1; Fixed registers, e.g: X1; Immediate
 /// operands, e.g.: simm6:$imm; Fixed immediate operands, e.g.: 0. This function
@@ -179,7 +188,7 @@ bool RISCVCompressInstEmitter::validateTypes(Record *DagOpType,
 /// operands and fixed registers it expects the Dag operand type to be contained
 /// in the instantiated instruction operand type. For immediate operands and
 /// immediates no validation checks are enforced at pattern validation time.
-void RISCVCompressInstEmitter::addDagOperandMapping(
+void CompressInstEmitter::addDagOperandMapping(
     Record *Rec, DagInit *Dag, CodeGenInstruction &Inst,
     IndexedMap<OpData> &OperandMap, bool IsSourceInst) {
   // TiedCount keeps track of the number of operands skipped in Inst
@@ -199,6 +208,11 @@ void RISCVCompressInstEmitter::addDagOperandMapping(
     }
     if (DefInit *DI = dyn_cast<DefInit>(Dag->getArg(i - TiedCount))) {
       if (DI->getDef()->isSubClassOf("Register")) {
+        if (Inst.Operands[i].MINumOperands != 1)
+          PrintFatalError(Rec->getLoc(),
+                          "Error in Dag '" + Dag->getAsString() +
+                              "' Fixed register '" + DI->getDef()->getName() +
+                              "' used for an operand with sub-operands!");
         // Check if the fixed register belongs to the Register class.
         if (!validateRegister(DI->getDef(), Inst.Operands[i].Rec))
           PrintFatalError(Rec->getLoc(),
@@ -222,11 +236,22 @@ void RISCVCompressInstEmitter::addDagOperandMapping(
                             "' which does not match the type '" +
                             Inst.Operands[i].Rec->getName() +
                             "' in the corresponding instruction operand!");
+      // Operands with sub-operands are mapped one sub-operand at a time, so
+      // the Dag operand must have the same shape as the instruction operand.
+      if (getNumSubOperands(DI->getDef()) != Inst.Operands[i].MINumOperands)
+        PrintFatalError(Rec->getLoc(),
+                        "Error in Dag '" + Dag->getAsString() + "'. Operand '" +
+                            Dag->getArgNameStr(i - TiedCount) + "' of type '" +
+                            DI->getDef()->getName() +
+                            "' has a different number of sub-operands to '" +
+                            Inst.Operands[i].Rec->getName() +
+                            "' in the corresponding instruction operand!");
 
       OperandMap[i].Kind = OpData::Operand;
     } else if (IntInit *II = dyn_cast<IntInit>(Dag->getArg(i - TiedCount))) {
       // Validate that corresponding instruction operand expects an immediate.
-      if (Inst.Operands[i].Rec->isSubClassOf("RegisterClass"))
+      if (Inst.Operands[i].Rec->isSubClassOf("RegisterClass") ||
+          Inst.Operands[i].MINumOperands != 1)
         PrintFatalError(
             Rec->getLoc(),
             ("Error in Dag '" + Dag->getAsString() + "' Found immediate: '" +
@@ -286,7 +311,7 @@ static bool validateArgsTypes(Init *Arg1, Init *Arg2) {
 // name have the same types. For example in 'C_ADD $rs1, $rs2' we generate the
 // mapping $rs1 --> 0, $rs2 ---> 1. If the operand appears twice in the (tied)
 // same Dag we use the last occurrence for indexing.
-void RISCVCompressInstEmitter::createDagOperandMapping(
+void CompressInstEmitter::createDagOperandMapping(
     Record *Rec, StringMap<unsigned> &SourceOperands,
     StringMap<unsigned> &DestOperands, DagInit *SourceDag, DagInit *DestDag,
     IndexedMap<OpData> &SourceOperandMap) {
@@ -333,7 +358,7 @@ void RISCVCompressInstEmitter::createDagOperandMapping(
 /// Map operand names in the Dag to their index in both corresponding input and
 /// output instructions. Validate that operands defined in the input are
 /// used in the output pattern while populating the maps.
-void RISCVCompressInstEmitter::createInstOperandMapping(
+void CompressInstEmitter::createInstOperandMapping(
     Record *Rec, DagInit *SourceDag, DagInit *DestDag,
     IndexedMap<OpData> &SourceOperandMap, IndexedMap<OpData> &DestOperandMap,
     StringMap<unsigned> &SourceOperands, CodeGenInstruction &DestInst) {
@@ -402,7 +427,7 @@ void RISCVCompressInstEmitter::createInstOperandMapping(
 ///   and generate warning.
 /// - Immediate operand type in Dag Input differs from the corresponding Source
 ///   Instruction type  and generate a warning.
-void RISCVCompressInstEmitter::evaluateCompressPat(Record *Rec) {
+void CompressInstEmitter::evaluateCompressPat(Record *Rec) {
   // Validate input Dag operands.
   DagInit *SourceDag = Rec->getValueAsDag("Input");
   assert(SourceDag && "Missing 'Input' in compress pattern!");
@@ -412,11 +437,10 @@ void RISCVCompressInstEmitter::evaluateCompressPat(Record *Rec) {
   if (!OpDef)
     PrintFatalError(Rec->getLoc(),
                     Rec->getName() + " has unexpected operator type!");
-  // Checking we are transforming from compressed to uncompressed instructions.
   Record *Operator = OpDef->getDef();
-  if (!Operator->isSubClassOf("RVInst"))
-    PrintFatalError(Rec->getLoc(), "Input instruction '" + Operator->getName() +
-                                       "' is not a 32 bit wide instruction!");
+  if (!Operator->isSubClassOf("Instruction"))
+    PrintFatalError(Rec->getLoc(), "Input operator '" + Operator->getName() +
+                                       "' is not an instruction!");
   CodeGenInstruction SourceInst(Operator);
   verifyDagOpCount(SourceInst, SourceDag, true);
 
@@ -431,10 +455,17 @@ void RISCVCompressInstEmitter::evaluateCompressPat(Record *Rec) {
                     Rec->getName() + " has unexpected operator type!");
 
   Record *DestOperator = DestOpDef->getDef();
-  if (!DestOperator->isSubClassOf("RVInst16"))
-    PrintFatalError(Rec->getLoc(), "Output instruction  '" +
+  if (!DestOperator->isSubClassOf("Instruction"))
+    PrintFatalError(Rec->getLoc(), "Output operator '" +
+                                       DestOperator->getName() +
+                                       "' is not an instruction!");
+  // Checking we are transforming from uncompressed to compressed instructions.
+  if (DestOperator->getValueAsInt("Size") >= Operator->getValueAsInt("Size"))
+    PrintFatalError(Rec->getLoc(), "Output instruction '" +
                                        DestOperator->getName() +
-                                       "' is not a 16 bit wide instruction!");
+                                       "' is not smaller than input "
+                                       "instruction '" +
+                                       Operator->getName() + "'!");
   CodeGenInstruction DestInst(DestOperator);
   verifyDagOpCount(DestInst, DestDag, false);
 
@@ -526,13 +557,8 @@ static std::string mergeCondAndCode(raw_string_ostream &CondStream,
   return CombinedStream.str();
 }
 
-void RISCVCompressInstEmitter::emitCompressInstEmitter(raw_ostream &o,
-                                                       bool Compress) {
-  Record *AsmWriter = Target.getAsmWriter();
-  if (!AsmWriter->getValueAsInt("PassSubtarget"))
-    PrintFatalError("'PassSubtarget' is false. SubTargetInfo object is needed "
-                    "for target features.\n");
-
+void CompressInstEmitter::emitCompressInstEmitter(raw_ostream &o,
+                                                  bool Compress) {
   std::string Namespace = Target.getName();
 
   // Sort entries in CompressPatterns to handle instructions that can have more
@@ -646,13 +672,17 @@ void RISCVCompressInstEmitter::emitCompressInstEmitter(raw_ostream &o,
     // Start Source Inst operands validation.
     unsigned OpNo = 0;
     for (OpNo = 0; OpNo < Source.Operands.size(); ++OpNo) {
+      // Index of the operand in the MCInst, which differs from OpNo once an
+      // operand with sub-operands has been seen.
+      unsigned MIOpNo = Source.Operands[OpNo].MIOperandNo;
       if (SourceOperandMap[OpNo].TiedOpIdx != -1) {
+        unsigned TiedMIOpNo =
+            Source.Operands[SourceOperandMap[OpNo].TiedOpIdx].MIOperandNo;
         if (Source.Operands[OpNo].Rec->isSubClassOf("RegisterClass"))
           CondStream.indent(6)
               << "(MI.getOperand("
-              << std::to_string(OpNo) + ").getReg() ==  MI.getOperand("
-              << std::to_string(SourceOperandMap[OpNo].TiedOpIdx)
-              << ").getReg()) &&\n";
+              << std::to_string(MIOpNo) + ").getReg() ==  MI.getOperand("
+              << std::to_string(TiedMIOpNo) << ").getReg()) &&\n";
         else
           PrintFatalError("Unexpected tied operand types!\n");
       }
@@ -663,14 +693,14 @@ void RISCVCompressInstEmitter::emitCompressInstEmitter(raw_ostream &o,
         break;
       case OpData::Imm:
         CondStream.indent(6)
-            << "(MI.getOperand(" + std::to_string(OpNo) + ").isImm()) &&\n" +
-                   "      (MI.getOperand(" + std::to_string(OpNo) +
+            << "(MI.getOperand(" + std::to_string(MIOpNo) + ").isImm()) &&\n" +
+                   "      (MI.getOperand(" + std::to_string(MIOpNo) +
                    ").getImm() == " +
                    std::to_string(SourceOperandMap[OpNo].Data.Imm) + ") &&\n";
         break;
       case OpData::Reg: {
         Record *Reg = SourceOperandMap[OpNo].Data.Reg;
-        CondStream.indent(6) << "(MI.getOperand(" + std::to_string(OpNo) +
+        CondStream.indent(6) << "(MI.getOperand(" + std::to_string(MIOpNo) +
                                     ").getReg() == " + Namespace +
                                     "::" + Reg->getName().str() + ") &&\n";
         break;
@@ -685,33 +715,37 @@ void RISCVCompressInstEmitter::emitCompressInstEmitter(raw_ostream &o,
       CodeStream.indent(6) << "// Operand: " + DestOperand.Name + "\n";
       switch (DestOperandMap[OpNo].Kind) {
       case OpData::Operand: {
-        unsigned OpIdx = DestOperandMap[OpNo].Data.Operand;
+        unsigned OpIdx =
+            Source.Operands[DestOperandMap[OpNo].Data.Operand].MIOperandNo;
         // Check that the operand in the Source instruction fits
-        // the type for the Dest instruction.
-        if (DestOperand.Rec->isSubClassOf("RegisterClass")) {
-          NeedMRI = true;
-          // This is a register operand. Check the register class.
-          // Don't check register class if this is a tied operand, it was done
-          // for the operand its tied to.
-          if (DestOperand.getTiedRegister() == -1)
-            CondStream.indent(6)
-                << "(MRI.getRegClass(" + Namespace +
-                       "::" + DestOperand.Rec->getName().str() +
-                       "RegClassID).contains(" + "MI.getOperand(" +
-                       std::to_string(OpIdx) + ").getReg())) &&\n";
-
-          CodeStream.indent(6) << "OutInst.addOperand(MI.getOperand(" +
-                                      std::to_string(OpIdx) + "));\n";
-        } else {
-          // Handling immediate operands.
-          unsigned Entry = getMCOpPredicate(MCOpPredicateMap, MCOpPredicates,
-                                            DestOperand.Rec);
-          CondStream.indent(6) << Namespace + "ValidateMCOperand(" +
-                                      "MI.getOperand(" + std::to_string(OpIdx) +
-                                      "), STI, " + std::to_string(Entry) +
-                                      ") &&\n";
-          CodeStream.indent(6) << "OutInst.addOperand(MI.getOperand(" +
-                                      std::to_string(OpIdx) + "));\n";
+        // the type for the Dest instruction. Operands with sub-operands are
+        // checked and copied one sub-operand at a time.
+        for (unsigned SubOp = 0; SubOp != DestOperand.MINumOperands; ++SubOp) {
+          Record *OpType = DestOperand.Rec;
+          if (DestOperand.MINumOperands > 1)
+            OpType = cast<DefInit>(DestOperand.MIOperandInfo->getArg(SubOp))
+                         ->getDef();
+          std::string MIOp =
+              "MI.getOperand(" + std::to_string(OpIdx + SubOp) + ")";
+          if (OpType->isSubClassOf("RegisterClass")) {
+            NeedMRI = true;
+            // This is a register operand. Check the register class.
+            // Don't check register class if this is a tied operand, it was
+            // done for the operand its tied to.
+            if (DestOperand.getTiedRegister() == -1)
+              CondStream.indent(6)
+                  << "(MRI.getRegClass(" + Namespace +
+                         "::" + OpType->getName().str() +
+                         "RegClassID).contains(" + MIOp + ".getReg())) &&\n";
+          } else {
+            // Handling immediate operands.
+            unsigned Entry =
+                getMCOpPredicate(MCOpPredicateMap, MCOpPredicates, OpType);
+            CondStream.indent(6) << Namespace + "ValidateMCOperand(" + MIOp +
+                                        ", STI, " + std::to_string(Entry) +
+                                        ") &&\n";
+          }
+          CodeStream.indent(6) << "OutInst.addOperand(" + MIOp + ");\n";
         }
         break;
       }
@@ -780,7 +814,7 @@ void RISCVCompressInstEmitter::emitCompressInstEmitter(raw_ostream &o,
     o << "\n#endif //GEN_UNCOMPRESS_INSTR\n\n";
 }
 
-void RISCVCompressInstEmitter::run(raw_ostream &o) {
+void CompressInstEmitter::run(raw_ostream &o) {
   Record *CompressClass = Records.getClass("CompressPat");
   assert(CompressClass && "Compress class definition missing!");
   std::vector<Record *> Insts;
@@ -804,7 +838,7 @@ void RISCVCompressInstEmitter::run(raw_ostream &o) {
 namespace llvm {
 
 void EmitCompressInst(RecordKeeper &RK, raw_ostream &OS) {
-  RISCVCompressInstEmitter(RK).run(OS);
+  CompressInstEmitter(RK).run(OS);
 }
 
 } // namespace llvm
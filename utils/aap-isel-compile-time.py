@@ -0,0 +1,105 @@
+#!/usr/bin/env python
+"""
+Compare the compile time of GlobalISel and SelectionDAG for the AAP target.
+
+Each input is compiled with llc at the given optimization level, once through
+GlobalISel (falling back to SelectionDAG where needed) and once through
+SelectionDAG alone. The wall time of the instruction selection passes, as
+reported by -time-passes, is summed per selector along with the number of
+functions which fell back.
+
+Example:
+  aap-isel-compile-time.py --llc build/bin/llc test/CodeGen/AAP/*.ll
+"""
+
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+# Passes which make up instruction selection for each selector.
+GISEL_PASSES = ('IRTranslator', 'Legalizer', 'RegBankSelect',
+                'InstructionSelect', 'AAP DAG->DAG Pattern Instruction Selection')
+SDAG_PASSES = ('AAP DAG->DAG Pattern Instruction Selection',)
+
+FALLBACK_RE = re.compile(r'Instruction selection used fallback path for (\S+)')
+TIME_RE = re.compile(r'([0-9.]+)\s*\(\s*[0-9.]+%\)')
+
+
+def pass_times(output, passes):
+  """Sum the wall time of the named passes in -time-passes output."""
+  total = 0.0
+  for line in output.splitlines():
+    # Each row is a series of "time (percent)" columns followed by the name,
+    # the last column being the wall time.
+    times = list(TIME_RE.finditer(line))
+    if not times:
+      continue
+    name = line[times[-1].end():].strip()
+    if name in passes:
+      total += float(times[-1].group(1))
+  return total
+
+
+def run_llc(llc, opt_level, gisel, filename, repeat):
+  args = [llc, '-march=aap', '-O%d' % opt_level, '-time-passes',
+          '-filetype=null', '-o', os.devnull, filename]
+  if gisel:
+    args += ['-global-isel', '-global-isel-abort=2']
+  else:
+    args += ['-global-isel=0']
+
+  best = None
+  fallbacks = set()
+  for _ in range(repeat):
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE,
+                            stderr=subprocess.PIPE, universal_newlines=True)
+    _, err = proc.communicate()
+    if proc.returncode != 0:
+      return None, fallbacks
+    fallbacks.update(FALLBACK_RE.findall(err))
+    elapsed = pass_times(err, GISEL_PASSES if gisel else SDAG_PASSES)
+    best = elapsed if best is None else min(best, elapsed)
+  return best, fallbacks
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__,
+      formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument('input', nargs='+')
+  parser.add_argument('--llc', default='llc', help='Path to llc')
+  parser.add_argument('-O', dest='opt_level', type=int, default=0,
+                      help='Optimization level to compile at (default: 0)')
+  parser.add_argument('--repeat', type=int, default=3,
+                      help='Take the best of this many runs (default: 3)')
+  args = parser.parse_args()
+
+  gisel_total = 0.0
+  sdag_total = 0.0
+  total_fallbacks = 0
+  print('%-32s %10s %10s %9s' % ('file', 'gisel (s)', 'sdag (s)', 'fallback'))
+  for filename in args.input:
+    gisel, fallbacks = run_llc(args.llc, args.opt_level, True, filename,
+                               args.repeat)
+    sdag, _ = run_llc(args.llc, args.opt_level, False, filename, args.repeat)
+    if gisel is None or sdag is None:
+      print('%-32s %10s' % (filename.split('/')[-1], 'error'))
+      continue
+    gisel_total += gisel
+    sdag_total += sdag
+    total_fallbacks += len(fallbacks)
+    print('%-32s %10.4f %10.4f %9d' % (filename.split('/')[-1], gisel, sdag,
+                                       len(fallbacks)))
+
+  print('%-32s %10.4f %10.4f %9d' % ('total', gisel_total, sdag_total,
+                                     total_fallbacks))
+  if sdag_total:
+    print('GlobalISel/SelectionDAG: %.2f' % (gisel_total / sdag_total))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())